@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -40,6 +40,8 @@
 #ifndef QNFCDC_ADAPTER_H
 #define QNFCDC_ADAPTER_H
 
+#include "NfcAdapterState.h"
+
 #include <QtCore/QObject>
 
 class QQmlEngine;
@@ -49,6 +51,7 @@ class NfcAdapter :
     public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
     Q_PROPERTY(int interfaceVersion READ interfaceVersion NOTIFY validChanged)
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
     Q_PROPERTY(bool present READ present NOTIFY presentChanged)
@@ -64,14 +67,42 @@ class NfcAdapter :
     Q_PROPERTY(QString laNfcid1 READ laNfcid1 NOTIFY laNfcid1Changed)
     Q_PROPERTY(QString liAHb READ liAHb NOTIFY liAHbChanged) // Since 1.2.1
     Q_PROPERTY(bool t4Ndef READ t4Ndef NOTIFY t4NdefChanged)
+    Q_PROPERTY(NfcAdapterState state READ state NOTIFY stateChanged)
+    Q_PROPERTY(bool coalesceChanges READ coalesceChanges WRITE setCoalesceChanges NOTIFY coalesceChangesChanged)
+    Q_PROPERTY(bool warmUpTags READ warmUpTags WRITE setWarmUpTags NOTIFY warmUpTagsChanged)
+    Q_ENUMS(Property)
 
 public:
+    // Bits of the propertiesChanged() mask. Since 1.3.0
+    enum Property {
+        PresentProperty = 0x0002,
+        EnabledProperty = 0x0004,
+        PoweredProperty = 0x0008,
+        SupportedModesProperty = 0x0010,
+        ModeProperty = 0x0020,
+        TargetPresentProperty = 0x0040,
+        TagPathProperty = 0x0080,
+        ValidProperty = 0x0100,
+        PeerPathProperty = 0x0200,
+        HostPathProperty = 0x0400,
+        SupportedTechsProperty = 0x0800,
+        T4NdefProperty = 0x1000,
+        LaNfcid1Property = 0x2000,
+        LiAHbProperty = 0x4000
+    };
+
     NfcAdapter(QObject* aParent = Q_NULLPTR);
     ~NfcAdapter();
 
     // Callback for qmlRegisterSingletonType<NfcAdapter>
     static QObject* createSingleton(QQmlEngine*, QJSEngine*);
 
+    // D-Bus path of the adapter (see NfcSystem::adapters). Empty path
+    // (default) selects the default adapter, which also remains empty
+    // when read. Since 1.3.0
+    QString path() const;
+    void setPath(QString);
+
     int interfaceVersion() const;
     bool valid() const;
     bool present() const;
@@ -88,7 +119,31 @@ public:
     QString liAHb() const;  // Since 1.2.1
     bool t4Ndef() const;
 
+    // Snapshot of all of the above, updated as soon as the daemon reports
+    // a change. With coalesceChanges enabled, changes reported at once
+    // (e.g. in a single D-Bus message) produce a single snapshot.
+    // stateChanged() is emitted after the signals for the individual
+    // properties. Unlike the individual getters, this one may be called
+    // from any thread. Since 1.3.0
+    NfcAdapterState state() const;
+
+    // When enabled, changes reported by the daemon are accumulated and
+    // delivered in a single event loop dispatch: each changed property
+    // signal is emitted once, followed by propertiesChanged() with the
+    // mask of everything that changed. Default is false. Since 1.3.0
+    bool coalesceChanges() const;
+    void setCoalesceChanges(bool);
+
+    // When enabled, tag clients are created as soon as the daemon
+    // reports new tags, before tagPathChanged() is even delivered.
+    // NfcTag (as well as NfcIsoDep and NfcType2) bound to such a path
+    // then picks up the client which is already valid or on its way
+    // there. Default is false. Since 1.3.0
+    bool warmUpTags() const;
+    void setWarmUpTags(bool);
+
 Q_SIGNALS:
+    void pathChanged();  // Since 1.3.0
     void validChanged();
     void presentChanged();
     void enabledChanged();
@@ -103,6 +158,10 @@ Q_SIGNALS:
     void t4NdefChanged();
     void laNfcid1Changed();
     void liAHbChanged();  // Since 1.2.1
+    void stateChanged();  // Since 1.3.0
+    void coalesceChangesChanged();  // Since 1.3.0
+    void warmUpTagsChanged();  // Since 1.3.0
+    void propertiesChanged(int mask);  // Since 1.3.0
 
 private:
     class Private;
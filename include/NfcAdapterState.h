@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_ADAPTER_STATE_H
+#define QNFCDC_ADAPTER_STATE_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QSharedDataPointer>
+#include <QtCore/QString>
+
+// Immutable snapshot of NfcAdapter properties. Copying is cheap (the
+// data are shared) and a snapshot can be read from any thread. Since 1.3.0
+
+class NfcAdapterState
+{
+    Q_GADGET
+    Q_PROPERTY(int interfaceVersion READ interfaceVersion CONSTANT)
+    Q_PROPERTY(bool valid READ valid CONSTANT)
+    Q_PROPERTY(bool present READ present CONSTANT)
+    Q_PROPERTY(bool enabled READ enabled CONSTANT)
+    Q_PROPERTY(bool powered READ powered CONSTANT)
+    Q_PROPERTY(bool targetPresent READ targetPresent CONSTANT)
+    Q_PROPERTY(int supportedModes READ supportedModes CONSTANT)
+    Q_PROPERTY(int supportedTechs READ supportedTechs CONSTANT)
+    Q_PROPERTY(int mode READ mode CONSTANT)
+    Q_PROPERTY(QString tagPath READ tagPath CONSTANT)
+    Q_PROPERTY(QString peerPath READ peerPath CONSTANT)
+    Q_PROPERTY(QString hostPath READ hostPath CONSTANT)
+    Q_PROPERTY(QString laNfcid1 READ laNfcid1 CONSTANT)
+    Q_PROPERTY(QString liAHb READ liAHb CONSTANT)
+    Q_PROPERTY(bool t4Ndef READ t4Ndef CONSTANT)
+
+public:
+    class Private;
+
+    NfcAdapterState();
+    NfcAdapterState(const NfcAdapterState&);
+    ~NfcAdapterState();
+
+    NfcAdapterState& operator=(const NfcAdapterState&);
+    bool operator==(const NfcAdapterState&) const;
+    bool operator!=(const NfcAdapterState&) const;
+
+    int interfaceVersion() const;
+    bool valid() const;
+    bool present() const;
+    bool enabled() const;
+    bool powered() const;
+    bool targetPresent() const;
+    int supportedModes() const;
+    int supportedTechs() const;
+    int mode() const;
+    QString tagPath() const;
+    QString peerPath() const;
+    QString hostPath() const;
+    QString laNfcid1() const;
+    QString liAHb() const;
+    bool t4Ndef() const;
+
+private:
+    friend class NfcAdapter;
+    NfcAdapterState(Private*);
+
+private:
+    QSharedDataPointer<Private> iPrivate;
+};
+
+Q_DECLARE_METATYPE(NfcAdapterState)
+
+#endif // QNFCDC_ADAPTER_STATE_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_AID_ROUTER_H
+#define QNFCDC_AID_ROUTER_H
+
+#include "NfcHost.h"
+
+#include <QtCore/QList>
+
+// NfcHost handler which dispatches APDUs to other handlers based on
+// the application selected with SELECT by DF name. AIDs are kept in a
+// prefix tree, so partial selection (the SELECT data being a prefix of
+// the AID) including the "next occurrence" mode costs a single lookup.
+// "Next occurrence" fails with 6A82 after the last matching AID.
+// The SELECT itself and all APDUs up to the next SELECT by DF name go
+// to the selected handler. The handler receives the SELECT with its own
+// full AID and the "first occurrence" P2, and the application remains
+// unselected if it fails the SELECT. Hits and handler latencies are
+// counted per AID (refused SELECTs don't count). Since 1.3.0
+
+class NfcAidRouter :
+    public NfcHost::Handler
+{
+    Q_DISABLE_COPY(NfcAidRouter)
+
+public:
+    class Stats {
+    public:
+        Stats() : iHits(0), iTotalTime(0), iMaxTime(0) {}
+
+    public:
+        quint64 iHits;      // Number of APDUs handled
+        qint64 iTotalTime;  // Nanoseconds spent in the handler
+        qint64 iMaxTime;    // The longest call, nanoseconds
+    };
+
+    NfcAidRouter();
+    ~NfcAidRouter();
+
+    // AID is 1 to 16 bytes long. Returns false if it's invalid or
+    // already taken. The handler is not owned by the router.
+    bool addRoute(const QByteArray& aAid, NfcHost::Handler* aHandler);
+    bool removeRoute(const QByteArray& aAid);
+    void removeAllRoutes();
+
+    QList<QByteArray> aids() const;
+    QByteArray selectedAid() const;
+
+    Stats stats(const QByteArray& aAid) const;
+    void resetStats();
+
+    // NfcHost::Handler
+    uint processApdu(NfcHost*, uchar, uchar, uchar, uchar, const QByteArray&,
+        uint, NfcHost::Response*) Q_DECL_OVERRIDE;
+    void hostReset(NfcHost*) Q_DECL_OVERRIDE;
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_AID_ROUTER_H
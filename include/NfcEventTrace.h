@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_EVENT_TRACE_H
+#define QNFCDC_EVENT_TRACE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+
+class QMetaMethod;
+class QObject;
+template <class T> class NfcSignalTable;
+
+// Optional instrumentation of the hop between a libgnfcdc callback and
+// the delivery of the Qt signal it results in. Each event is stamped
+// when the callback is invoked and again when the signal gets emitted
+// on the receiver's thread. Covers the property change signals of
+// NfcSystem, NfcAdapter, NfcTag and NfcPeer, coalesced or not.
+//
+// Tracing is active if it's enabled with setEnabled(true) or if debug
+// output is enabled for "qnfcdc.trace" logging category, in which case
+// every event is logged. Timestamps are microseconds of the monotonic
+// clock used by GLib (g_get_monotonic_time). Since 1.3.0
+
+class NfcEventTrace
+{
+    NfcEventTrace();
+
+public:
+    class Sample {
+    public:
+        QByteArray iSignal;     // Signal name
+        qint64 iCallbackTime;   // libgnfcdc callback
+        qint64 iEmitTime;       // Signal emission
+    };
+
+    static bool enabled();
+    static void setEnabled(bool);
+
+    // The most recent samples, oldest first
+    static QList<Sample> samples();
+
+    // Statistics since the last reset (all latencies in microseconds)
+    static int count();
+    static qint64 lastLatency();
+    static qint64 maxLatency();
+    static qint64 averageLatency();
+    static void reset();
+
+private:
+    class Hop;
+    class Log;
+    template <class T> friend class NfcSignalTable;
+    static bool active();
+    static qint64 callbackTime();
+    static void emitQueued(QObject*, const QMetaMethod&, qint64);
+    static void emitted(const QMetaMethod&, qint64);
+};
+
+#endif // QNFCDC_EVENT_TRACE_H
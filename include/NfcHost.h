@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_HOST_H
+#define QNFCDC_HOST_H
+
+#include <QtCore/QObject>
+
+// Card emulation. Registers a local host service with nfcd and passes
+// each APDU received from the reader to the handler straight from the
+// D-Bus method call callback, i.e. the response goes back to nfcd
+// without a trip through the Qt event loop. The service is registered
+// while both the name and the handler are set. If the path is set (see
+// NfcAdapter::hostPath), APDUs for other hosts are rejected. Requires
+// nfcd 1.2.0 or later. Since 1.3.0
+
+class NfcHost :
+    public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NfcHost)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
+    Q_PROPERTY(bool registered READ registered NOTIFY registeredChanged)
+    Q_PROPERTY(bool active READ active NOTIFY activeChanged)
+
+public:
+    // Response data. Either copied from a QByteArray or handed over as
+    // is, in which case aRelease(aUserData) gets called once the data
+    // is no longer needed. That may happen on any thread, after the
+    // handler has returned (the D-Bus reply may still be queued) or
+    // right away if the data get replaced or dropped.
+    class Response {
+        Q_DISABLE_COPY(Response)
+        friend class NfcHost;
+
+    public:
+        typedef void (*ReleaseFunc)(void* aUserData);
+
+        Response();
+        ~Response();
+
+        void setData(const QByteArray& aData);
+        void setData(const void* aData, uint aSize, ReleaseFunc aRelease,
+            void* aUserData);
+        void clear();
+
+        // Copy of the current data, e.g. for a handler wrapping another
+        // one. Since 1.3.0
+        QByteArray data() const;
+
+    private:
+        QByteArray iBytes;
+        const void* iData;
+        uint iSize;
+        ReleaseFunc iRelease;
+        void* iUserData;
+    };
+
+    class Handler {
+    public:
+        virtual ~Handler() {}
+
+        // Invoked on the thread dispatching libgnfcdc events (the Qt
+        // thread, unless NfcSystem::startIoThread() has been called).
+        // Returns SW1SW2, the response data (if any) goes to aResponse.
+        virtual uint processApdu(NfcHost* aHost, uchar aCla, uchar aIns,
+            uchar aP1, uchar aP2, const QByteArray& aData, uint aLe,
+            Response* aResponse) = 0;
+
+        // Invoked on the same thread when the host is started, restarted
+        // or stopped, i.e. whenever the state of the card session (e.g.
+        // the selected application) has to be reset
+        virtual void hostReset(NfcHost* aHost) {}
+    };
+
+    NfcHost(QObject* aParent = Q_NULLPTR);
+    ~NfcHost();
+
+    QString path() const;
+    void setPath(QString);
+
+    QString name() const;
+    void setName(QString);
+
+    // The handler is not owned by NfcHost and must outlive it (or be
+    // reset first)
+    Handler* handler() const;
+    void setHandler(Handler*);
+
+    bool registered() const;
+
+    // True between the reader selecting the host and the host going
+    // away or being deactivated
+    bool active() const;
+
+Q_SIGNALS:
+    void pathChanged();
+    void nameChanged();
+    void registeredChanged();
+    void activeChanged();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_HOST_H
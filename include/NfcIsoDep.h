@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_ISODEP_H
+#define QNFCDC_ISODEP_H
+
+#include <QtCore/QObject>
+
+class NfcNdefListener;
+class NfcNdefMessage;
+
+// ISO 7816-4 APDU exchange with an ISO-DEP tag. The path is the tag path.
+// 61xx (more data available) and 6Cxx (wrong Le) status words are handled
+// internally, transmitDone delivers the complete response data and the
+// final status word. Since 1.3.0
+
+class NfcIsoDep :
+    public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NfcIsoDep)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
+    Q_PROPERTY(bool present READ present NOTIFY presentChanged)
+
+public:
+    NfcIsoDep(QObject* aParent = Q_NULLPTR);
+    ~NfcIsoDep();
+
+    void setPath(QString);
+    QString path() const;
+
+    bool valid() const;
+    bool present() const;
+
+    // Le is the number of expected bytes, zero meaning no Le field and
+    // 256 (or 65536 for extended APDUs) meaning "as many as available".
+    // Returns zero if the APDU can't be queued.
+    Q_INVOKABLE int transmit(int cla, int ins, int p1, int p2,
+        QByteArray data = QByteArray(), int le = 0);
+    Q_INVOKABLE bool cancel(int);
+
+    // Reads NDEF message using NFC Forum Type 4 Tag procedure. The last
+    // message read is available as ndef(), it's only parsed once.
+    Q_INVOKABLE int readNdef();
+    NfcNdefMessage ndef() const;
+
+    // Writes pre-encoded NDEF message using NFC Forum Type 4 Tag
+    // procedure. NLEN is cleared first and written last. Chunks that
+    // match the last message read are skipped. Returns zero for messages
+    // longer than 0x7ffd bytes, those can't be written with short APDUs
+    // (UPDATE BINARY offset is 15 bits). Since 1.3.0
+    Q_INVOKABLE int writeNdef(QByteArray ndef);
+
+    static QByteArray buildApdu(uchar, uchar, uchar, uchar, const QByteArray&,
+        int);
+
+Q_SIGNALS:
+    void pathChanged();
+    void validChanged();
+    void presentChanged();
+    void transmitDone(int requestId, QByteArray response, uint sw);
+    void transmitFailed(int requestId);
+    void readNdefDone(int requestId, QByteArray ndef);
+    void readNdefFailed(int requestId);
+    void writeNdefDone(int requestId);
+    void writeNdefFailed(int requestId);
+
+private:
+    // For NfcProvisioner. verifyNdef() reads the message back and
+    // compares it with what has been written, the result is only
+    // reported to the listener.
+    friend class NfcProvisioner;
+    void setNdefListener(NfcNdefListener*);
+    int verifyNdef();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_ISODEP_H
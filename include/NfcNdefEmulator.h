@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_NDEF_EMULATOR_H
+#define QNFCDC_NDEF_EMULATOR_H
+
+#include "NfcHost.h"
+
+// NFC Forum Type 4 Tag emulation (read-only) for NfcHost or NfcAidRouter,
+// to be used when nfcd's own one is disabled (see NfcParam::t4Ndef).
+// The image is the contents of the NDEF file, i.e. 2-byte big-endian
+// NLEN followed by the NDEF message. The Capability Container is built
+// once per image, READ BINARY responses point straight into the image
+// and keep it alive until the D-Bus reply is gone.
+// A file image is memory-mapped, so it should be replaced by renaming
+// a new file over it rather than rewritten in place. Replacing the image
+// is atomic with respect to the APDU processing. Since 1.3.0
+
+class NfcNdefEmulator :
+    public NfcHost::Handler
+{
+    Q_DISABLE_COPY(NfcNdefEmulator)
+
+public:
+    NfcNdefEmulator();
+    ~NfcNdefEmulator();
+
+    // Application ID of the NDEF Tag Application
+    static QByteArray aid();
+
+    // NLEN followed by the message
+    static QByteArray buildImage(const QByteArray& aNdef);
+
+    // Return false (and keep the current image) if the image is invalid
+    // or the file can't be mapped
+    bool setImage(const QByteArray& aImage);
+    bool setImageFile(const QString& aPath);
+    void clearImage();
+    bool hasImage() const;
+
+    // NfcHost::Handler
+    uint processApdu(NfcHost*, uchar, uchar, uchar, uchar, const QByteArray&,
+        uint, NfcHost::Response*) Q_DECL_OVERRIDE;
+    void hostReset(NfcHost*) Q_DECL_OVERRIDE;
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_NDEF_EMULATOR_H
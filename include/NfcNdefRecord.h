@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_NDEF_RECORD_H
+#define QNFCDC_NDEF_RECORD_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+class NfcNdefMessage;
+
+// Lightweight view of an NDEF record. It shares the buffer with the
+// message it came from, nothing is copied until it's asked for. Well
+// known types are decoded on demand. Since 1.3.0
+
+class NfcNdefRecord
+{
+public:
+    enum Tnf {
+        TnfEmpty,
+        TnfWellKnown,
+        TnfMediaType,
+        TnfAbsoluteUri,
+        TnfExternal,
+        TnfUnknown,
+        TnfUnchanged,
+        TnfReserved
+    };
+
+    NfcNdefRecord();
+
+    bool isValid() const;
+    Tnf tnf() const;
+    bool isType(Tnf, const char*) const;
+
+    QByteArray type() const;
+    QByteArray id() const;
+
+    // Zero-copy access to the payload. The pointer remains valid as
+    // long as this record (or the message it came from) is around.
+    const uchar* payloadData() const;
+    int payloadSize() const;
+    QByteArray payload() const;
+
+    // Well-known types
+    bool isUri() const;
+    QString uri() const;
+    bool isText() const;
+    QString text() const;
+    QString textLanguage() const;
+    bool isSmartPoster() const;
+    NfcNdefMessage smartPoster() const;
+    bool isMediaType() const;
+    QString mediaType() const;
+
+private:
+    friend class NfcNdefMessage;
+    NfcNdefRecord(const QByteArray&, Tnf, int, int, int, int, int, int);
+
+private:
+    QByteArray iBuffer;
+    Tnf iTnf;
+    int iTypeOffset;
+    int iTypeSize;
+    int iIdOffset;
+    int iIdSize;
+    int iPayloadOffset;
+    int iPayloadSize;
+};
+
+#endif // QNFCDC_NDEF_RECORD_H
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_PROVISIONER_H
+#define QNFCDC_PROVISIONER_H
+
+#include <QtCore/QObject>
+
+// Writes queued pre-encoded NDEF messages to the tags as they show up
+// on the adapter, one message per tag: detect, write, verify (optional)
+// and wait for the tag to go away. Each step is started right from the
+// completion callback of the previous one (on the NFC I/O thread if it's
+// running), only the tag arrival and the per-tag result go through the
+// Qt event loop. Type 2 tags are verified by re-reading just the pages
+// holding the NDEF TLV. If provisioning fails, the message remains at
+// the head of the queue and goes to the next tag. Once the queue runs
+// empty, provisioning stops. Since 1.3.0
+
+class NfcProvisioner :
+    public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NfcProvisioner)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(bool verify READ verify WRITE setVerify NOTIFY verifyChanged)
+    Q_PROPERTY(int pending READ pending NOTIFY pendingChanged)
+    Q_PROPERTY(int provisioned READ provisioned NOTIFY provisionedChanged)
+    Q_PROPERTY(int failed READ failed NOTIFY failedChanged)
+    Q_PROPERTY(qreal throughput READ throughput NOTIFY throughputChanged)
+
+public:
+    NfcProvisioner(QObject* aParent = Q_NULLPTR);
+    ~NfcProvisioner();
+
+    // Adapter path, empty (default) selects the default adapter
+    QString path() const;
+    void setPath(QString);
+
+    bool running() const;
+
+    // Whether the message is read back and compared with what has
+    // been written. Default is true.
+    bool verify() const;
+    void setVerify(bool);
+
+    // Number of queued messages
+    int pending() const;
+
+    // Number of tags successfully provisioned and failures since start()
+    int provisioned() const;
+    int failed() const;
+
+    // Tags per minute, averaged over the last few tags
+    qreal throughput() const;
+
+    Q_INVOKABLE void enqueue(QByteArray ndef);
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE void start();
+    Q_INVOKABLE void stop();
+
+Q_SIGNALS:
+    void pathChanged();
+    void runningChanged();
+    void verifyChanged();
+    void pendingChanged();
+    void provisionedChanged();
+    void failedChanged();
+    void throughputChanged();
+    void tagProvisioned(QString tagPath, QByteArray uid, int msec);
+    void tagFailed(QString tagPath, QByteArray uid);
+    void finished();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_PROVISIONER_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -41,6 +41,7 @@
 #define QNFCDC_SYSTEM_H
 
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 
 class QQmlEngine;
 class QJSEngine;
@@ -55,9 +56,12 @@ class NfcSystem :
     Q_PROPERTY(int version READ version NOTIFY versionChanged)
     Q_PROPERTY(int mode READ mode NOTIFY modeChanged)
     Q_PROPERTY(int techs READ techs NOTIFY techsChanged)
+    Q_PROPERTY(QStringList adapters READ adapters NOTIFY adaptersChanged)
+    Q_PROPERTY(bool coalesceChanges READ coalesceChanges WRITE setCoalesceChanges NOTIFY coalesceChangesChanged)
     Q_ENUMS(DaemonVersion)
     Q_ENUMS(Mode)
     Q_ENUMS(Tech)
+    Q_ENUMS(Property)
 
 public:
     enum DaemonVersion {
@@ -84,12 +88,40 @@ public:
         NfcF = 0x04
     };
 
+    // Bits of the propertiesChanged() mask. Since 1.3.0
+    enum Property {
+        ValidProperty = 0x0002,
+        PresentProperty = 0x0004,
+        EnabledProperty = 0x0010,
+        AdaptersProperty = 0x0020,
+        VersionProperty = 0x0040,
+        ModeProperty = 0x0080,
+        TechsProperty = 0x0100
+    };
+
     NfcSystem(QObject* aParent = Q_NULLPTR);
     ~NfcSystem();
 
     // Callback for qmlRegisterSingletonType<NfcSystem>
     static QObject* createSingleton(QQmlEngine*, QJSEngine*);
 
+    // Moves all D-Bus traffic and libgnfcdc callbacks to a worker thread
+    // with its own GLib main context, so that the objects work even if
+    // the thread they live in doesn't run GLib event loop. Signals are
+    // still delivered to the threads the objects belong to. Must be
+    // called before creating any NFC objects. Since 1.3.0
+    static void startIoThread();
+
+    // libgnfcdc callbacks are invoked by the default GLib main context,
+    // which normally gets dispatched by the Qt event loop. If Qt event
+    // dispatcher isn't GLib based (Qt built without GLib support or
+    // QT_NO_GLIB set in the environment), this function makes the Qt
+    // event loop of the calling thread drive the default context. It's
+    // a no-op if that's not necessary. Must be called on the main thread
+    // after QCoreApplication has been created. Returns false if the GLib
+    // context can't be attached. Since 1.3.0
+    static bool attachGlibContext();
+
     bool valid() const;
     bool present() const;
     bool enabled() const;
@@ -97,6 +129,14 @@ public:
     int mode() const;
     int techs() const;
 
+    // D-Bus paths of all NFC adapters, see NfcAdapter::path and
+    // NfcPathModel::Adapters. Since 1.3.0
+    QStringList adapters() const;
+
+    // Same as NfcAdapter::coalesceChanges. Since 1.3.0
+    bool coalesceChanges() const;
+    void setCoalesceChanges(bool);
+
 Q_SIGNALS:
     void validChanged();
     void presentChanged();
@@ -104,6 +144,9 @@ Q_SIGNALS:
     void versionChanged();
     void modeChanged();
     void techsChanged();
+    void adaptersChanged();  // Since 1.3.0
+    void coalesceChangesChanged();  // Since 1.3.0
+    void propertiesChanged(int mask);  // Since 1.3.0
 
 private:
     class Private;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2024 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -51,6 +51,10 @@ class NfcTag :
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
     Q_PROPERTY(bool present READ present NOTIFY presentChanged)
     Q_PROPERTY(Type type READ type NOTIFY typeChanged)
+    Q_PROPERTY(int technology READ technology NOTIFY identityChanged)
+    Q_PROPERTY(int protocol READ protocol NOTIFY identityChanged)
+    Q_PROPERTY(int tagType READ tagType NOTIFY identityChanged)
+    Q_PROPERTY(QByteArray uid READ uid NOTIFY identityChanged)
     Q_ENUMS(Type)
 
 public:
@@ -70,11 +74,35 @@ public:
     bool present() const;
     Type type() const;
 
+    // Identification data, since 1.3.0. It's fetched from nfcd once per
+    // path, when any of these is first accessed, and identityChanged is
+    // emitted when it arrives. Until then, zeros and empty arrays are
+    // returned. Technology, protocol and tag type are nfcd's NFC_TECHNOLOGY,
+    // NFC_PROTOCOL and NFC_TAG_TYPE values. The UID is NFCID1 (NFC-A) or
+    // NFCID0 (NFC-B). Other poll parameters (e.g. "SEL_RES" for SAK) can
+    // be queried by name. Older versions of nfcd don't provide those.
+    int technology() const;
+    int protocol() const;
+    int tagType() const;
+    QByteArray uid() const;
+    Q_INVOKABLE QByteArray pollParameter(QString) const;
+
+    // Raw frame exchange, since 1.3.0. Returns non-zero request id or
+    // zero if the frame can't be queued (e.g. path is not set). Frames
+    // are sent in the order they are queued, completion is signalled by
+    // transceiveDone or transceiveFailed. The time is in microseconds and
+    // covers the D-Bus round trip, not the queued signal delivery.
+    Q_INVOKABLE int transceive(QByteArray);
+    Q_INVOKABLE bool cancelTransceive(int);
+
 Q_SIGNALS:
     void pathChanged();
     void validChanged();
     void presentChanged();
     void typeChanged();
+    void identityChanged();  // Since 1.3.0
+    void transceiveDone(int requestId, QByteArray response, qint64 usec);  // Since 1.3.0
+    void transceiveFailed(int requestId);  // Since 1.3.0
 
 private:
     class Private;
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TYPE2_H
+#define QNFCDC_TYPE2_H
+
+#include <QtCore/QObject>
+
+class NfcNdefListener;
+class NfcNdefMessage;
+
+// Type 2 tag memory reader. The path is the tag path. Pages are read
+// with FAST_READ (if enabled) or READ, in as few frames as possible, and
+// cached until the path changes. If cacheTtl is set, complete images
+// also go to the process-wide cache keyed by UID and are reused when
+// the same tag is read again. Since 1.3.0
+
+class NfcType2 :
+    public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NfcType2)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
+    Q_PROPERTY(bool present READ present NOTIFY presentChanged)
+    Q_PROPERTY(bool fastRead READ fastRead WRITE setFastRead NOTIFY fastReadChanged)
+    Q_PROPERTY(int cacheTtl READ cacheTtl WRITE setCacheTtl NOTIFY cacheTtlChanged)
+    Q_PROPERTY(int size READ size NOTIFY sizeChanged)
+    Q_PROPERTY(QByteArray data READ data NOTIFY dataChanged)
+
+public:
+    NfcType2(QObject* aParent = Q_NULLPTR);
+    ~NfcType2();
+
+    void setPath(QString);
+    QString path() const;
+
+    bool valid() const;
+    bool present() const;
+
+    // FAST_READ is supported by NTAG21x and most Ultralight EV1 tags.
+    // The reader falls back to READ if the tag rejects it, but older
+    // tags may need to be re-activated after that. Default is true.
+    bool fastRead() const;
+    void setFastRead(bool);
+
+    // How long (in milliseconds) the cached image of a tag with the
+    // same UID remains usable. Before reuse, everything from the UID
+    // through the end of the NDEF TLV (at least 8 pages) is re-read and
+    // compared with the cached image. Memory past the NDEF message (if
+    // any) is assumed to be unchanged. Zero (default) disables it.
+    int cacheTtl() const;
+    void setCacheTtl(int);
+
+    // Maximum number of tags kept in the cache, shared by all instances.
+    static int cacheCapacity();
+    static void setCacheCapacity(int);
+
+    // Size of the whole memory image (including the first 4 pages), as
+    // reported by the Capability Container. Zero if not known yet.
+    int size() const;
+
+    // The whole memory image, once it's been completely read.
+    QByteArray data() const;
+
+    // NDEF message found in the memory image. It's parsed once, when
+    // the image becomes available, and shares the buffer with data().
+    NfcNdefMessage ndef() const;
+
+    // Return non-zero request id or zero on failure. Pages available
+    // in the cache are not re-read.
+    Q_INVOKABLE int read(int page, int count);
+    Q_INVOKABLE int readAll();
+    Q_INVOKABLE void clearCache();
+
+    // Writes pre-encoded NDEF message into the NDEF TLV (replacing the
+    // terminator if there's no NDEF TLV yet). The Capability Container
+    // and the TLVs preceding the NDEF one must have been read. Only the
+    // pages which differ from the cached ones are written. If anything
+    // besides the length changes, the length is cleared first and
+    // written last. Returns zero if the message doesn't fit. Since 1.3.0
+    Q_INVOKABLE int writeNdef(QByteArray ndef);
+
+Q_SIGNALS:
+    void pathChanged();
+    void validChanged();
+    void presentChanged();
+    void fastReadChanged();
+    void cacheTtlChanged();
+    void sizeChanged();
+    void dataChanged();
+    void readDone(int requestId, QByteArray data);
+    void readFailed(int requestId);
+    void writeNdefDone(int requestId);
+    void writeNdefFailed(int requestId);
+
+private:
+    // For NfcProvisioner. verifyNdef() re-reads the pages covering the
+    // NDEF TLV written last and compares them with what has been written,
+    // the result is only reported to the listener.
+    friend class NfcProvisioner;
+    void setNdefListener(NfcNdefListener*);
+    int verifyNdef();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_TYPE2_H
@@ -1,7 +1,7 @@
 TARGET = qnfcdc
 TEMPLATE = lib
 CONFIG += create_pc create_prl no_install_prl link_pkgconfig
-PKGCONFIG += libgnfcdc libglibutil
+PKGCONFIG += libgnfcdc libglibutil gio-2.0
 QT -= gui
 
 include(version.pri)
@@ -21,6 +21,11 @@ CONFIG(debug, debug|release) {
     DEFINES += DEBUG HARBOUR_DEBUG
 }
 
+# qmake CONFIG+=usdt enables static tracepoints, see src/Trace.h
+usdt {
+    DEFINES += QNFCDC_USDT
+}
+
 OTHER_FILES += \
     $${PKGCONFIG_NAME}.prf \
     rpm/libqnfcdc.spec \
@@ -29,24 +34,64 @@ OTHER_FILES += \
 
 SOURCES += \
     src/NfcAdapter.cpp \
+    src/NfcAdapterState.cpp \
+    src/NfcAidRouter.cpp \
+    src/NfcClientPool.cpp \
+    src/NfcEventTrace.cpp \
+    src/NfcGlibDispatcher.cpp \
+    src/NfcHost.cpp \
+    src/NfcIoThread.cpp \
+    src/NfcIsoDep.cpp \
     src/NfcMode.cpp \
+    src/NfcNdefEmulator.cpp \
+    src/NfcNdefMessage.cpp \
+    src/NfcNdefRecord.cpp \
+    src/NfcNdefRecordModel.cpp \
     src/NfcParam.cpp \
+    src/NfcPathModel.cpp \
     src/NfcPeer.cpp \
+    src/NfcProvisioner.cpp \
     src/NfcSystem.cpp \
     src/NfcTag.cpp \
-    src/NfcTech.cpp
+    src/NfcTagCache.cpp \
+    src/NfcTagIdentity.cpp \
+    src/NfcTech.cpp \
+    src/NfcTransceiver.cpp \
+    src/NfcType2.cpp
 
 PUBLIC_HEADERS += \
     include/NfcAdapter.h \
+    include/NfcAdapterState.h \
+    include/NfcAidRouter.h \
+    include/NfcEventTrace.h \
+    include/NfcHost.h \
+    include/NfcIsoDep.h \
     include/NfcMode.h \
+    include/NfcNdefEmulator.h \
+    include/NfcNdefMessage.h \
+    include/NfcNdefRecord.h \
+    include/NfcNdefRecordModel.h \
     include/NfcParam.h \
+    include/NfcPathModel.h \
     include/NfcPeer.h \
+    include/NfcProvisioner.h \
     include/NfcSystem.h \
     include/NfcTag.h \
-    include/NfcTech.h
+    include/NfcTech.h \
+    include/NfcType2.h
 
 HEADERS += \
     src/Debug.h \
+    src/NfcAdapterStatePrivate.h \
+    src/NfcClientPool.h \
+    src/NfcGlibDispatcher.h \
+    src/NfcIoThread.h \
+    src/NfcNdefListener.h \
+    src/NfcSignalTable.h \
+    src/NfcTagCache.h \
+    src/NfcTagIdentity.h \
+    src/NfcTransceiver.h \
+    src/Trace.h \
     $${PUBLIC_HEADERS}
 
 target.path = $$[QT_INSTALL_LIBS]
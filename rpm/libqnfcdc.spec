@@ -1,7 +1,7 @@
 Name:       libqnfcdc
 
 Summary:    Qt interface to nfcd
-Version:    1.2.1
+Version:    1.3.0
 Release:    1
 License:    BSD
 URL:        https://github.com/monich/libqnfcdc
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -37,78 +37,294 @@
  * any official policies, either expressed or implied.
  */
 
+#include <nfcdc_adapter.h>
 #include <nfcdc_default_adapter.h>
 
 #include "NfcAdapter.h"
+#include "NfcAdapterStatePrivate.h"
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+#include "NfcSignalTable.h"
 
 #include "Debug.h"
+#include "Trace.h"
+
+#define PROPERTY_BIT(p) (1 << NFC_DEFAULT_ADAPTER_PROPERTY_##p)
+Q_STATIC_ASSERT(NfcAdapter::PresentProperty == PROPERTY_BIT(ADAPTER));
+Q_STATIC_ASSERT(NfcAdapter::EnabledProperty == PROPERTY_BIT(ENABLED));
+Q_STATIC_ASSERT(NfcAdapter::PoweredProperty == PROPERTY_BIT(POWERED));
+Q_STATIC_ASSERT(NfcAdapter::SupportedModesProperty ==
+    PROPERTY_BIT(SUPPORTED_MODES));
+Q_STATIC_ASSERT(NfcAdapter::ModeProperty == PROPERTY_BIT(MODE));
+Q_STATIC_ASSERT(NfcAdapter::TargetPresentProperty ==
+    PROPERTY_BIT(TARGET_PRESENT));
+Q_STATIC_ASSERT(NfcAdapter::TagPathProperty == PROPERTY_BIT(TAGS));
+Q_STATIC_ASSERT(NfcAdapter::ValidProperty == PROPERTY_BIT(VALID));
+Q_STATIC_ASSERT(NfcAdapter::PeerPathProperty == PROPERTY_BIT(PEERS));
+#ifdef NFCDC_VERSION_1_1_0
+Q_STATIC_ASSERT(NfcAdapter::HostPathProperty == PROPERTY_BIT(HOSTS));
+Q_STATIC_ASSERT(NfcAdapter::SupportedTechsProperty ==
+    PROPERTY_BIT(SUPPORTED_TECHS));
+#endif
+#ifdef NFCDC_VERSION_1_2_0
+Q_STATIC_ASSERT(NfcAdapter::T4NdefProperty == PROPERTY_BIT(T4_NDEF));
+Q_STATIC_ASSERT(NfcAdapter::LaNfcid1Property == PROPERTY_BIT(LA_NFCID1));
+#endif
+#ifdef NFCDC_VERSION_1_2_2
+Q_STATIC_ASSERT(NfcAdapter::LiAHbProperty == PROPERTY_BIT(LI_A_HB));
+#endif
 
 // ==========================================================================
 // NfcAdapter::Private
 // ==========================================================================
 
-class NfcAdapter::Private
+class NfcAdapter::Private :
+    public QObject
 {
+    Q_OBJECT
+
 public:
     Private(NfcAdapter* aParent);
     ~Private();
 
-    static const char* SIGNAL_NAME[];
+    typedef NfcSignalTable<NfcAdapter> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal PROPERTY_SIGNAL[];
+    static const SignalTable& signalTable();
     static void propertyChanged(NfcDefaultAdapter*, NFC_DEFAULT_ADAPTER_PROPERTY, void*);
+    static void clientPropertyChanged(NfcAdapterClient*, NFC_ADAPTER_PROPERTY, void*);
+    static NFC_DEFAULT_ADAPTER_PROPERTY mapProperty(NFC_ADAPTER_PROPERTY);
+    void handleChange(NFC_DEFAULT_ADAPTER_PROPERTY);
+    static gboolean publishChangesCb(gpointer);
+    void publishChanges();
+    void cancelChanges();
+    void warmUpTags();
+
+    NfcAdapterState setPath(const char*);
+    void setDefaultAdapter();
+    void setAdapterClient(const char*);
+    void dropAdapter();
+
+    static QString firstPath(const char* const*);
+    static QString toHex(const GUtilData*);
+    template <class T>
+    static void fillState(NfcAdapterState::Private*, const T*, int);
+    int updateState(int);
+    void publishState(NfcAdapterState::Private*);
+    static void releaseState(NfcAdapterState::Private*);
+    NfcAdapterState state() const;
+
+public Q_SLOTS:
+    void flushChanges();
 
 public:
-    NfcDefaultAdapter* iAdapter;
+    NfcAdapter* iParent;
+    NfcDefaultAdapter* iAdapter;  // When no path is set
+    NfcAdapterClient* iClient;    // Otherwise
+    bool iCoalesceChanges;
+    bool iWarmUpTags;
+    QAtomicInt iPendingChanges;
+    qint64 iPendingTime;          // Protected by NfcIoLock
+    int iDirtyProperties;         // NFC thread only
+    qint64 iCallbackTime;         // NFC thread only
+    GSource* iPublishSource;      // NFC thread only
+    // The current snapshot (holds a reference) is replaced on the NFC
+    // thread and read on any. A replaced snapshot is released once no
+    // reader may be about to reference it, see publishState()
+    QAtomicPointer<NfcAdapterState::Private> iState;
+    mutable QAtomicInt iStateReaders;
+    QList<NfcAdapterState::Private*> iRetiredStates; // NFC thread only
     gulong iAdapterEventId[14];  // Must not be less than the number of non-NULLs:
+    gulong iClientEventId[NFC_ADAPTER_PROPERTY_COUNT];
 };
 
-const char* NfcAdapter::Private::SIGNAL_NAME[] = {
-    Q_NULLPTR,                // NFC_DEFAULT_ADAPTER_PROPERTY_ANY
-    "presentChanged",         // NFC_DEFAULT_ADAPTER_PROPERTY_ADAPTER
-    "enabledChanged",         // NFC_DEFAULT_ADAPTER_PROPERTY_ENABLED
-    "poweredChanged",         // NFC_DEFAULT_ADAPTER_PROPERTY_POWERED
-    "supportedModesChanged",  // NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_MODES
-    "modeChanged",            // NFC_DEFAULT_ADAPTER_PROPERTY_MODE
-    "targetPresentChanged",   // NFC_DEFAULT_ADAPTER_PROPERTY_TARGET_PRESENT
-    "tagPathChanged",         // NFC_DEFAULT_ADAPTER_PROPERTY_TAGS
-    "validChanged",           // NFC_DEFAULT_ADAPTER_PROPERTY_VALID
-    "peerPathChanged",        // NFC_DEFAULT_ADAPTER_PROPERTY_PEERS
+const NfcAdapter::Private::Signal NfcAdapter::Private::PROPERTY_SIGNAL[] = {
+    Q_NULLPTR,                           // NFC_DEFAULT_ADAPTER_PROPERTY_ANY
+    &NfcAdapter::presentChanged,         // NFC_DEFAULT_ADAPTER_PROPERTY_ADAPTER
+    &NfcAdapter::enabledChanged,         // NFC_DEFAULT_ADAPTER_PROPERTY_ENABLED
+    &NfcAdapter::poweredChanged,         // NFC_DEFAULT_ADAPTER_PROPERTY_POWERED
+    &NfcAdapter::supportedModesChanged,  // NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_MODES
+    &NfcAdapter::modeChanged,            // NFC_DEFAULT_ADAPTER_PROPERTY_MODE
+    &NfcAdapter::targetPresentChanged,   // NFC_DEFAULT_ADAPTER_PROPERTY_TARGET_PRESENT
+    &NfcAdapter::tagPathChanged,         // NFC_DEFAULT_ADAPTER_PROPERTY_TAGS
+    &NfcAdapter::validChanged,           // NFC_DEFAULT_ADAPTER_PROPERTY_VALID
+    &NfcAdapter::peerPathChanged,        // NFC_DEFAULT_ADAPTER_PROPERTY_PEERS
 #ifdef NFCDC_VERSION_1_1_0
-    "hostPathChanged",        // NFC_DEFAULT_ADAPTER_PROPERTY_HOSTS
-    "supportedTechsChanged",  // NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_TECHS
+    &NfcAdapter::hostPathChanged,        // NFC_DEFAULT_ADAPTER_PROPERTY_HOSTS
+    &NfcAdapter::supportedTechsChanged,  // NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_TECHS
 #endif
 #ifdef NFCDC_VERSION_1_2_0
-    "t4NdefChanged",          // NFC_DEFAULT_ADAPTER_PROPERTY_T4_NDEF
-    "laNfcid1Changed",        // NFC_DEFAULT_ADAPTER_PROPERTY_LA_NFCID1
+    &NfcAdapter::t4NdefChanged,          // NFC_DEFAULT_ADAPTER_PROPERTY_T4_NDEF
+    &NfcAdapter::laNfcid1Changed,        // NFC_DEFAULT_ADAPTER_PROPERTY_LA_NFCID1
 #endif
 #ifdef NFCDC_VERSION_1_2_2
-    "liAHbChanged",           // NFC_DEFAULT_ADAPTER_PROPERTY_LI_A_HB
+    &NfcAdapter::liAHbChanged,           // NFC_DEFAULT_ADAPTER_PROPERTY_LI_A_HB
 #endif
     // Remember to update iAdapterEventId count when adding new handlers!
 };
 
 NfcAdapter::Private::Private(
     NfcAdapter* aParent) :
-    iAdapter(nfc_default_adapter_new())
+    iParent(aParent),
+    iAdapter(Q_NULLPTR),
+    iClient(Q_NULLPTR),
+    iCoalesceChanges(false),
+    iWarmUpTags(false),
+    iPendingChanges(0),
+    iPendingTime(0),
+    iDirtyProperties(0),
+    iCallbackTime(0),
+    iPublishSource(Q_NULLPTR),
+    iState(Q_NULLPTR),
+    iStateReaders(0)
+{
+    memset(iAdapterEventId, 0, sizeof(iAdapterEventId));
+    memset(iClientEventId, 0, sizeof(iClientEventId));
+
+    NfcIoLock lock;
+
+    publishState(new NfcAdapterState::Private);
+    setDefaultAdapter();
+    updateState(~0);
+}
+
+NfcAdapter::Private::~Private()
+{
+    NfcIoLock lock;
+
+    dropAdapter();
+
+    // Nothing can be reading the state anymore
+    releaseState(iState.fetchAndStoreOrdered(Q_NULLPTR));
+    while (!iRetiredStates.isEmpty()) {
+        releaseState(iRetiredStates.takeLast());
+    }
+}
+
+NfcAdapterState
+NfcAdapter::Private::setPath(
+    const char* aPath)
 {
-    uint k = 0;
-    for (uint i = 0; i < G_N_ELEMENTS(SIGNAL_NAME); i++) {
-        if (SIGNAL_NAME[i]) {
+    NfcIoLock lock;
+
+    HTRACE2(adapter_path, this, aPath);
+    if (aPath) {
+        setAdapterClient(aPath);
+    } else {
+        setDefaultAdapter();
+    }
+    updateState(~0);
+    return state();
+}
+
+void
+NfcAdapter::Private::setDefaultAdapter()
+{
+    const SignalTable& table = signalTable();
+    int k = 0;
+
+    dropAdapter();
+    iAdapter = nfc_default_adapter_new();
+    for (int i = 0; i < table.count(); i++) {
+        if (table.contains(i)) {
             iAdapterEventId[k++] =
                 nfc_default_adapter_add_property_handler(iAdapter,
                     (NFC_DEFAULT_ADAPTER_PROPERTY)i, propertyChanged,
-                    aParent);
+                    this);
         }
     }
-    HASSERT(k <= G_N_ELEMENTS(iAdapterEventId));
-    while (k < G_N_ELEMENTS(iAdapterEventId)) {
-        iAdapterEventId[k++] = 0;
+    HASSERT(k <= (int)G_N_ELEMENTS(iAdapterEventId));
+}
+
+void
+NfcAdapter::Private::setAdapterClient(
+    const char* aPath)
+{
+    dropAdapter();
+    iClient = nfc_adapter_client_new(aPath);
+    for (int i = NFC_ADAPTER_PROPERTY_ANY + 1;
+         i < NFC_ADAPTER_PROPERTY_COUNT; i++) {
+        const NFC_ADAPTER_PROPERTY p = (NFC_ADAPTER_PROPERTY)i;
+
+        if (mapProperty(p) != NFC_DEFAULT_ADAPTER_PROPERTY_ANY) {
+            iClientEventId[i] = nfc_adapter_client_add_property_handler(
+                iClient, p, clientPropertyChanged, this);
+        }
     }
 }
 
-NfcAdapter::Private::~Private()
+void
+NfcAdapter::Private::dropAdapter()
+{
+    cancelChanges();
+    if (iAdapter) {
+        nfc_default_adapter_remove_all_handlers(iAdapter, iAdapterEventId);
+        nfc_default_adapter_unref(iAdapter);
+        iAdapter = Q_NULLPTR;
+    }
+    if (iClient) {
+        nfc_adapter_client_remove_all_handlers(iClient, iClientEventId);
+        nfc_adapter_client_unref(iClient);
+        iClient = Q_NULLPTR;
+    }
+}
+
+/* static */
+const NfcAdapter::Private::SignalTable&
+NfcAdapter::Private::signalTable()
+{
+    static const SignalTable table(PROPERTY_SIGNAL,
+        G_N_ELEMENTS(PROPERTY_SIGNAL));
+
+    return table;
+}
+
+/* static */
+NFC_DEFAULT_ADAPTER_PROPERTY
+NfcAdapter::Private::mapProperty(
+    NFC_ADAPTER_PROPERTY aProperty)
 {
-    nfc_default_adapter_remove_all_handlers(iAdapter, iAdapterEventId);
-    nfc_default_adapter_unref(iAdapter);
+    // Signals (and propertiesChanged bits) are indexed by default
+    // adapter properties, adapter client ones are numbered differently
+    switch (aProperty) {
+    case NFC_ADAPTER_PROPERTY_VALID:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_VALID;
+    case NFC_ADAPTER_PROPERTY_PRESENT:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_ADAPTER;
+    case NFC_ADAPTER_PROPERTY_ENABLED:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_ENABLED;
+    case NFC_ADAPTER_PROPERTY_POWERED:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_POWERED;
+    case NFC_ADAPTER_PROPERTY_SUPPORTED_MODES:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_MODES;
+    case NFC_ADAPTER_PROPERTY_MODE:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_MODE;
+    case NFC_ADAPTER_PROPERTY_TARGET_PRESENT:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_TARGET_PRESENT;
+    case NFC_ADAPTER_PROPERTY_TAGS:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_TAGS;
+    case NFC_ADAPTER_PROPERTY_PEERS:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_PEERS;
+#ifdef NFCDC_VERSION_1_1_0
+    case NFC_ADAPTER_PROPERTY_HOSTS:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_HOSTS;
+    case NFC_ADAPTER_PROPERTY_SUPPORTED_TECHS:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_SUPPORTED_TECHS;
+#endif
+#ifdef NFCDC_VERSION_1_2_0
+    case NFC_ADAPTER_PROPERTY_T4_NDEF:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_T4_NDEF;
+    case NFC_ADAPTER_PROPERTY_LA_NFCID1:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_LA_NFCID1;
+#endif
+#ifdef NFCDC_VERSION_1_2_2
+    case NFC_ADAPTER_PROPERTY_LI_A_HB:
+        return NFC_DEFAULT_ADAPTER_PROPERTY_LI_A_HB;
+#endif
+    default:
+        break;
+    }
+    return NFC_DEFAULT_ADAPTER_PROPERTY_ANY;
 }
 
 /* static */
@@ -116,12 +332,314 @@ void
 NfcAdapter::Private::propertyChanged(
     NfcDefaultAdapter*,
     NFC_DEFAULT_ADAPTER_PROPERTY aProperty,
-    void* aTarget)
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->handleChange(aProperty);
+}
+
+/* static */
+void
+NfcAdapter::Private::clientPropertyChanged(
+    NfcAdapterClient*,
+    NFC_ADAPTER_PROPERTY aProperty,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->handleChange(mapProperty(aProperty));
+}
+
+void
+NfcAdapter::Private::handleChange(
+    NFC_DEFAULT_ADAPTER_PROPERTY aProperty)
+{
+    // For NfcEventTrace, the first callback of the batch counts
+    const qint64 time = SignalTable::callbackTime();
+
+    HTRACE2(adapter_property, this, aProperty);
+    if (iWarmUpTags && aProperty == NFC_DEFAULT_ADAPTER_PROPERTY_TAGS) {
+        // Before anything else, to get D-Bus calls going
+        warmUpTags();
+    }
+
+    iDirtyProperties |= (1 << aProperty);
+    if (!iCallbackTime) {
+        iCallbackTime = time;
+    }
+    if (!iCoalesceChanges) {
+        // Straight away, without an extra GLib iteration
+        publishChanges();
+    } else if (!iPublishSource) {
+        // Several properties usually change at once (e.g. tags and
+        // target presence), a single snapshot is published for all of
+        // them after the current GLib dispatch is done
+        iPublishSource = g_idle_source_new();
+        g_source_set_priority(iPublishSource, G_PRIORITY_DEFAULT);
+        g_source_set_callback(iPublishSource, publishChangesCb, this, NULL);
+        g_source_attach(iPublishSource, g_main_context_get_thread_default());
+    }
+}
+
+/* static */
+gboolean
+NfcAdapter::Private::publishChangesCb(
+    gpointer aPrivate)
+{
+    Private* self = (Private*)aPrivate;
+
+    g_source_unref(self->iPublishSource);
+    self->iPublishSource = Q_NULLPTR;
+    self->publishChanges();
+    return G_SOURCE_REMOVE;
+}
+
+void
+NfcAdapter::Private::publishChanges()
+{
+    const int changes = updateState(iDirtyProperties);
+    const qint64 time = iCallbackTime;
+
+    iDirtyProperties = 0;
+    iCallbackTime = 0;
+    if (changes) {
+        // Qt signals should be signalled from the Qt event loop
+        // See https://bugreports.qt.io/browse/QTBUG-18434 for details
+        if (iCoalesceChanges) {
+            // Changes may be flushed on another thread
+            if (!iPendingChanges.fetchAndOrOrdered(changes)) {
+                static const QMetaMethod flushChanges(nfcSlot<Private>(
+                    "flushChanges()"));
+
+                iPendingTime = time;
+                flushChanges.invoke(this, Qt::QueuedConnection);
+            }
+        } else {
+            static const QMetaMethod stateChanged(QMetaMethod::fromSignal(
+                &NfcAdapter::stateChanged));
+            const SignalTable& table = signalTable();
+
+            for (int i = 0; i < table.count(); i++) {
+                if (changes & (1 << i)) {
+                    table.emitQueued(iParent, i, time);
+                }
+            }
+            stateChanged.invoke(iParent, Qt::QueuedConnection);
+        }
+    }
+}
+
+void
+NfcAdapter::Private::cancelChanges()
+{
+    if (iPublishSource) {
+        g_source_destroy(iPublishSource);
+        g_source_unref(iPublishSource);
+        iPublishSource = Q_NULLPTR;
+    }
+    iDirtyProperties = 0;
+    iCallbackTime = 0;
+}
+
+void
+NfcAdapter::Private::warmUpTags()
+{
+    const char* const* tags = iClient ? iClient->tags :
+        iAdapter ? iAdapter->tags : Q_NULLPTR;
+
+    if (tags) {
+        NfcClientPool* pool = NfcClientPool::get();
+
+        while (*tags) {
+            pool->warmUpTag(*tags++);
+        }
+    }
+}
+
+/* static */
+QString
+NfcAdapter::Private::firstPath(
+    const char* const* aPaths)
+{
+    const char* path = aPaths ? aPaths[0] : Q_NULLPTR;
+
+    return (path && path[0]) ? QString(path) : QString();
+}
+
+/* static */
+QString
+NfcAdapter::Private::toHex(
+    const GUtilData* aData)
+{
+    return aData ? QString(QByteArray((char*)aData->bytes,
+        aData->size).toHex()) : QString();
+}
+
+// NfcDefaultAdapter mirrors NfcAdapterClient fields. Only the fields
+// selected by the mask (NfcAdapter::Property bits) are updated.
+template <class T>
+void
+NfcAdapter::Private::fillState(
+    NfcAdapterState::Private* aState,
+    const T* aAdapter,
+    int aMask)
+{
+    if (aMask & ValidProperty) {
+        aState->iInterfaceVersion = aAdapter->version;
+        aState->iValid = aAdapter->valid;
+    }
+    if (aMask & EnabledProperty) {
+        aState->iEnabled = aAdapter->enabled;
+    }
+    if (aMask & PoweredProperty) {
+        aState->iPowered = aAdapter->powered;
+    }
+    if (aMask & TargetPresentProperty) {
+        aState->iTargetPresent = aAdapter->target_present;
+    }
+    if (aMask & SupportedModesProperty) {
+        aState->iSupportedModes = aAdapter->supported_modes;
+    }
+    if (aMask & ModeProperty) {
+        aState->iMode = aAdapter->mode;
+    }
+    if (aMask & TagPathProperty) {
+        aState->iTagPath = firstPath(aAdapter->tags);
+    }
+    if (aMask & PeerPathProperty) {
+        aState->iPeerPath = firstPath(aAdapter->peers);
+    }
+#ifdef NFCDC_VERSION_1_1_0
+    if (aMask & HostPathProperty) {
+        aState->iHostPath = firstPath(aAdapter->hosts);
+    }
+    if (aMask & SupportedTechsProperty) {
+        aState->iSupportedTechs = aAdapter->supported_techs;
+    }
+#else
+    #pragma message("Please use libgnfcdc 1.1.0 or newer")
+#endif
+#ifdef NFCDC_VERSION_1_2_0
+    if (aMask & T4NdefProperty) {
+        aState->iT4Ndef = aAdapter->t4_ndef;
+    }
+    if (aMask & LaNfcid1Property) {
+        aState->iLaNfcid1 = toHex(aAdapter->la_nfcid1);
+    }
+#else
+    #pragma message("Please use libgnfcdc 1.2.0 or newer")
+#endif
+#ifdef NFCDC_VERSION_1_2_2
+    if (aMask & LiAHbProperty) {
+        aState->iLiAHb = toHex(aAdapter->li_a_hb);
+    }
+#else
+    #pragma message("Please use libgnfcdc 1.2.2 or newer")
+#endif
+}
+
+// Publishes a new snapshot if anything has changed, returns the mask
+// of changed properties. Must be called on the NFC thread.
+int
+NfcAdapter::Private::updateState(
+    int aMask)
+{
+    const NfcAdapterState::Private* current = iState.load();
+    NfcAdapterState::Private* state;
+
+    // Everything else may change along with validity or presence
+    // without being reported separately
+    if (aMask & (ValidProperty | PresentProperty)) {
+        aMask = ~0;
+    }
+    if (iClient) {
+        state = new NfcAdapterState::Private(*current);
+        fillState(state, iClient, aMask);
+        state->iPresent = iClient->present;
+    } else if (iAdapter) {
+        state = new NfcAdapterState::Private(*current);
+        fillState(state, iAdapter, aMask);
+        state->iPresent = (iAdapter->adapter != Q_NULLPTR);
+    } else {
+        state = new NfcAdapterState::Private;
+    }
+
+    const int changes = current->diff(*state);
+
+    if (changes) {
+        publishState(state);
+    } else {
+        delete state;
+    }
+    return changes;
+}
+
+void
+NfcAdapter::Private::publishState(
+    NfcAdapterState::Private* aState)
+{
+    aState->ref.ref();
+
+    NfcAdapterState::Private* prev = iState.fetchAndStoreOrdered(aState);
+
+    // A reader which has loaded the previous pointer but hasn't yet
+    // referenced it is still counted in iStateReaders (both sides use
+    // ordered operations). Retired snapshots are released when there
+    // are no readers, at the latest on the next update.
+    if (prev) {
+        iRetiredStates.append(prev);
+    }
+    if (!iStateReaders.loadAcquire()) {
+        while (!iRetiredStates.isEmpty()) {
+            releaseState(iRetiredStates.takeLast());
+        }
+    }
+}
+
+/* static */
+void
+NfcAdapter::Private::releaseState(
+    NfcAdapterState::Private* aState)
+{
+    if (aState && !aState->ref.deref()) {
+        delete aState;
+    }
+}
+
+NfcAdapterState
+NfcAdapter::Private::state() const
 {
-    // Qt signals should be signalled from the Qt event loop
-    // See https://bugreports.qt.io/browse/QTBUG-18434 for details
-    QMetaObject::invokeMethod((QObject*)aTarget, SIGNAL_NAME[aProperty],
-        Qt::QueuedConnection);
+    iStateReaders.ref();
+    const NfcAdapterState state(iState.loadAcquire());
+    iStateReaders.deref();
+    return state;
+}
+
+void
+NfcAdapter::Private::flushChanges()
+{
+    int mask;
+    qint64 time;
+
+    // Only to pick up the time along with the changes, the signals are
+    // emitted without holding the lock
+    {
+        NfcIoLock lock;
+
+        mask = iPendingChanges.fetchAndStoreOrdered(0);
+        time = iPendingTime;
+        iPendingTime = 0;
+    }
+
+    if (mask) {
+        const SignalTable& table = signalTable();
+
+        HDEBUG("Changes" << mask);
+        for (int i = 0; i < table.count(); i++) {
+            if (mask & (1 << i)) {
+                table.emitDirect(iParent, i, time);
+            }
+        }
+        Q_EMIT iParent->propertiesChanged(mask);
+        Q_EMIT iParent->stateChanged();
+    }
 }
 
 // ==========================================================================
@@ -152,120 +670,182 @@ NfcAdapter::createSingleton(
 int
 NfcAdapter::interfaceVersion() const
 {
-    return iPrivate->iAdapter->version;
+    return iPrivate->state().interfaceVersion();
 }
 
 bool
 NfcAdapter::valid() const
 {
-    return iPrivate->iAdapter->valid;
+    return iPrivate->state().valid();
 }
 
 bool
 NfcAdapter::present() const
 {
-    return iPrivate->iAdapter->adapter != Q_NULLPTR;
+    return iPrivate->state().present();
 }
 
 bool
 NfcAdapter::enabled() const
 {
-    return iPrivate->iAdapter->enabled;
+    return iPrivate->state().enabled();
 }
 
 bool
 NfcAdapter::powered() const
 {
-    return iPrivate->iAdapter->powered;
+    return iPrivate->state().powered();
 }
 
 bool
 NfcAdapter::targetPresent() const
 {
-    return iPrivate->iAdapter->target_present;
+    return iPrivate->state().targetPresent();
 }
 
 int
 NfcAdapter::supportedModes() const
 {
-    return iPrivate->iAdapter->supported_modes;
+    return iPrivate->state().supportedModes();
 }
 
 int
 NfcAdapter::mode() const
 {
-    return iPrivate->iAdapter->mode;
+    return iPrivate->state().mode();
 }
 
 QString
 NfcAdapter::tagPath() const
 {
-    const char* tag = iPrivate->iAdapter->tags[0];
-    return (tag && tag[0]) ? QString(tag) : QString();
+    return iPrivate->state().tagPath();
 }
 
 QString
 NfcAdapter::peerPath() const
 {
-    const char* peer = iPrivate->iAdapter->peers[0];
-    return (peer && peer[0]) ? QString(peer) : QString();
+    return iPrivate->state().peerPath();
 }
 
 QString
 NfcAdapter::hostPath() const
 {
-#ifdef NFCDC_VERSION_1_1_0
-    const char* host = iPrivate->iAdapter->hosts[0];
-    return (host && host[0]) ? QString(host) : QString();
-#else
-    #pragma message("Please use libgnfcdc 1.1.0 or newer")
-    return QString();
-#endif
+    return iPrivate->state().hostPath();
 }
 
 int
 NfcAdapter::supportedTechs() const
 {
-#ifdef NFCDC_VERSION_1_1_0
-    return iPrivate->iAdapter->supported_techs;
-#else
-    #pragma message("Please use libgnfcdc 1.1.0 or newer")
-    return 0;
-#endif
+    return iPrivate->state().supportedTechs();
 }
 
 bool
 NfcAdapter::t4Ndef() const
 {
-#ifdef NFCDC_VERSION_1_2_0
-    return iPrivate->iAdapter->t4_ndef;
-#else
-    #pragma message("Please use libgnfcdc 1.2.0 or newer")
-    return true;
-#endif
+    return iPrivate->state().t4Ndef();
 }
 
 QString
 NfcAdapter::laNfcid1() const
 {
-#ifdef NFCDC_VERSION_1_2_0
-    const GUtilData* nfcid1 = iPrivate->iAdapter->la_nfcid1;
-    return nfcid1 ? QByteArray((char*)nfcid1->bytes, nfcid1->size).toHex() :
-        QString();
-#else
-    #pragma message("Please use libgnfcdc 1.2.0 or newer")
-    return QString();
-#endif
+    return iPrivate->state().laNfcid1();
 }
 
 QString
 NfcAdapter::liAHb() const
 {
-#ifdef NFCDC_VERSION_1_2_2
-    const GUtilData* hb = iPrivate->iAdapter->li_a_hb;
-    return hb ? QByteArray((char*)hb->bytes, hb->size).toHex() : QString();
-#else
-    #pragma message("Please use libgnfcdc 1.2.2 or newer")
-    return QString();
-#endif
+    return iPrivate->state().liAHb();
+}
+
+NfcAdapterState
+NfcAdapter::state() const
+{
+    return iPrivate->state();
 }
+
+QString
+NfcAdapter::path() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iClient ? QString(iPrivate->iClient->path) : QString();
+}
+
+void
+NfcAdapter::setPath(
+    QString aPath)
+{
+    if (path() != aPath) {
+        const NfcAdapterState prevState(iPrivate->state());
+        NfcAdapterState newState;
+
+        HDEBUG(aPath);
+        if (aPath.isEmpty()) {
+            newState = iPrivate->setPath(Q_NULLPTR);
+        } else {
+            const QByteArray bytes(aPath.toLatin1());
+
+            newState = iPrivate->setPath(bytes.constData());
+        }
+
+        const int changes = prevState.iPrivate.constData()->diff(
+            *newState.iPrivate.constData());
+        const Private::SignalTable& table = Private::signalTable();
+
+        Q_EMIT pathChanged();
+        for (int i = 0; i < table.count(); i++) {
+            if (changes & (1 << i)) {
+                table.emitDirect(this, i);
+            }
+        }
+        if (changes) {
+            Q_EMIT stateChanged();
+            if (iPrivate->iCoalesceChanges) {
+                Q_EMIT propertiesChanged(changes);
+            }
+        }
+    }
+}
+
+bool
+NfcAdapter::coalesceChanges() const
+{
+    return iPrivate->iCoalesceChanges;
+}
+
+void
+NfcAdapter::setCoalesceChanges(
+    bool aCoalesce)
+{
+    NfcIoLock lock;
+
+    if (iPrivate->iCoalesceChanges != aCoalesce) {
+        // Changes which have already been accumulated are still
+        // delivered by the pending flush
+        iPrivate->iCoalesceChanges = aCoalesce;
+        Q_EMIT coalesceChangesChanged();
+    }
+}
+
+bool
+NfcAdapter::warmUpTags() const
+{
+    return iPrivate->iWarmUpTags;
+}
+
+void
+NfcAdapter::setWarmUpTags(
+    bool aWarmUp)
+{
+    NfcIoLock lock;
+
+    if (iPrivate->iWarmUpTags != aWarmUp) {
+        iPrivate->iWarmUpTags = aWarmUp;
+        if (aWarmUp) {
+            iPrivate->warmUpTags();
+        }
+        Q_EMIT warmUpTagsChanged();
+    }
+}
+
+#include "NfcAdapter.moc"
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcAdapterStatePrivate.h"
+
+// ==========================================================================
+// NfcAdapterState::Private
+// ==========================================================================
+
+NfcAdapterState::Private::Private() :
+    iInterfaceVersion(0),
+    iValid(false),
+    iPresent(false),
+    iEnabled(false),
+    iPowered(false),
+    iTargetPresent(false),
+    iT4Ndef(true),
+    iSupportedModes(0),
+    iSupportedTechs(0),
+    iMode(0)
+{
+}
+
+bool
+NfcAdapterState::Private::equals(
+    const Private& aOther) const
+{
+    return iInterfaceVersion == aOther.iInterfaceVersion &&
+        iValid == aOther.iValid &&
+        iPresent == aOther.iPresent &&
+        iEnabled == aOther.iEnabled &&
+        iPowered == aOther.iPowered &&
+        iTargetPresent == aOther.iTargetPresent &&
+        iT4Ndef == aOther.iT4Ndef &&
+        iSupportedModes == aOther.iSupportedModes &&
+        iSupportedTechs == aOther.iSupportedTechs &&
+        iMode == aOther.iMode &&
+        iTagPath == aOther.iTagPath &&
+        iPeerPath == aOther.iPeerPath &&
+        iHostPath == aOther.iHostPath &&
+        iLaNfcid1 == aOther.iLaNfcid1 &&
+        iLiAHb == aOther.iLiAHb;
+}
+
+int
+NfcAdapterState::Private::diff(
+    const Private& aOther) const
+{
+    int mask = 0;
+
+    if (iInterfaceVersion != aOther.iInterfaceVersion ||
+        iValid != aOther.iValid) {
+        mask |= NfcAdapter::ValidProperty;
+    }
+    if (iPresent != aOther.iPresent) {
+        mask |= NfcAdapter::PresentProperty;
+    }
+    if (iEnabled != aOther.iEnabled) {
+        mask |= NfcAdapter::EnabledProperty;
+    }
+    if (iPowered != aOther.iPowered) {
+        mask |= NfcAdapter::PoweredProperty;
+    }
+    if (iTargetPresent != aOther.iTargetPresent) {
+        mask |= NfcAdapter::TargetPresentProperty;
+    }
+    if (iT4Ndef != aOther.iT4Ndef) {
+        mask |= NfcAdapter::T4NdefProperty;
+    }
+    if (iSupportedModes != aOther.iSupportedModes) {
+        mask |= NfcAdapter::SupportedModesProperty;
+    }
+    if (iSupportedTechs != aOther.iSupportedTechs) {
+        mask |= NfcAdapter::SupportedTechsProperty;
+    }
+    if (iMode != aOther.iMode) {
+        mask |= NfcAdapter::ModeProperty;
+    }
+    if (iTagPath != aOther.iTagPath) {
+        mask |= NfcAdapter::TagPathProperty;
+    }
+    if (iPeerPath != aOther.iPeerPath) {
+        mask |= NfcAdapter::PeerPathProperty;
+    }
+    if (iHostPath != aOther.iHostPath) {
+        mask |= NfcAdapter::HostPathProperty;
+    }
+    if (iLaNfcid1 != aOther.iLaNfcid1) {
+        mask |= NfcAdapter::LaNfcid1Property;
+    }
+    if (iLiAHb != aOther.iLiAHb) {
+        mask |= NfcAdapter::LiAHbProperty;
+    }
+    return mask;
+}
+
+// ==========================================================================
+// NfcAdapterState
+// ==========================================================================
+
+NfcAdapterState::NfcAdapterState() :
+    iPrivate(new Private)
+{
+}
+
+NfcAdapterState::NfcAdapterState(
+    Private* aPrivate) :
+    iPrivate(aPrivate)
+{
+}
+
+NfcAdapterState::NfcAdapterState(
+    const NfcAdapterState& aState) :
+    iPrivate(aState.iPrivate)
+{
+}
+
+NfcAdapterState::~NfcAdapterState()
+{
+}
+
+NfcAdapterState&
+NfcAdapterState::operator=(
+    const NfcAdapterState& aState)
+{
+    iPrivate = aState.iPrivate;
+    return *this;
+}
+
+bool
+NfcAdapterState::operator==(
+    const NfcAdapterState& aState) const
+{
+    return iPrivate == aState.iPrivate ||
+        iPrivate.constData()->equals(*aState.iPrivate.constData());
+}
+
+bool
+NfcAdapterState::operator!=(
+    const NfcAdapterState& aState) const
+{
+    return !operator==(aState);
+}
+
+int
+NfcAdapterState::interfaceVersion() const
+{
+    return iPrivate->iInterfaceVersion;
+}
+
+bool
+NfcAdapterState::valid() const
+{
+    return iPrivate->iValid;
+}
+
+bool
+NfcAdapterState::present() const
+{
+    return iPrivate->iPresent;
+}
+
+bool
+NfcAdapterState::enabled() const
+{
+    return iPrivate->iEnabled;
+}
+
+bool
+NfcAdapterState::powered() const
+{
+    return iPrivate->iPowered;
+}
+
+bool
+NfcAdapterState::targetPresent() const
+{
+    return iPrivate->iTargetPresent;
+}
+
+int
+NfcAdapterState::supportedModes() const
+{
+    return iPrivate->iSupportedModes;
+}
+
+int
+NfcAdapterState::supportedTechs() const
+{
+    return iPrivate->iSupportedTechs;
+}
+
+int
+NfcAdapterState::mode() const
+{
+    return iPrivate->iMode;
+}
+
+QString
+NfcAdapterState::tagPath() const
+{
+    return iPrivate->iTagPath;
+}
+
+QString
+NfcAdapterState::peerPath() const
+{
+    return iPrivate->iPeerPath;
+}
+
+QString
+NfcAdapterState::hostPath() const
+{
+    return iPrivate->iHostPath;
+}
+
+QString
+NfcAdapterState::laNfcid1() const
+{
+    return iPrivate->iLaNfcid1;
+}
+
+QString
+NfcAdapterState::liAHb() const
+{
+    return iPrivate->iLiAHb;
+}
+
+bool
+NfcAdapterState::t4Ndef() const
+{
+    return iPrivate->iT4Ndef;
+}
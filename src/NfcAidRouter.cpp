@@ -0,0 +1,518 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcAidRouter.h"
+#include "NfcIoThread.h"
+
+#include "Debug.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+
+#define ISO_INS_SELECT (0xa4)
+#define ISO_P1_SELECT_BY_NAME (0x04)
+#define ISO_P2_OCCURRENCE_MASK (0x03)
+#define ISO_P2_SELECT_NEXT (0x02)
+#define ISO_SW1_OK (0x90)
+#define ISO_SW1_MORE_DATA (0x61)
+#define ISO_SW1_WARNING_1 (0x62)
+#define ISO_SW1_WARNING_2 (0x63)
+#define ISO_SW_FILE_NOT_FOUND (0x6a82)
+#define ISO_SW_INS_NOT_SUPPORTED (0x6d00)
+
+#define AID_MAX_SIZE (16)
+
+// ==========================================================================
+// NfcAidRouter::Private
+// ==========================================================================
+
+class NfcAidRouter::Private
+{
+public:
+    class Node;
+    class Route {
+    public:
+        Route(const QByteArray& aAid, NfcHost::Handler* aHandler) :
+            iAid(aAid), iHandler(aHandler) {}
+
+    public:
+        const QByteArray iAid;
+        NfcHost::Handler* iHandler;
+        Stats iStats;
+    };
+
+    Private();
+    ~Private();
+
+    Node* find(const QByteArray&) const;
+    Route* select(const QByteArray&, bool);
+    void collect(const Node*, QList<QByteArray>*) const;
+
+    void forget(const Node*);
+
+    static Node* next(Node*, const Node*);
+    static Node* nextRoute(Node*, const Node*);
+    static bool selected(uint);
+
+public:
+    Node* iRoot;
+    Node* iSelected;    // The application the APDUs go to
+    Node* iOccurrence;  // Where the "next occurrence" search continues
+};
+
+// ==========================================================================
+// NfcAidRouter::Private::Node
+//
+// Prefix tree node. Children are sorted by byte value, so that the
+// pre-order walk visits AIDs in the "first/next occurrence" order.
+// ==========================================================================
+
+class NfcAidRouter::Private::Node
+{
+public:
+    Node(Node* aParent, uchar aByte) :
+        iParent(aParent), iByte(aByte), iRoute(Q_NULLPTR) {}
+    ~Node() { qDeleteAll(iChildren); delete iRoute; }
+
+    int lowerBound(uchar) const;
+    Node* child(uchar) const;
+    Node* addChild(uchar);
+    void removeChild(Node*);
+
+public:
+    Node* iParent;
+    const uchar iByte;
+    Route* iRoute;
+    QVector<Node*> iChildren;
+};
+
+int
+NfcAidRouter::Private::Node::lowerBound(
+    uchar aByte) const
+{
+    int low = 0, high = iChildren.count();
+
+    while (low < high) {
+        const int mid = (low + high) / 2;
+
+        if (iChildren.at(mid)->iByte < aByte) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+NfcAidRouter::Private::Node*
+NfcAidRouter::Private::Node::child(
+    uchar aByte) const
+{
+    const int i = lowerBound(aByte);
+
+    return (i < iChildren.count() && iChildren.at(i)->iByte == aByte) ?
+        iChildren.at(i) : Q_NULLPTR;
+}
+
+NfcAidRouter::Private::Node*
+NfcAidRouter::Private::Node::addChild(
+    uchar aByte)
+{
+    const int i = lowerBound(aByte);
+
+    if (i < iChildren.count() && iChildren.at(i)->iByte == aByte) {
+        return iChildren.at(i);
+    } else {
+        Node* node = new Node(this, aByte);
+
+        iChildren.insert(i, node);
+        return node;
+    }
+}
+
+void
+NfcAidRouter::Private::Node::removeChild(
+    Node* aNode)
+{
+    const int i = lowerBound(aNode->iByte);
+
+    HASSERT(iChildren.at(i) == aNode);
+    iChildren.remove(i);
+    delete aNode;
+}
+
+// ==========================================================================
+// NfcAidRouter::Private
+// ==========================================================================
+
+NfcAidRouter::Private::Private() :
+    iRoot(new Node(Q_NULLPTR, 0)),
+    iSelected(Q_NULLPTR),
+    iOccurrence(Q_NULLPTR)
+{
+}
+
+NfcAidRouter::Private::~Private()
+{
+    delete iRoot;
+}
+
+NfcAidRouter::Private::Node*
+NfcAidRouter::Private::find(
+    const QByteArray& aPrefix) const
+{
+    const uchar* ptr = (const uchar*)aPrefix.constData();
+    const uchar* end = ptr + aPrefix.size();
+    Node* node = iRoot;
+
+    while (node && ptr < end) {
+        node = node->child(*ptr++);
+    }
+    return node;
+}
+
+/* static */
+NfcAidRouter::Private::Node*
+NfcAidRouter::Private::next(
+    Node* aNode,
+    const Node* aRoot)
+{
+    // Pre-order successor within the subtree
+    if (!aNode->iChildren.isEmpty()) {
+        return aNode->iChildren.first();
+    }
+    while (aNode != aRoot) {
+        Node* parent = aNode->iParent;
+        const int i = parent->lowerBound(aNode->iByte) + 1;
+
+        if (i < parent->iChildren.count()) {
+            return parent->iChildren.at(i);
+        }
+        aNode = parent;
+    }
+    return Q_NULLPTR;
+}
+
+/* static */
+NfcAidRouter::Private::Node*
+NfcAidRouter::Private::nextRoute(
+    Node* aNode,
+    const Node* aRoot)
+{
+    do {
+        aNode = next(aNode, aRoot);
+    } while (aNode && !aNode->iRoute);
+    return aNode;
+}
+
+NfcAidRouter::Private::Route*
+NfcAidRouter::Private::select(
+    const QByteArray& aPrefix,
+    bool aNext)
+{
+    Node* root = find(aPrefix);
+    Node* node = Q_NULLPTR;
+
+    // The application remains unselected until its handler accepts
+    // the SELECT
+    iSelected = Q_NULLPTR;
+    if (root) {
+        if (aNext && iOccurrence) {
+            // Next occurrence, if the last one matches the prefix
+            for (Node* p = iOccurrence; p; p = p->iParent) {
+                if (p == root) {
+                    // Once the occurrences are exhausted, the reader
+                    // gets 6A82 (and keeps getting it) rather than
+                    // going around again
+                    node = nextRoute(iOccurrence, root);
+                    if (!node) {
+                        return Q_NULLPTR;
+                    }
+                    break;
+                }
+            }
+        }
+        if (!node) {
+            node = root->iRoute ? root : nextRoute(root, root);
+        }
+    }
+
+    // The occurrence gets remembered even if the handler refuses to be
+    // selected, so that the reader can skip it
+    iOccurrence = node;
+    return node ? node->iRoute : Q_NULLPTR;
+}
+
+void
+NfcAidRouter::Private::forget(
+    const Node* aNode)
+{
+    if (iSelected == aNode) {
+        iSelected = Q_NULLPTR;
+    }
+    if (iOccurrence == aNode) {
+        iOccurrence = Q_NULLPTR;
+    }
+}
+
+/* static */
+bool
+NfcAidRouter::Private::selected(
+    uint aSw)
+{
+    // Normal processing or warnings (ISO/IEC 7816-4, 5.6)
+    switch (aSw >> 8) {
+    case ISO_SW1_OK:
+    case ISO_SW1_MORE_DATA:
+    case ISO_SW1_WARNING_1:
+    case ISO_SW1_WARNING_2:
+        return true;
+    }
+    return false;
+}
+
+void
+NfcAidRouter::Private::collect(
+    const Node* aNode,
+    QList<QByteArray>* aList) const
+{
+    if (aNode->iRoute) {
+        aList->append(aNode->iRoute->iAid);
+    }
+    for (int i = 0; i < aNode->iChildren.count(); i++) {
+        collect(aNode->iChildren.at(i), aList);
+    }
+}
+
+// ==========================================================================
+// NfcAidRouter
+// ==========================================================================
+
+NfcAidRouter::NfcAidRouter() :
+    iPrivate(new Private)
+{
+}
+
+NfcAidRouter::~NfcAidRouter()
+{
+    NfcIoLock lock;
+
+    delete iPrivate;
+}
+
+bool
+NfcAidRouter::addRoute(
+    const QByteArray& aAid,
+    NfcHost::Handler* aHandler)
+{
+    NfcIoLock lock;
+
+    if (aHandler && !aAid.isEmpty() && aAid.size() <= AID_MAX_SIZE) {
+        const uchar* ptr = (const uchar*)aAid.constData();
+        const uchar* end = ptr + aAid.size();
+        Private::Node* node = iPrivate->iRoot;
+
+        while (ptr < end) {
+            node = node->addChild(*ptr++);
+        }
+        if (!node->iRoute) {
+            HDEBUG(aAid.toHex());
+            node->iRoute = new Private::Route(aAid, aHandler);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+NfcAidRouter::removeRoute(
+    const QByteArray& aAid)
+{
+    NfcIoLock lock;
+    Private::Node* node = aAid.isEmpty() ? Q_NULLPTR :
+        iPrivate->find(aAid);
+
+    if (node && node->iRoute) {
+        HDEBUG(aAid.toHex());
+        iPrivate->forget(node);
+        delete node->iRoute;
+        node->iRoute = Q_NULLPTR;
+
+        // Prune the branch which doesn't lead anywhere anymore
+        while (node != iPrivate->iRoot && !node->iRoute &&
+            node->iChildren.isEmpty()) {
+            Private::Node* parent = node->iParent;
+
+            parent->removeChild(node);
+            node = parent;
+        }
+        return true;
+    }
+    return false;
+}
+
+void
+NfcAidRouter::removeAllRoutes()
+{
+    NfcIoLock lock;
+
+    iPrivate->iSelected = Q_NULLPTR;
+    iPrivate->iOccurrence = Q_NULLPTR;
+    qDeleteAll(iPrivate->iRoot->iChildren);
+    iPrivate->iRoot->iChildren.clear();
+}
+
+QList<QByteArray>
+NfcAidRouter::aids() const
+{
+    NfcIoLock lock;
+    QList<QByteArray> list;
+
+    iPrivate->collect(iPrivate->iRoot, &list);
+    return list;
+}
+
+QByteArray
+NfcAidRouter::selectedAid() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iSelected ? iPrivate->iSelected->iRoute->iAid :
+        QByteArray();
+}
+
+NfcAidRouter::Stats
+NfcAidRouter::stats(
+    const QByteArray& aAid) const
+{
+    NfcIoLock lock;
+    const Private::Node* node = aAid.isEmpty() ? Q_NULLPTR :
+        iPrivate->find(aAid);
+
+    return (node && node->iRoute) ? node->iRoute->iStats : Stats();
+}
+
+void
+NfcAidRouter::resetStats()
+{
+    NfcIoLock lock;
+    Private::Node* node = iPrivate->iRoot;
+
+    while ((node = Private::nextRoute(node, iPrivate->iRoot))) {
+        node->iRoute->iStats = Stats();
+    }
+}
+
+uint
+NfcAidRouter::processApdu(
+    NfcHost* aHost,
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    uint aLe,
+    NfcHost::Response* aResponse)
+{
+    // Invoked by NfcHost, with NfcIoLock held if necessary
+    const bool select = (aIns == ISO_INS_SELECT &&
+        aP1 == ISO_P1_SELECT_BY_NAME);
+    Private::Route* route;
+    QElapsedTimer timer;
+    uint sw;
+
+    if (select) {
+        route = iPrivate->select(aData, (aP2 & ISO_P2_OCCURRENCE_MASK) ==
+            ISO_P2_SELECT_NEXT);
+        if (!route) {
+            HDEBUG("No route for" << aData.toHex());
+            return ISO_SW_FILE_NOT_FOUND;
+        }
+
+        // The handler doesn't know about the other routes and gets its
+        // full AID as the first (and only) occurrence, even if the reader
+        // has selected it by a partial name or as the next occurrence
+        timer.start();
+        sw = route->iHandler->processApdu(aHost, aCla, aIns, aP1,
+            aP2 & ~ISO_P2_OCCURRENCE_MASK, route->iAid, aLe, aResponse);
+        if (!Private::selected(sw)) {
+            // Nothing is selected now and the refused SELECT isn't a hit
+            HDEBUG("Selection of" << route->iAid.toHex() << "failed" <<
+                hex << sw);
+            return sw;
+        }
+        HDEBUG("Selected" << route->iAid.toHex());
+        iPrivate->iSelected = iPrivate->iOccurrence;
+    } else if (iPrivate->iSelected) {
+        route = iPrivate->iSelected->iRoute;
+        timer.start();
+        sw = route->iHandler->processApdu(aHost, aCla, aIns, aP1, aP2,
+            aData, aLe, aResponse);
+    } else {
+        return ISO_SW_INS_NOT_SUPPORTED;
+    }
+
+    const qint64 nsec = timer.nsecsElapsed();
+    Stats& stats = route->iStats;
+
+    stats.iHits++;
+    stats.iTotalTime += nsec;
+    stats.iMaxTime = qMax(stats.iMaxTime, nsec);
+    return sw;
+}
+
+void
+NfcAidRouter::hostReset(
+    NfcHost* aHost)
+{
+    Private::Node* node = iPrivate->iRoot;
+    QList<NfcHost::Handler*> handlers;
+
+    // Nothing is selected at the beginning of a session
+    iPrivate->iSelected = Q_NULLPTR;
+    iPrivate->iOccurrence = Q_NULLPTR;
+    while ((node = Private::nextRoute(node, iPrivate->iRoot))) {
+        NfcHost::Handler* handler = node->iRoute->iHandler;
+
+        // The same handler may serve several AIDs
+        if (!handlers.contains(handler)) {
+            handlers.append(handler);
+            handler->hostReset(aHost);
+        }
+    }
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+
+#include "Debug.h"
+
+#include <QtCore/QCoreApplication>
+
+// Per client type
+#define POOL_CAPACITY (4)
+
+// ==========================================================================
+// NfcClientPool::Pool
+// ==========================================================================
+
+template <class T>
+class NfcClientPool::Pool
+{
+public:
+    ~Pool() { clear(); }
+
+    T* take(const char*);
+    void put(T*, bool);
+    void prune(T*);
+    void clear();
+
+private:
+    void remove(int);
+
+    // Specialized for each client type
+    static void unref(T*);
+    static gulong addHandler(T*, Pool*);
+    static void removeHandler(T*, gulong);
+
+private:
+    QList<T*> iClients;
+    QList<gulong> iHandlerIds;
+};
+
+template <class T>
+T*
+NfcClientPool::Pool<T>::take(
+    const char* aPath)
+{
+    const int n = iClients.count();
+
+    for (int i = 0; i < n; i++) {
+        T* client = iClients.at(i);
+
+        if (!g_strcmp0(client->path, aPath)) {
+            HDEBUG("Reusing" << aPath);
+            removeHandler(client, iHandlerIds.takeAt(i));
+            iClients.removeAt(i);
+            return client;
+        }
+    }
+    return Q_NULLPTR;
+}
+
+template <class T>
+void
+NfcClientPool::Pool<T>::put(
+    T* aClient,
+    bool aKeep)
+{
+    if (aClient) {
+        if (!aKeep || (aClient->valid && !aClient->present) ||
+            iClients.contains(aClient)) {
+            // It's gone or we already have a reference
+            unref(aClient);
+        } else {
+            iClients.append(aClient);
+            iHandlerIds.append(addHandler(aClient, this));
+            if (iClients.count() > POOL_CAPACITY) {
+                remove(0);
+            }
+        }
+    }
+}
+
+template <class T>
+void
+NfcClientPool::Pool<T>::prune(
+    T* aClient)
+{
+    if (aClient->valid && !aClient->present) {
+        const int i = iClients.indexOf(aClient);
+
+        if (i >= 0) {
+            HDEBUG(aClient->path << "is gone");
+            remove(i);
+        }
+    }
+}
+
+template <class T>
+void
+NfcClientPool::Pool<T>::clear()
+{
+    while (!iClients.isEmpty()) {
+        remove(iClients.count() - 1);
+    }
+}
+
+template <class T>
+void
+NfcClientPool::Pool<T>::remove(
+    int aIndex)
+{
+    T* client = iClients.takeAt(aIndex);
+
+    removeHandler(client, iHandlerIds.takeAt(aIndex));
+    unref(client);
+}
+
+template <>
+void
+NfcClientPool::Pool<NfcTagClient>::unref(
+    NfcTagClient* aTag)
+{
+    nfc_tag_client_unref(aTag);
+}
+
+template <>
+gulong
+NfcClientPool::Pool<NfcTagClient>::addHandler(
+    NfcTagClient* aTag,
+    Pool* aPool)
+{
+    return nfc_tag_client_add_property_handler(aTag, NFC_TAG_PROPERTY_ANY,
+        tagChanged, aPool);
+}
+
+template <>
+void
+NfcClientPool::Pool<NfcTagClient>::removeHandler(
+    NfcTagClient* aTag,
+    gulong aId)
+{
+    nfc_tag_client_remove_handler(aTag, aId);
+}
+
+template <>
+void
+NfcClientPool::Pool<NfcPeerClient>::unref(
+    NfcPeerClient* aPeer)
+{
+    nfc_peer_client_unref(aPeer);
+}
+
+template <>
+gulong
+NfcClientPool::Pool<NfcPeerClient>::addHandler(
+    NfcPeerClient* aPeer,
+    Pool* aPool)
+{
+    return nfc_peer_client_add_property_handler(aPeer, NFC_PEER_PROPERTY_ANY,
+        peerChanged, aPool);
+}
+
+template <>
+void
+NfcClientPool::Pool<NfcPeerClient>::removeHandler(
+    NfcPeerClient* aPeer,
+    gulong aId)
+{
+    nfc_peer_client_remove_handler(aPeer, aId);
+}
+
+// ==========================================================================
+// NfcClientPool
+// ==========================================================================
+
+NfcClientPool::NfcClientPool() :
+    iTags(new Pool<NfcTagClient>),
+    iPeers(new Pool<NfcPeerClient>),
+    iClosed(false)
+{
+    // Don't leave it to the static destructor
+    qAddPostRoutine(closePool);
+}
+
+NfcClientPool::~NfcClientPool()
+{
+    // Normally empty by now (see close)
+    delete iTags;
+    delete iPeers;
+}
+
+/* static */
+NfcClientPool*
+NfcClientPool::get()
+{
+    static NfcClientPool pool;
+
+    return &pool;
+}
+
+/* static */
+void
+NfcClientPool::closePool()
+{
+    NfcIoLock lock;
+
+    get()->close();
+}
+
+/* static */
+void
+NfcClientPool::tagChanged(
+    NfcTagClient* aTag,
+    NFC_TAG_PROPERTY,
+    void* aPool)
+{
+    ((Pool<NfcTagClient>*)aPool)->prune(aTag);
+}
+
+/* static */
+void
+NfcClientPool::peerChanged(
+    NfcPeerClient* aPeer,
+    NFC_PEER_PROPERTY,
+    void* aPool)
+{
+    ((Pool<NfcPeerClient>*)aPool)->prune(aPeer);
+}
+
+NfcTagClient*
+NfcClientPool::newTag(
+    const char* aPath)
+{
+    NfcTagClient* tag = iTags->take(aPath);
+
+    return tag ? tag : nfc_tag_client_new(aPath);
+}
+
+NfcPeerClient*
+NfcClientPool::newPeer(
+    const char* aPath)
+{
+    NfcPeerClient* peer = iPeers->take(aPath);
+
+    return peer ? peer : nfc_peer_client_new(aPath);
+}
+
+void
+NfcClientPool::releaseTag(
+    NfcTagClient* aTag)
+{
+    iTags->put(aTag, !iClosed);
+}
+
+void
+NfcClientPool::releasePeer(
+    NfcPeerClient* aPeer)
+{
+    iPeers->put(aPeer, !iClosed);
+}
+
+void
+NfcClientPool::warmUpTag(
+    const char* aPath)
+{
+    HDEBUG(aPath);
+    releaseTag(newTag(aPath));
+}
+
+void
+NfcClientPool::close()
+{
+    HDEBUG("Closing the pool");
+    iClosed = true;
+    iTags->clear();
+    iPeers->clear();
+}
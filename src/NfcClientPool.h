@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_CLIENT_POOL_H
+#define QNFCDC_CLIENT_POOL_H
+
+#include <nfcdc_peer.h>
+#include <nfcdc_tag.h>
+
+#include <QtCore/QList>
+
+// Keeps a few recently released tag and peer clients alive, so that
+// switching back to a recently used path picks up an already valid
+// client instead of creating a new D-Bus proxy and waiting for its
+// properties to be fetched. Clients of tags and peers which are known
+// to be gone are released right away, pooled ones as soon as they turn
+// out to be gone. Must be used under NfcIoLock.
+//
+// The pooled clients are attached to the I/O thread's context (if it's
+// running), so the pool is closed by NfcIoThread before it stops, or by
+// a post routine, whichever comes first. After that nothing gets pooled
+// anymore.
+
+class NfcClientPool
+{
+    Q_DISABLE_COPY(NfcClientPool)
+    NfcClientPool();
+    ~NfcClientPool();
+
+public:
+    static NfcClientPool* get();
+
+    // Return a new reference
+    NfcTagClient* newTag(const char*);
+    NfcPeerClient* newPeer(const char*);
+
+    // Take over the reference (NULL is fine)
+    void releaseTag(NfcTagClient*);
+    void releasePeer(NfcPeerClient*);
+
+    // Make sure that the client exists and is in the pool
+    void warmUpTag(const char*);
+
+    // Release everything and stop pooling
+    void close();
+
+private:
+    template <class T> class Pool;
+
+    static void closePool();
+    static void tagChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+    static void peerChanged(NfcPeerClient*, NFC_PEER_PROPERTY, void*);
+
+    Pool<NfcTagClient>* iTags;
+    Pool<NfcPeerClient>* iPeers;
+    bool iClosed;
+};
+
+#endif // QNFCDC_CLIENT_POOL_H
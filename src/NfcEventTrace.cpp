@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcEventTrace.h"
+
+#include "Debug.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMetaMethod>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+
+#include <glib.h>
+
+#define MAX_SAMPLES (256)
+
+Q_LOGGING_CATEGORY(nfcEventTrace, "qnfcdc.trace", QtWarningMsg)
+
+// ==========================================================================
+// NfcEventTrace::Log
+// ==========================================================================
+
+class NfcEventTrace::Log
+{
+public:
+    Log();
+
+    static Log* get();
+
+    void add(const QByteArray&, qint64, qint64);
+    QList<Sample> samples();
+    void reset();
+
+public:
+    QAtomicInt iEnabled;
+    QMutex iMutex;
+    QVector<Sample> iSamples;
+    int iNext;
+    int iCount;
+    qint64 iLast;
+    qint64 iMax;
+    qint64 iTotal;
+};
+
+NfcEventTrace::Log::Log() :
+    iNext(0),
+    iCount(0),
+    iLast(0),
+    iMax(0),
+    iTotal(0)
+{
+    iSamples.reserve(MAX_SAMPLES);
+}
+
+/* static */
+NfcEventTrace::Log*
+NfcEventTrace::Log::get()
+{
+    static Log log;
+
+    return &log;
+}
+
+void
+NfcEventTrace::Log::add(
+    const QByteArray& aSignal,
+    qint64 aCallbackTime,
+    qint64 aEmitTime)
+{
+    const qint64 latency = aEmitTime - aCallbackTime;
+    Sample sample;
+
+    sample.iSignal = aSignal;
+    sample.iCallbackTime = aCallbackTime;
+    sample.iEmitTime = aEmitTime;
+    qCDebug(nfcEventTrace) << aSignal.constData() << latency << "us";
+
+    QMutexLocker lock(&iMutex);
+
+    if (iSamples.count() < MAX_SAMPLES) {
+        iSamples.append(sample);
+    } else {
+        iSamples[iNext] = sample;
+    }
+    iNext = (iNext + 1) % MAX_SAMPLES;
+    iCount++;
+    iLast = latency;
+    iMax = qMax(iMax, latency);
+    iTotal += latency;
+}
+
+QList<NfcEventTrace::Sample>
+NfcEventTrace::Log::samples()
+{
+    QMutexLocker lock(&iMutex);
+    QList<Sample> list;
+    const int n = iSamples.count();
+
+    // Until the buffer is full, iNext is the number of samples
+    const int first = (n < MAX_SAMPLES) ? 0 : iNext;
+
+    list.reserve(n);
+    for (int i = 0; i < n; i++) {
+        list.append(iSamples.at((first + i) % n));
+    }
+    return list;
+}
+
+void
+NfcEventTrace::Log::reset()
+{
+    QMutexLocker lock(&iMutex);
+
+    iSamples.resize(0);
+    iNext = 0;
+    iCount = 0;
+    iLast = 0;
+    iMax = 0;
+    iTotal = 0;
+}
+
+// ==========================================================================
+// NfcEventTrace::Hop
+//
+// Carries a queued signal to the receiver's thread, in place of the
+// QMetaCallEvent which QMetaMethod::invoke would post to the receiver.
+// ==========================================================================
+
+class NfcEventTrace::Hop :
+    public QObject
+{
+public:
+    Hop(QObject*, const QMetaMethod&, qint64);
+
+protected:
+    void customEvent(QEvent*) Q_DECL_OVERRIDE;
+
+private:
+    QPointer<QObject> iTarget;
+    const QMetaMethod iMethod;
+    const qint64 iCallbackTime;
+};
+
+NfcEventTrace::Hop::Hop(
+    QObject* aTarget,
+    const QMetaMethod& aMethod,
+    qint64 aCallbackTime) :
+    iTarget(aTarget),
+    iMethod(aMethod),
+    iCallbackTime(aCallbackTime ? aCallbackTime : g_get_monotonic_time())
+{
+    moveToThread(aTarget->thread());
+}
+
+void
+NfcEventTrace::Hop::customEvent(
+    QEvent*)
+{
+    QObject* target = iTarget.data();
+
+    // The receiver may have been deleted in the meantime
+    if (target) {
+        Log::get()->add(iMethod.name(), iCallbackTime,
+            g_get_monotonic_time());
+        iMethod.invoke(target, Qt::DirectConnection);
+    }
+    deleteLater();
+}
+
+// ==========================================================================
+// NfcEventTrace
+// ==========================================================================
+
+/* static */
+bool
+NfcEventTrace::enabled()
+{
+    return Log::get()->iEnabled.loadAcquire() != 0;
+}
+
+/* static */
+void
+NfcEventTrace::setEnabled(
+    bool aEnabled)
+{
+    HDEBUG(aEnabled);
+    Log::get()->iEnabled.storeRelease(aEnabled);
+}
+
+/* static */
+bool
+NfcEventTrace::active()
+{
+    return enabled() || nfcEventTrace().isDebugEnabled();
+}
+
+/* static */
+qint64
+NfcEventTrace::callbackTime()
+{
+    // Zero (meaning "when the signal is queued") if tracing is off
+    return active() ? g_get_monotonic_time() : 0;
+}
+
+/* static */
+void
+NfcEventTrace::emitQueued(
+    QObject* aObject,
+    const QMetaMethod& aMethod,
+    qint64 aCallbackTime)
+{
+    QCoreApplication::postEvent(new Hop(aObject, aMethod, aCallbackTime),
+        new QEvent(QEvent::User));
+}
+
+/* static */
+void
+NfcEventTrace::emitted(
+    const QMetaMethod& aMethod,
+    qint64 aCallbackTime)
+{
+    Log::get()->add(aMethod.name(), aCallbackTime, g_get_monotonic_time());
+}
+
+/* static */
+QList<NfcEventTrace::Sample>
+NfcEventTrace::samples()
+{
+    return Log::get()->samples();
+}
+
+/* static */
+int
+NfcEventTrace::count()
+{
+    Log* log = Log::get();
+    QMutexLocker lock(&log->iMutex);
+
+    return log->iCount;
+}
+
+/* static */
+qint64
+NfcEventTrace::lastLatency()
+{
+    Log* log = Log::get();
+    QMutexLocker lock(&log->iMutex);
+
+    return log->iLast;
+}
+
+/* static */
+qint64
+NfcEventTrace::maxLatency()
+{
+    Log* log = Log::get();
+    QMutexLocker lock(&log->iMutex);
+
+    return log->iMax;
+}
+
+/* static */
+qint64
+NfcEventTrace::averageLatency()
+{
+    Log* log = Log::get();
+    QMutexLocker lock(&log->iMutex);
+
+    return log->iCount ? (log->iTotal / log->iCount) : 0;
+}
+
+/* static */
+void
+NfcEventTrace::reset()
+{
+    Log::get()->reset();
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcGlibDispatcher.h"
+#include "NfcIoThread.h"
+
+#include "Debug.h"
+
+#include <QtCore/QAbstractEventDispatcher>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSocketNotifier>
+
+static NfcGlibDispatcher* nfcGlibDispatcher = Q_NULLPTR;
+
+// ==========================================================================
+// NfcGlibDispatcher::Watch
+// ==========================================================================
+
+class NfcGlibDispatcher::Watch
+{
+public:
+    Watch(int, gushort, NfcGlibDispatcher*);
+    ~Watch();
+
+    void setEnabled(bool);
+
+public:
+    const gushort iEvents;
+    QSocketNotifier* iRead;
+    QSocketNotifier* iWrite;
+};
+
+NfcGlibDispatcher::Watch::Watch(
+    int aFd,
+    gushort aEvents,
+    NfcGlibDispatcher* aDispatcher) :
+    iEvents(aEvents),
+    iRead(Q_NULLPTR),
+    iWrite(Q_NULLPTR)
+{
+    // Hangups and errors are reported as readability
+    if (aEvents & (G_IO_IN | G_IO_PRI | G_IO_HUP | G_IO_ERR)) {
+        iRead = new QSocketNotifier(aFd, QSocketNotifier::Read);
+        connect(iRead, SIGNAL(activated(int)), aDispatcher, SLOT(iterate()));
+    }
+    if (aEvents & G_IO_OUT) {
+        iWrite = new QSocketNotifier(aFd, QSocketNotifier::Write);
+        connect(iWrite, SIGNAL(activated(int)), aDispatcher, SLOT(iterate()));
+    }
+}
+
+NfcGlibDispatcher::Watch::~Watch()
+{
+    delete iRead;
+    delete iWrite;
+}
+
+void
+NfcGlibDispatcher::Watch::setEnabled(
+    bool aEnabled)
+{
+    if (iRead) {
+        iRead->setEnabled(aEnabled);
+    }
+    if (iWrite) {
+        iWrite->setEnabled(aEnabled);
+    }
+}
+
+// ==========================================================================
+// NfcGlibDispatcher
+// ==========================================================================
+
+NfcGlibDispatcher::NfcGlibDispatcher(
+    GMainContext* aContext) :
+    iContext(g_main_context_ref(aContext)),
+    iFds(Q_NULLPTR),
+    iAllocated(0),
+    iCount(0),
+    iPriority(0),
+    iDepth(0)
+{
+    iTimer.setSingleShot(true);
+    iTimer.setTimerType(Qt::PreciseTimer);
+    connect(&iTimer, SIGNAL(timeout()), SLOT(iterate()));
+    connect(QAbstractEventDispatcher::instance(), SIGNAL(aboutToBlock()),
+        SLOT(iterate()));
+    prepare();
+}
+
+NfcGlibDispatcher::~NfcGlibDispatcher()
+{
+    dropNotifiers();
+    qDeleteAll(iDeadWatches);
+    g_main_context_release(iContext);
+    g_main_context_unref(iContext);
+    g_free(iFds);
+}
+
+/* static */
+bool
+NfcGlibDispatcher::attach()
+{
+    if (nfcGlibDispatcher || NfcIoThread::instance()) {
+        // Either already attached or the default context isn't used
+        return true;
+    } else {
+        QAbstractEventDispatcher* dispatcher =
+            QAbstractEventDispatcher::instance();
+
+        if (!dispatcher) {
+            qWarning() << "No Qt event dispatcher";
+        } else if (dispatcher->inherits("QEventDispatcherGlib")) {
+            HDEBUG("Qt event dispatcher is GLib based");
+            return true;
+        } else {
+            GMainContext* context = g_main_context_default();
+
+            // The context remains acquired until detach()
+            if (g_main_context_acquire(context)) {
+                HDEBUG("Attaching GLib main context");
+                nfcGlibDispatcher = new NfcGlibDispatcher(context);
+                qAddPostRoutine(detach);
+                return true;
+            }
+            qWarning() << "GLib main context is owned by another thread";
+        }
+        return false;
+    }
+}
+
+/* static */
+void
+NfcGlibDispatcher::detach()
+{
+    HDEBUG("Detaching GLib main context");
+    delete nfcGlibDispatcher;
+    nfcGlibDispatcher = Q_NULLPTR;
+}
+
+void
+NfcGlibDispatcher::prepare()
+{
+    gint timeout;
+
+    g_main_context_prepare(iContext, &iPriority);
+    while ((iCount = g_main_context_query(iContext, iPriority, &timeout,
+        iFds, iAllocated)) > iAllocated) {
+        g_free(iFds);
+        iFds = g_new(GPollFD, iCount);
+        iAllocated = iCount;
+    }
+
+    updateNotifiers();
+
+    // Negative timeout means infinite, zero means that something is
+    // ready to be dispatched already
+    if (timeout >= 0) {
+        iTimer.start(timeout);
+    } else {
+        iTimer.stop();
+    }
+}
+
+void
+NfcGlibDispatcher::updateNotifiers()
+{
+    QHash<int,gushort> events;
+
+    for (gint i = 0; i < iCount; i++) {
+        const GPollFD* pfd = iFds + i;
+
+        if (pfd->fd >= 0 && pfd->events) {
+            events.insert(pfd->fd, events.value(pfd->fd) | pfd->events);
+        }
+    }
+
+    // Drop the notifiers which aren't needed anymore
+    QHash<int,Watch*>::iterator it = iWatches.begin();
+
+    while (it != iWatches.end()) {
+        Watch* watch = it.value();
+
+        if (events.value(it.key()) != watch->iEvents) {
+            if (iDepth) {
+                // The notifier may be the one which has invoked iterate()
+                watch->setEnabled(false);
+                iDeadWatches.append(watch);
+            } else {
+                delete watch;
+            }
+            it = iWatches.erase(it);
+        } else {
+            watch->setEnabled(true);
+            ++it;
+        }
+    }
+
+    // And create the missing ones
+    QHash<int,gushort>::const_iterator e = events.constBegin();
+
+    for (; e != events.constEnd(); ++e) {
+        if (!iWatches.contains(e.key())) {
+            iWatches.insert(e.key(), new Watch(e.key(), e.value(), this));
+        }
+    }
+}
+
+void
+NfcGlibDispatcher::disableNotifiers()
+{
+    QHash<int,Watch*>::const_iterator it = iWatches.constBegin();
+
+    for (; it != iWatches.constEnd(); ++it) {
+        it.value()->setEnabled(false);
+    }
+}
+
+void
+NfcGlibDispatcher::dropNotifiers()
+{
+    qDeleteAll(iWatches);
+    iWatches.clear();
+}
+
+void
+NfcGlibDispatcher::iterate()
+{
+    iTimer.stop();
+    disableNotifiers();
+    if (iDepth++) {
+        // A callback has spun a nested event loop. Run a complete
+        // non-blocking iteration, the state left by prepare() belongs
+        // to the outer one which is still dispatching.
+        g_main_context_iteration(iContext, FALSE);
+    } else {
+        // Notifiers only tell which descriptor has woken us up, GLib
+        // needs revents for all of them. This poll doesn't block.
+        if (iCount > 0) {
+            g_poll(iFds, iCount, 0);
+        }
+        if (g_main_context_check(iContext, iPriority, iFds, iCount)) {
+            g_main_context_dispatch(iContext);
+        }
+    }
+    prepare();
+    if (!--iDepth) {
+        qDeleteAll(iDeadWatches);
+        iDeadWatches.clear();
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_GLIB_DISPATCHER_H
+#define QNFCDC_GLIB_DISPATCHER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+#include <glib.h>
+
+class QSocketNotifier;
+
+// Drives the default GMainContext from the Qt event loop of the thread
+// which created it. It's only needed if Qt event dispatcher isn't based
+// on GLib, otherwise GLib sources are dispatched by Qt itself.
+//
+// Each iteration prepares the context, maps the file descriptors it
+// wants to poll to socket notifiers and its timeout to a single-shot
+// precise timer, and returns to the Qt event loop. When a notifier or
+// the timer fires, descriptors are polled without blocking to fill in
+// revents and the ready sources get dispatched. The same happens when
+// the Qt event dispatcher is about to block, because sources added or
+// modified on this thread since the last iteration don't wake it up.
+//
+// If a GLib callback spins a nested Qt event loop, the context keeps
+// being iterated from there (GLib supports recursion, the source whose
+// callback is running stays blocked until it returns).
+
+class NfcGlibDispatcher :
+    public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NfcGlibDispatcher)
+    NfcGlibDispatcher(GMainContext*);
+    ~NfcGlibDispatcher();
+
+public:
+    static bool attach();
+
+private:
+    static void detach();
+    void prepare();
+    void updateNotifiers();
+    void disableNotifiers();
+    void dropNotifiers();
+
+private Q_SLOTS:
+    void iterate();
+
+private:
+    class Watch;
+    GMainContext* iContext;
+    QTimer iTimer;
+    QHash<int,Watch*> iWatches;
+    GPollFD* iFds;
+    gint iAllocated;
+    gint iCount;
+    gint iPriority;
+    int iDepth;
+    QList<Watch*> iDeadWatches;
+};
+
+#endif // QNFCDC_GLIB_DISPATCHER_H
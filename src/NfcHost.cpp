@@ -0,0 +1,718 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include <gio/gio.h>
+
+#include "NfcHost.h"
+#include "NfcIoThread.h"
+#include "NfcSignalTable.h"
+
+#include "Debug.h"
+
+#include <QtCore/QList>
+
+#define NFCD_SERVICE "org.sailfishos.nfc.daemon"
+#define NFCD_DAEMON_PATH "/"
+#define NFCD_DAEMON_INTERFACE "org.sailfishos.nfc.Daemon"
+#define NFCD_LOCAL_HOST_SERVICE_INTERFACE "org.sailfishos.nfc.LocalHostService"
+#define NFCD_LOCAL_HOST_SERVICE_VERSION (1)
+
+#define HOST_OBJECT_PATH "/qnfcdc/host"
+
+// No precise diagnosis
+#define ISO_SW_UNKNOWN (0x6f00)
+
+static const char LOCAL_HOST_SERVICE_XML[] =
+    "<node>"
+    " <interface name='" NFCD_LOCAL_HOST_SERVICE_INTERFACE "'>"
+    "  <method name='GetInterfaceVersion'>"
+    "   <arg name='version' type='i' direction='out'/>"
+    "  </method>"
+    "  <method name='Start'>"
+    "   <arg name='host' type='o' direction='in'/>"
+    "  </method>"
+    "  <method name='Restart'>"
+    "   <arg name='host' type='o' direction='in'/>"
+    "  </method>"
+    "  <method name='Stop'>"
+    "   <arg name='host' type='o' direction='in'/>"
+    "  </method>"
+    "  <method name='Process'>"
+    "   <arg name='host' type='o' direction='in'/>"
+    "   <arg name='cla' type='y' direction='in'/>"
+    "   <arg name='ins' type='y' direction='in'/>"
+    "   <arg name='p1' type='y' direction='in'/>"
+    "   <arg name='p2' type='y' direction='in'/>"
+    "   <arg name='data' type='ay' direction='in'/>"
+    "   <arg name='le' type='u' direction='in'/>"
+    "   <arg name='response' type='ay' direction='out'/>"
+    "   <arg name='sw1' type='y' direction='out'/>"
+    "   <arg name='sw2' type='y' direction='out'/>"
+    "   <arg name='response_id' type='u' direction='out'/>"
+    "  </method>"
+    "  <method name='ResponseStatus'>"
+    "   <arg name='response_id' type='u' direction='in'/>"
+    "   <arg name='ok' type='b' direction='in'/>"
+    "  </method>"
+    " </interface>"
+    "</node>";
+
+// ==========================================================================
+// NfcHost::Private
+// ==========================================================================
+
+class NfcHost::Private
+{
+public:
+    Private(NfcHost*);
+    ~Private();
+
+    void update();
+    void registerService();
+    void registerObject();
+    void unregisterService();
+    bool matches(const char*) const;
+    void start(const char*);
+    void stop(const char*);
+    GVariant* process(GVariant*);
+    static GVariant* responseData(Response*);
+
+    enum HostSignal {
+        SignalRegisteredChanged,
+        SignalActiveChanged,
+        SignalCount
+    };
+
+    typedef NfcSignalTable<NfcHost> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal HOST_SIGNAL[];
+    static const SignalTable& signalTable();
+    void emitSignal(HostSignal);
+
+    static void busReady(GObject*, GAsyncResult*, gpointer);
+    static void registerDone(GObject*, GAsyncResult*, gpointer);
+    static void methodCall(GDBusConnection*, const gchar*, const gchar*,
+        const gchar*, const gchar*, GVariant*, GDBusMethodInvocation*,
+        gpointer);
+
+public:
+    static const GDBusInterfaceVTable gVTable;
+    static int gLastId;
+
+    NfcHost* iParent;
+    Handler* iHandler;
+    QByteArray iPath;
+    QString iName;
+    const QByteArray iObjectPath;
+    GDBusConnection* iBus;
+    GDBusNodeInfo* iNodeInfo;
+    GCancellable* iCancel;
+    guint iObjectId;
+    bool iRegistering;  // RegisterLocalHostService has been sent
+    bool iRegistered;
+    QList<QByteArray> iActiveHosts;
+};
+
+const GDBusInterfaceVTable NfcHost::Private::gVTable = {
+    methodCall, Q_NULLPTR, Q_NULLPTR, { Q_NULLPTR }
+};
+
+int NfcHost::Private::gLastId = 0;
+
+const NfcHost::Private::Signal NfcHost::Private::HOST_SIGNAL[] = {
+    &NfcHost::registeredChanged,   // SignalRegisteredChanged
+    &NfcHost::activeChanged        // SignalActiveChanged
+};
+
+NfcHost::Private::Private(
+    NfcHost* aParent) :
+    iParent(aParent),
+    iHandler(Q_NULLPTR),
+    iObjectPath(HOST_OBJECT_PATH + QByteArray::number(++gLastId)),
+    iBus(Q_NULLPTR),
+    iNodeInfo(Q_NULLPTR),
+    iCancel(Q_NULLPTR),
+    iObjectId(0),
+    iRegistering(false),
+    iRegistered(false)
+{
+    Q_STATIC_ASSERT(G_N_ELEMENTS(HOST_SIGNAL) == SignalCount);
+}
+
+NfcHost::Private::~Private()
+{
+    unregisterService();
+    if (iNodeInfo) {
+        g_dbus_node_info_unref(iNodeInfo);
+    }
+    if (iBus) {
+        g_object_unref(iBus);
+    }
+}
+
+void
+NfcHost::Private::update()
+{
+    // Registration is in progress while iCancel is set
+    if (iHandler && !iName.isEmpty()) {
+        if (!iObjectId && !iCancel) {
+            registerService();
+        }
+    } else if (iObjectId || iCancel) {
+        unregisterService();
+    }
+}
+
+void
+NfcHost::Private::registerService()
+{
+    iCancel = g_cancellable_new();
+    if (iBus) {
+        registerObject();
+    } else {
+        // libgnfcdc has already connected to the bus, so this doesn't
+        // block and completes on the next iteration of the event loop
+        g_bus_get(G_BUS_TYPE_SYSTEM, iCancel, busReady, this);
+    }
+}
+
+void
+NfcHost::Private::registerObject()
+{
+    GError* error = Q_NULLPTR;
+
+    if (!iNodeInfo) {
+        iNodeInfo = g_dbus_node_info_new_for_xml(LOCAL_HOST_SERVICE_XML,
+            &error);
+    }
+    if (iNodeInfo) {
+        // Method calls are dispatched on the current thread default
+        // context, which is the I/O thread's one under NfcIoLock
+        iObjectId = g_dbus_connection_register_object(iBus,
+            iObjectPath.constData(), iNodeInfo->interfaces[0], &gVTable,
+            this, Q_NULLPTR, &error);
+    }
+    if (iObjectId) {
+        const QByteArray name(iName.toUtf8());
+
+        HDEBUG(iObjectPath.constData() << name.constData());
+        iRegistering = true;
+        g_dbus_connection_call(iBus, NFCD_SERVICE, NFCD_DAEMON_PATH,
+            NFCD_DAEMON_INTERFACE, "RegisterLocalHostService",
+            g_variant_new("(os)", iObjectPath.constData(), name.constData()),
+            Q_NULLPTR, G_DBUS_CALL_FLAGS_NONE, -1, iCancel, registerDone,
+            this);
+    } else {
+        if (error) {
+            qWarning() << error->message;
+            g_error_free(error);
+        }
+        g_object_unref(iCancel);
+        iCancel = Q_NULLPTR;
+    }
+}
+
+void
+NfcHost::Private::unregisterService()
+{
+    if (iCancel) {
+        // busReady() and registerDone() won't touch us anymore
+        g_cancellable_cancel(iCancel);
+        g_object_unref(iCancel);
+        iCancel = Q_NULLPTR;
+    }
+    if (iObjectId) {
+        HDEBUG(iObjectPath.constData());
+        g_dbus_connection_unregister_object(iBus, iObjectId);
+        iObjectId = 0;
+    }
+    if (iRegistered || iRegistering) {
+        // Cancelling the pending call doesn't stop nfcd from handling
+        // it, and the calls are handled in order. Nobody is waiting for
+        // the result.
+        iRegistered = false;
+        iRegistering = false;
+        g_dbus_connection_call(iBus, NFCD_SERVICE, NFCD_DAEMON_PATH,
+            NFCD_DAEMON_INTERFACE, "UnregisterLocalHostService",
+            g_variant_new("(o)", iObjectPath.constData()), Q_NULLPTR,
+            G_DBUS_CALL_FLAGS_NONE, -1, Q_NULLPTR, Q_NULLPTR, Q_NULLPTR);
+    }
+    iActiveHosts.clear();
+}
+
+inline
+bool
+NfcHost::Private::matches(
+    const char* aHost) const
+{
+    return iPath.isEmpty() || iPath == QByteArray(aHost);
+}
+
+void
+NfcHost::Private::start(
+    const char* aHost)
+{
+    if (matches(aHost)) {
+        if (iHandler) {
+            iHandler->hostReset(iParent);
+        }
+        if (!iActiveHosts.contains(aHost)) {
+            HDEBUG(aHost);
+            iActiveHosts.append(aHost);
+            if (iActiveHosts.count() == 1) {
+                emitSignal(SignalActiveChanged);
+            }
+        }
+    }
+}
+
+void
+NfcHost::Private::stop(
+    const char* aHost)
+{
+    if (iActiveHosts.removeOne(aHost)) {
+        HDEBUG(aHost);
+        if (iHandler) {
+            iHandler->hostReset(iParent);
+        }
+        if (iActiveHosts.isEmpty()) {
+            emitSignal(SignalActiveChanged);
+        }
+    }
+}
+
+GVariant*
+NfcHost::Private::process(
+    GVariant* aArgs)
+{
+    const char* host = Q_NULLPTR;
+    guchar cla, ins, p1, p2;
+    guint32 le;
+    GVariant* data = Q_NULLPTR;
+    Response response;
+    uint sw = ISO_SW_UNKNOWN;
+
+    g_variant_get(aArgs, "(&oyyyy@ayu)", &host, &cla, &ins, &p1, &p2,
+        &data, &le);
+    if (iHandler && matches(host)) {
+        gsize size = 0;
+        const void* bytes = g_variant_get_fixed_array(data, &size, 1);
+
+        // No copying, the handler gets called right here
+        sw = iHandler->processApdu(iParent, cla, ins, p1, p2,
+            QByteArray::fromRawData((const char*)bytes, (int)size), le,
+            &response);
+    }
+    g_variant_unref(data);
+
+    // Zero response_id means that we don't care about delivery status
+    return g_variant_new("(@ayyyu)", responseData(&response),
+        (guchar)(sw >> 8), (guchar)sw, 0);
+}
+
+/* static */
+GVariant*
+NfcHost::Private::responseData(
+    Response* aResponse)
+{
+    if (aResponse->iRelease) {
+        // The variant takes over the data (and the release function)
+        // and may outlive the method call handler, e.g. if the reply
+        // is still queued by GDBus when the handler gets invoked again
+        GVariant* data = g_variant_new_from_data(G_VARIANT_TYPE_BYTESTRING,
+            aResponse->iData, aResponse->iSize, TRUE, aResponse->iRelease,
+            aResponse->iUserData);
+
+        aResponse->iData = Q_NULLPTR;
+        aResponse->iSize = 0;
+        aResponse->iRelease = Q_NULLPTR;
+        aResponse->iUserData = Q_NULLPTR;
+        return data;
+    } else {
+        return g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+            aResponse->iBytes.constData(), aResponse->iBytes.size(), 1);
+    }
+}
+
+// Qt signals should be signalled from the Qt event loop
+// See https://bugreports.qt.io/browse/QTBUG-18434 for details
+
+/* static */
+const NfcHost::Private::SignalTable&
+NfcHost::Private::signalTable()
+{
+    static const SignalTable table(HOST_SIGNAL, SignalCount);
+
+    return table;
+}
+
+inline
+void
+NfcHost::Private::emitSignal(
+    HostSignal aSignal)
+{
+    signalTable().emitQueued(iParent, aSignal);
+}
+
+/* static */
+void
+NfcHost::Private::busReady(
+    GObject*,
+    GAsyncResult* aResult,
+    gpointer aPrivate)
+{
+    GError* error = Q_NULLPTR;
+    GDBusConnection* bus = g_bus_get_finish(aResult, &error);
+
+    if (bus) {
+        Private* self = (Private*)aPrivate;
+
+        self->iBus = bus;
+        self->registerObject();
+    } else {
+        // If the call has been cancelled, the object may be gone
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            Private* self = (Private*)aPrivate;
+
+            qWarning() << error->message;
+            g_object_unref(self->iCancel);
+            self->iCancel = Q_NULLPTR;
+        }
+        g_error_free(error);
+    }
+}
+
+/* static */
+void
+NfcHost::Private::registerDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aPrivate)
+{
+    GError* error = Q_NULLPTR;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(aBus),
+        aResult, &error);
+
+    if (ret) {
+        Private* self = (Private*)aPrivate;
+
+        HDEBUG("Registered" << self->iObjectPath.constData());
+        g_object_unref(self->iCancel);
+        self->iCancel = Q_NULLPTR;
+        self->iRegistering = false;
+        self->iRegistered = true;
+        self->emitSignal(SignalRegisteredChanged);
+        g_variant_unref(ret);
+    } else {
+        // If the call has been cancelled, the object may be gone
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            Private* self = (Private*)aPrivate;
+
+            qWarning() << error->message;
+            g_object_unref(self->iCancel);
+            self->iCancel = Q_NULLPTR;
+            self->iRegistering = false;
+        }
+        g_error_free(error);
+    }
+}
+
+/* static */
+void
+NfcHost::Private::methodCall(
+    GDBusConnection*,
+    const gchar*,
+    const gchar*,
+    const gchar*,
+    const gchar* aMethod,
+    GVariant* aArgs,
+    GDBusMethodInvocation* aCall,
+    gpointer aPrivate)
+{
+    Private* self = (Private*)aPrivate;
+    GVariant* ret = Q_NULLPTR;
+
+    if (!strcmp(aMethod, "Process")) {
+        ret = self->process(aArgs);
+    } else if (!strcmp(aMethod, "GetInterfaceVersion")) {
+        ret = g_variant_new("(i)", NFCD_LOCAL_HOST_SERVICE_VERSION);
+    } else if (!strcmp(aMethod, "ResponseStatus")) {
+        // We don't ask for those
+    } else {
+        const char* host = Q_NULLPTR;
+
+        g_variant_get(aArgs, "(&o)", &host);
+        if (!strcmp(aMethod, "Stop")) {
+            self->stop(host);
+        } else {
+            // Start or Restart
+            self->start(host);
+        }
+    }
+    g_dbus_method_invocation_return_value(aCall, ret);
+}
+
+// ==========================================================================
+// NfcHost::Response
+// ==========================================================================
+
+NfcHost::Response::Response() :
+    iData(Q_NULLPTR),
+    iSize(0),
+    iRelease(Q_NULLPTR),
+    iUserData(Q_NULLPTR)
+{
+}
+
+NfcHost::Response::~Response()
+{
+    clear();
+}
+
+void
+NfcHost::Response::setData(
+    const QByteArray& aData)
+{
+    clear();
+    iBytes = aData;
+}
+
+void
+NfcHost::Response::setData(
+    const void* aData,
+    uint aSize,
+    ReleaseFunc aRelease,
+    void* aUserData)
+{
+    clear();
+    if (aRelease) {
+        iData = aData;
+        iSize = aSize;
+        iRelease = aRelease;
+        iUserData = aUserData;
+    } else {
+        // Nothing guarantees that the data stay around, copy them
+        iBytes = QByteArray((const char*)aData, aSize);
+    }
+}
+
+void
+NfcHost::Response::clear()
+{
+    if (iRelease) {
+        ReleaseFunc release = iRelease;
+
+        iRelease = Q_NULLPTR;
+        release(iUserData);
+    }
+    iData = Q_NULLPTR;
+    iSize = 0;
+    iUserData = Q_NULLPTR;
+    iBytes.clear();
+}
+
+QByteArray
+NfcHost::Response::data() const
+{
+    return iRelease ? QByteArray((const char*)iData, iSize) : iBytes;
+}
+
+// ==========================================================================
+// NfcHost
+// ==========================================================================
+
+NfcHost::NfcHost(
+    QObject* aParent) :
+    QObject(aParent),
+    iPrivate(new Private(this))
+{
+}
+
+NfcHost::~NfcHost()
+{
+    NfcIoLock lock;
+
+    delete iPrivate;
+}
+
+QString
+NfcHost::path() const
+{
+    NfcIoLock lock;
+
+    return QString::fromLatin1(iPrivate->iPath);
+}
+
+// The setters update the state under the lock and emit the signals after
+// releasing it, so that the slots don't block the I/O thread
+
+void
+NfcHost::setPath(
+    QString aPath)
+{
+    const QByteArray path(aPath.toLatin1());
+    bool changed = false;
+    bool activeChange = false;
+
+    {
+        NfcIoLock lock;
+
+        if (iPrivate->iPath != path) {
+            const bool wasActive = active();
+
+            HDEBUG(aPath);
+            iPrivate->iPath = path;
+            // Hosts started for the old path are not ours anymore
+            if (!path.isEmpty()) {
+                const bool isActive = iPrivate->iActiveHosts.contains(path);
+
+                iPrivate->iActiveHosts.clear();
+                if (isActive) {
+                    iPrivate->iActiveHosts.append(path);
+                }
+            }
+            changed = true;
+            activeChange = (wasActive != active());
+        }
+    }
+
+    if (changed) {
+        Q_EMIT pathChanged();
+    }
+    if (activeChange) {
+        Q_EMIT activeChanged();
+    }
+}
+
+QString
+NfcHost::name() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iName;
+}
+
+void
+NfcHost::setName(
+    QString aName)
+{
+    bool changed = false;
+    bool registeredChange = false;
+    bool activeChange = false;
+
+    {
+        NfcIoLock lock;
+
+        if (iPrivate->iName != aName) {
+            const bool wasRegistered = registered();
+            const bool wasActive = active();
+
+            HDEBUG(aName);
+            // Re-register under the new name
+            iPrivate->unregisterService();
+            iPrivate->iName = aName;
+            iPrivate->update();
+            changed = true;
+            registeredChange = (wasRegistered != registered());
+            activeChange = (wasActive != active());
+        }
+    }
+
+    if (changed) {
+        Q_EMIT nameChanged();
+    }
+    if (registeredChange) {
+        Q_EMIT registeredChanged();
+    }
+    if (activeChange) {
+        Q_EMIT activeChanged();
+    }
+}
+
+NfcHost::Handler*
+NfcHost::handler() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iHandler;
+}
+
+void
+NfcHost::setHandler(
+    Handler* aHandler)
+{
+    bool registeredChange = false;
+    bool activeChange = false;
+
+    {
+        NfcIoLock lock;
+
+        if (iPrivate->iHandler != aHandler) {
+            const bool wasRegistered = registered();
+            const bool wasActive = active();
+
+            iPrivate->iHandler = aHandler;
+            iPrivate->update();
+            registeredChange = (wasRegistered != registered());
+            activeChange = (wasActive != active());
+        }
+    }
+
+    if (registeredChange) {
+        Q_EMIT registeredChanged();
+    }
+    if (activeChange) {
+        Q_EMIT activeChanged();
+    }
+}
+
+bool
+NfcHost::registered() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iRegistered;
+}
+
+bool
+NfcHost::active() const
+{
+    NfcIoLock lock;
+
+    return !iPrivate->iActiveHosts.isEmpty();
+}
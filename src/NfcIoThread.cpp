@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcIoThread.h"
+#include "NfcClientPool.h"
+
+#include "Debug.h"
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QCoreApplication>
+
+static QAtomicPointer<NfcIoThread> nfcIoThread;
+
+// ==========================================================================
+// NfcIoThread
+// ==========================================================================
+
+NfcIoThread::NfcIoThread() :
+    iContext(g_main_context_new()),
+#if QT_VERSION < 0x050e00
+    // QMutex::Recursive is deprecated since Qt 5.14
+    iMutex(QMutex::Recursive),
+#endif
+    iDepth(0)
+{
+}
+
+NfcIoThread::~NfcIoThread()
+{
+    g_main_context_unref(iContext);
+}
+
+/* static */
+NfcIoThread*
+NfcIoThread::instance()
+{
+    return nfcIoThread.loadAcquire();
+}
+
+/* static */
+void
+NfcIoThread::startThread()
+{
+    if (!nfcIoThread.loadAcquire()) {
+        NfcIoThread* thread = new NfcIoThread;
+
+        if (nfcIoThread.testAndSetOrdered(Q_NULLPTR, thread)) {
+            HDEBUG("Starting NFC I/O thread");
+            thread->start();
+            qAddPostRoutine(stopThread);
+        } else {
+            delete thread;
+        }
+    }
+}
+
+/* static */
+void
+NfcIoThread::stopThread()
+{
+    if (nfcIoThread.loadAcquire()) {
+        NfcIoLock lock;
+
+        // The pooled clients are attached to our context, they have to
+        // be released under the lock and before the context goes away
+        NfcClientPool::get()->close();
+    }
+
+    NfcIoThread* thread = nfcIoThread.fetchAndStoreOrdered(Q_NULLPTR);
+
+    if (thread) {
+        HDEBUG("Stopping NFC I/O thread");
+        thread->iQuit.storeRelease(1);
+        g_main_context_wakeup(thread->iContext);
+        thread->wait();
+        delete thread;
+    }
+}
+
+void
+NfcIoThread::lock()
+{
+    iMutex.lock();
+    if (!iDepth++ && QThread::currentThread() != this) {
+        // Objects created by the caller will be attached to our context.
+        // This acquires the context, which is only possible because the
+        // I/O thread releases it before releasing the mutex.
+        g_main_context_push_thread_default(iContext);
+    }
+}
+
+void
+NfcIoThread::unlock()
+{
+    if (!--iDepth && QThread::currentThread() != this) {
+        g_main_context_pop_thread_default(iContext);
+        iMutex.unlock();
+        // The caller may have added new sources
+        g_main_context_wakeup(iContext);
+    } else {
+        iMutex.unlock();
+    }
+}
+
+void
+NfcIoThread::run()
+{
+    GPollFD* fds = Q_NULLPTR;
+    gint allocated = 0;
+
+    lock();
+    g_main_context_push_thread_default(iContext);
+    while (!iQuit.loadAcquire()) {
+        gint priority, timeout, n;
+
+        g_main_context_prepare(iContext, &priority);
+        while ((n = g_main_context_query(iContext, priority, &timeout,
+            fds, allocated)) > allocated) {
+            g_free(fds);
+            fds = g_new(GPollFD, n);
+            allocated = n;
+        }
+
+        // Let other threads in while we are waiting
+        g_main_context_release(iContext);
+        unlock();
+        g_poll(fds, n, timeout);
+        lock();
+        g_main_context_acquire(iContext);
+
+        if (g_main_context_check(iContext, priority, fds, n)) {
+            g_main_context_dispatch(iContext);
+        }
+    }
+    g_main_context_pop_thread_default(iContext);
+    unlock();
+    g_free(fds);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_IO_THREAD_H
+#define QNFCDC_IO_THREAD_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+#include <glib.h>
+
+// Optional thread running a private GMainContext. Once it's started,
+// all libgnfcdc objects get created with that context as the thread
+// default and their callbacks are invoked on this thread.
+//
+// libgnfcdc is not thread safe, so everything which touches it (and
+// the state updated by its callbacks) must hold NfcIoLock. The I/O
+// thread holds the same lock while dispatching events and releases
+// it while waiting for them.
+
+class NfcIoThread :
+    public QThread
+{
+    Q_DISABLE_COPY(NfcIoThread)
+    NfcIoThread();
+    ~NfcIoThread();
+
+public:
+    static NfcIoThread* instance();
+    static void startThread();
+
+    void lock();
+    void unlock();
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    static void stopThread();
+
+private:
+    GMainContext* iContext;
+#if QT_VERSION >= 0x050e00
+    QRecursiveMutex iMutex;
+#else
+    QMutex iMutex;          // Recursive
+#endif
+    int iDepth;
+    QAtomicInt iQuit;
+};
+
+// No-op unless the I/O thread is running. May be nested.
+
+class NfcIoLock
+{
+    Q_DISABLE_COPY(NfcIoLock)
+
+public:
+    NfcIoLock() : iThread(NfcIoThread::instance())
+        { if (iThread) iThread->lock(); }
+    ~NfcIoLock()
+        { if (iThread) iThread->unlock(); }
+
+private:
+    NfcIoThread* iThread;
+};
+
+#endif // QNFCDC_IO_THREAD_H
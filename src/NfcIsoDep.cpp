@@ -0,0 +1,1196 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcIsoDep.h"
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+#include "NfcNdefListener.h"
+#include "NfcNdefMessage.h"
+#include "NfcTransceiver.h"
+
+#include "Debug.h"
+
+#include <QtCore/QMetaMethod>
+#include <QtCore/QPair>
+#include <QtCore/QQueue>
+
+enum isodep_tag_events {
+    ISODEP_TAG_EVENT_VALID,
+    ISODEP_TAG_EVENT_PRESENT,
+    ISODEP_TAG_EVENT_COUNT
+};
+
+// ISO/IEC 7816-4
+#define ISO_CLA (0x00)
+#define ISO_INS_SELECT (0xa4)
+#define ISO_INS_READ_BINARY (0xb0)
+#define ISO_INS_UPDATE_BINARY (0xd6)
+#define ISO_INS_GET_RESPONSE (0xc0)
+#define ISO_P1_SELECT_BY_ID (0x00)
+#define ISO_P1_SELECT_BY_NAME (0x04)
+#define ISO_P2_SELECT_FIRST (0x00)
+#define ISO_P2_SELECT_NO_RESPONSE (0x0c)
+#define ISO_SW_OK (0x9000)
+#define ISO_SW1_MORE_DATA (0x61)
+#define ISO_SW1_WRONG_LE (0x6c)
+#define ISO_SHORT_LE_MAX (0x100)
+
+// NFC Forum Type 4 Tag
+static const uchar T4_NDEF_AID[] = {
+    0xd2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01
+};
+static const uchar T4_CC_FILE[] = { 0xe1, 0x03 };
+#define T4_CC_SIZE (15)
+#define T4_CC_MLE (3)
+#define T4_CC_MLC (5)
+#define T4_CC_NDEF_TLV (7)
+#define T4_CC_NDEF_FILE_ID (9)
+#define T4_CC_NDEF_MAX_SIZE (11)
+#define T4_CC_NDEF_WRITE_ACCESS (14)
+#define T4_ACCESS_GRANTED (0x00)
+#define T4_NDEF_FILE_CONTROL_TLV (0x04)
+#define T4_NLEN_SIZE (2)
+// READ/UPDATE BINARY with even INS take a 15-bit offset
+#define T4_MAX_FILE_SIZE (0x7fff)
+
+// Protection against broken cards
+#define MAX_CONTINUATIONS (256)
+
+static inline uint be16(const QByteArray& aData, int aOffset)
+{
+    return (((uint)(uchar)aData.at(aOffset)) << 8) |
+        (uchar)aData.at(aOffset + 1);
+}
+
+// ==========================================================================
+// NfcIsoDep::Private
+// ==========================================================================
+
+class NfcIsoDep::Private :
+    public NfcTransceiver::Listener
+{
+public:
+    class Apdu;
+    class Operation;
+    class NdefReader;
+    class NdefWriter;
+
+    Private(NfcIsoDep*);
+    ~Private();
+
+    int nextId();
+    void setPath(const char*);
+    int transmit(uchar, uchar, uchar, uchar, const QByteArray&, int);
+    int readNdef(bool);
+    int writeNdef(const QByteArray&);
+    bool enqueue(Operation*, int, uchar, uchar, uchar, uchar,
+        const QByteArray&, int);
+    bool cancel(int);
+    void failAll();
+    void submit();
+    void send(const QByteArray&);
+    void finish(uint);
+    void completed(Apdu*, bool, uint);
+    void dropOperation(Operation*);
+    void ndefRead(int, const QByteArray&);
+    void ndefVerified(int, const QByteArray&);
+    void ndefWritten(int, const QByteArray&);
+
+    void emitValidChanged();
+    void emitPresentChanged();
+
+    static void validChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+    static void presentChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+
+    // NfcTransceiver::Listener
+    void transceiveDone(int, const GUtilData*, qint64) Q_DECL_OVERRIDE;
+    void transceiveFailed(int) Q_DECL_OVERRIDE;
+
+public:
+    NfcIsoDep* iParent;
+    NfcTagClient* iTag;
+    gulong iTagEventId[ISODEP_TAG_EVENT_COUNT];
+    NfcTransceiver iTransceiver;
+    NfcNdefListener* iListener;
+    QQueue<Apdu*> iQueue;
+    QList<Operation*> iOperations;
+    Apdu* iCurrent;
+    NfcNdefMessage iNdef;
+    int iFrameId;
+    int iLastId;
+};
+
+// ==========================================================================
+// NfcIsoDep::Private::Apdu
+// ==========================================================================
+
+class NfcIsoDep::Private::Apdu
+{
+public:
+    Apdu(Operation* aOperation, int aId, uchar aCla, uchar aIns, uchar aP1,
+        uchar aP2, const QByteArray& aData, int aLe) :
+        iOperation(aOperation), iId(aId), iCla(aCla), iIns(aIns),
+        iP1(aP1), iP2(aP2), iData(aData), iLe(aLe), iContinuations(0) {}
+
+    QByteArray command() const;
+    QByteArray getResponse(uchar) const;
+
+public:
+    Operation* iOperation;
+    const int iId;
+    const uchar iCla;
+    const uchar iIns;
+    const uchar iP1;
+    const uchar iP2;
+    const QByteArray iData;
+    int iLe;
+    int iContinuations;
+    QByteArray iResponse;
+};
+
+inline
+QByteArray
+NfcIsoDep::Private::Apdu::command() const
+{
+    return buildApdu(iCla, iIns, iP1, iP2, iData, iLe);
+}
+
+QByteArray
+NfcIsoDep::Private::Apdu::getResponse(
+    uchar aSw2) const
+{
+    // Keep the logical channel, drop secure messaging and chaining bits
+    const uchar cla = (iCla & 0x40) ? (iCla & 0x4f) : (iCla & 0x03);
+
+    return buildApdu(cla, ISO_INS_GET_RESPONSE, 0, 0, QByteArray(),
+        aSw2 ? aSw2 : ISO_SHORT_LE_MAX);
+}
+
+// ==========================================================================
+// NfcIsoDep::Private::Operation
+//
+// A sequence of APDUs driven from the completion callbacks. The
+// operation is deleted after apduDone() returns false or after
+// failed() has been called.
+// ==========================================================================
+
+class NfcIsoDep::Private::Operation
+{
+public:
+    Operation(Private* aOwner, int aId) : iOwner(aOwner), iId(aId) {}
+    virtual ~Operation() {}
+
+    virtual bool start() = 0;
+    virtual bool apduDone(const QByteArray&, uint) = 0;
+    virtual void failed() = 0;
+
+    bool transmit(uchar aIns, uchar aP1, uchar aP2,
+        const QByteArray& aData = QByteArray(), int aLe = 0)
+        { return iOwner->enqueue(this, iId, ISO_CLA, aIns, aP1, aP2,
+            aData, aLe); }
+
+public:
+    Private* iOwner;
+    const int iId;
+};
+
+// ==========================================================================
+// NfcIsoDep::Private::NdefReader
+//
+// NFC Forum Type 4 Tag NDEF read procedure. Once the NDEF length is
+// known, all READ BINARY commands are queued at once.
+// ==========================================================================
+
+class NfcIsoDep::Private::NdefReader :
+    public Operation
+{
+public:
+    enum State {
+        SelectApp,
+        SelectCc,
+        ReadCc,
+        SelectNdef,
+        ReadLength,
+        ReadData
+    };
+
+    NdefReader(Private* aOwner, int aId, bool aVerify) :
+        Operation(aOwner, aId), iVerify(aVerify), iState(SelectApp),
+        iMaxLe(0), iLength(0), iPending(0) {}
+
+    bool start() Q_DECL_OVERRIDE;
+    bool apduDone(const QByteArray&, uint) Q_DECL_OVERRIDE;
+    void failed() Q_DECL_OVERRIDE;
+
+private:
+    bool next(const QByteArray&);
+    void finished();
+
+public:
+    const bool iVerify;
+    State iState;
+    int iMaxLe;
+    int iLength;
+    int iPending;
+    QByteArray iNdef;
+};
+
+bool
+NfcIsoDep::Private::NdefReader::start()
+{
+    return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_NAME, ISO_P2_SELECT_FIRST,
+        QByteArray((const char*)T4_NDEF_AID, sizeof(T4_NDEF_AID)),
+        ISO_SHORT_LE_MAX);
+}
+
+bool
+NfcIsoDep::Private::NdefReader::next(
+    const QByteArray& aResp)
+{
+    switch (iState) {
+    case SelectApp:
+        iState = SelectCc;
+        return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+            ISO_P2_SELECT_NO_RESPONSE, QByteArray((const char*)T4_CC_FILE,
+            sizeof(T4_CC_FILE)));
+    case SelectCc:
+        iState = ReadCc;
+        return transmit(ISO_INS_READ_BINARY, 0, 0, QByteArray(), T4_CC_SIZE);
+    case ReadCc:
+        if (aResp.size() >= T4_CC_SIZE &&
+            (uchar)aResp.at(T4_CC_NDEF_TLV) == T4_NDEF_FILE_CONTROL_TLV) {
+            iMaxLe = qMin(be16(aResp, T4_CC_MLE), (uint)ISO_SHORT_LE_MAX);
+            if (iMaxLe > 0) {
+                iState = SelectNdef;
+                return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+                    ISO_P2_SELECT_NO_RESPONSE, aResp.mid(T4_CC_NDEF_FILE_ID,
+                    2));
+            }
+        }
+        HDEBUG("Unexpected CC" << aResp.toHex());
+        return false;
+    case SelectNdef:
+        iState = ReadLength;
+        return transmit(ISO_INS_READ_BINARY, 0, 0, QByteArray(),
+            T4_NLEN_SIZE);
+    case ReadLength:
+        if (aResp.size() == T4_NLEN_SIZE) {
+            const int end = T4_NLEN_SIZE + (iLength = be16(aResp, 0));
+
+            if (end > T4_MAX_FILE_SIZE) {
+                HDEBUG("NLEN too large" << iLength);
+                return false;
+            }
+            iState = ReadData;
+            iNdef.reserve(iLength);
+            for (int off = T4_NLEN_SIZE; off < end; off += iMaxLe) {
+                if (transmit(ISO_INS_READ_BINARY, (uchar)(off >> 8),
+                    (uchar)off, QByteArray(), qMin(iMaxLe, end - off))) {
+                    iPending++;
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return false;
+    case ReadData:
+        break;
+    }
+    return false;
+}
+
+bool
+NfcIsoDep::Private::NdefReader::apduDone(
+    const QByteArray& aResp,
+    uint aSw)
+{
+    if (aSw == ISO_SW_OK) {
+        if (iState == ReadData) {
+            iNdef.append(aResp);
+            if (--iPending > 0) {
+                return true;
+            } else if (iNdef.size() == iLength) {
+                finished();
+                return false;
+            }
+        } else if (next(aResp)) {
+            // Note that the length may be zero
+            if (iState != ReadData || iPending) {
+                return true;
+            }
+            finished();
+            return false;
+        }
+    }
+    HDEBUG("NDEF read failed in state" << iState << hex << aSw);
+    failed();
+    return false;
+}
+
+void
+NfcIsoDep::Private::NdefReader::finished()
+{
+    if (iVerify) {
+        iOwner->ndefVerified(iId, iNdef);
+    } else {
+        iOwner->ndefRead(iId, iNdef);
+    }
+}
+
+void
+NfcIsoDep::Private::NdefReader::failed()
+{
+    static const QMetaMethod readNdefFailed(QMetaMethod::fromSignal(
+        &NfcIsoDep::readNdefFailed));
+
+    // Verification is internal, there's no signal for it
+    if (!iVerify) {
+        readNdefFailed.invoke(iOwner->iParent, Qt::QueuedConnection,
+            Q_ARG(int, iId));
+    }
+    if (iOwner->iListener) {
+        iOwner->iListener->ndefFailed(iId);
+    }
+}
+
+// ==========================================================================
+// NfcIsoDep::Private::NdefWriter
+//
+// NFC Forum Type 4 Tag NDEF update procedure. NLEN is zeroed before
+// the message gets updated and written last, so that an interrupted
+// write leaves an empty message rather than a broken one. Chunks which
+// match the last message read (or written) are skipped, the rest are
+// written with the largest UPDATE BINARY the tag accepts, all queued
+// at once.
+// ==========================================================================
+
+class NfcIsoDep::Private::NdefWriter :
+    public Operation
+{
+public:
+    enum State {
+        SelectApp,
+        SelectCc,
+        ReadCc,
+        SelectNdef,
+        ClearLength,
+        WriteData,
+        WriteLength
+    };
+
+    NdefWriter(Private* aOwner, int aId, const QByteArray& aNdef,
+        const QByteArray* aPrevious) :
+        Operation(aOwner, aId), iState(SelectApp), iNdef(aNdef),
+        iPrevious(aPrevious ? *aPrevious : QByteArray()),
+        iPreviousKnown(aPrevious != Q_NULLPTR), iPending(0) {}
+
+    bool start() Q_DECL_OVERRIDE;
+    bool apduDone(const QByteArray&, uint) Q_DECL_OVERRIDE;
+    void failed() Q_DECL_OVERRIDE;
+
+private:
+    bool next(const QByteArray&);
+    void planChunks(int);
+    bool update(int, const QByteArray&);
+    bool writeLength(uint);
+
+public:
+    State iState;
+    const QByteArray iNdef;
+    const QByteArray iPrevious;
+    const bool iPreviousKnown;
+    QList<QPair<int,int> > iChunks; // Offset and size
+    int iPending;
+};
+
+bool
+NfcIsoDep::Private::NdefWriter::start()
+{
+    return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_NAME, ISO_P2_SELECT_FIRST,
+        QByteArray((const char*)T4_NDEF_AID, sizeof(T4_NDEF_AID)),
+        ISO_SHORT_LE_MAX);
+}
+
+void
+NfcIsoDep::Private::NdefWriter::planChunks(
+    int aMaxLc)
+{
+    const int len = iNdef.size();
+
+    for (int off = 0; off < len; off += aMaxLc) {
+        const int size = qMin(aMaxLc, len - off);
+
+        if (!iPreviousKnown || off + size > iPrevious.size() ||
+            memcmp(iPrevious.constData() + off, iNdef.constData() + off,
+            size)) {
+            iChunks.append(qMakePair(off, size));
+        }
+    }
+    HDEBUG(iChunks.count() << "chunk(s) to write");
+}
+
+inline
+bool
+NfcIsoDep::Private::NdefWriter::update(
+    int aOffset,
+    const QByteArray& aData)
+{
+    return transmit(ISO_INS_UPDATE_BINARY, (uchar)((aOffset >> 8) & 0x7f),
+        (uchar)aOffset, aData);
+}
+
+bool
+NfcIsoDep::Private::NdefWriter::writeLength(
+    uint aLength)
+{
+    QByteArray nlen;
+
+    nlen.reserve(T4_NLEN_SIZE);
+    nlen.append((char)(aLength >> 8));
+    nlen.append((char)aLength);
+    return update(0, nlen);
+}
+
+bool
+NfcIsoDep::Private::NdefWriter::next(
+    const QByteArray& aResp)
+{
+    switch (iState) {
+    case SelectApp:
+        iState = SelectCc;
+        return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+            ISO_P2_SELECT_NO_RESPONSE, QByteArray((const char*)T4_CC_FILE,
+            sizeof(T4_CC_FILE)));
+    case SelectCc:
+        iState = ReadCc;
+        return transmit(ISO_INS_READ_BINARY, 0, 0, QByteArray(), T4_CC_SIZE);
+    case ReadCc:
+        if (aResp.size() >= T4_CC_SIZE &&
+            (uchar)aResp.at(T4_CC_NDEF_TLV) == T4_NDEF_FILE_CONTROL_TLV &&
+            (uchar)aResp.at(T4_CC_NDEF_WRITE_ACCESS) == T4_ACCESS_GRANTED) {
+            // Short APDUs only
+            const int maxLc = qMin(be16(aResp, T4_CC_MLC), 0xffu);
+            const int maxSize = be16(aResp, T4_CC_NDEF_MAX_SIZE);
+
+            if (maxLc > 0 && (T4_NLEN_SIZE + iNdef.size()) <=
+                qMin(maxSize, T4_MAX_FILE_SIZE)) {
+                planChunks(maxLc);
+                iState = SelectNdef;
+                return transmit(ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+                    ISO_P2_SELECT_NO_RESPONSE, aResp.mid(T4_CC_NDEF_FILE_ID,
+                    2));
+            }
+            HDEBUG("Message doesn't fit" << iNdef.size() << maxSize);
+            return false;
+        }
+        HDEBUG("Unexpected CC" << aResp.toHex());
+        return false;
+    case SelectNdef:
+        if (!iChunks.isEmpty()) {
+            iState = ClearLength;
+            return writeLength(0);
+        }
+        // Only the length needs to be updated
+        iState = WriteLength;
+        return writeLength(iNdef.size());
+    case ClearLength:
+        iState = WriteData;
+        for (int i = 0; i < iChunks.count(); i++) {
+            const QPair<int,int>& chunk = iChunks.at(i);
+
+            if (update(T4_NLEN_SIZE + chunk.first,
+                iNdef.mid(chunk.first, chunk.second))) {
+                iPending++;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    case WriteData:
+        iState = WriteLength;
+        return writeLength(iNdef.size());
+    case WriteLength:
+        break;
+    }
+    return false;
+}
+
+bool
+NfcIsoDep::Private::NdefWriter::apduDone(
+    const QByteArray& aResp,
+    uint aSw)
+{
+    if (aSw == ISO_SW_OK) {
+        if (iState == WriteLength) {
+            iOwner->ndefWritten(iId, iNdef);
+            return false;
+        } else if (iState == WriteData && --iPending > 0) {
+            return true;
+        } else if (next(aResp)) {
+            return true;
+        }
+    }
+    HDEBUG("NDEF write failed in state" << iState << hex << aSw);
+    failed();
+    return false;
+}
+
+void
+NfcIsoDep::Private::NdefWriter::failed()
+{
+    static const QMetaMethod writeNdefFailed(QMetaMethod::fromSignal(
+        &NfcIsoDep::writeNdefFailed));
+
+    writeNdefFailed.invoke(iOwner->iParent, Qt::QueuedConnection,
+        Q_ARG(int, iId));
+    if (iOwner->iListener) {
+        iOwner->iListener->ndefFailed(iId);
+    }
+}
+
+// ==========================================================================
+// NfcIsoDep::Private
+// ==========================================================================
+
+NfcIsoDep::Private::Private(
+    NfcIsoDep* aParent) :
+    iParent(aParent),
+    iTag(Q_NULLPTR),
+    iTransceiver(this),
+    iListener(Q_NULLPTR),
+    iCurrent(Q_NULLPTR),
+    iFrameId(0),
+    iLastId(0)
+{
+    memset(iTagEventId, 0, sizeof(iTagEventId));
+}
+
+NfcIsoDep::Private::~Private()
+{
+    delete iCurrent;
+    qDeleteAll(iQueue);
+    qDeleteAll(iOperations);
+    iTransceiver.cancelAll();
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+}
+
+inline
+int
+NfcIsoDep::Private::nextId()
+{
+    // Zero is never a valid id
+    return (iLastId = (iLastId < G_MAXINT) ? (iLastId + 1) : 1);
+}
+
+void
+NfcIsoDep::Private::setPath(
+    const char* aPath)
+{
+    failAll();
+    iNdef = NfcNdefMessage();
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+    if (aPath) {
+        iTag = NfcClientPool::get()->newTag(aPath);
+        iTagEventId[ISODEP_TAG_EVENT_VALID] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_VALID, validChanged, this);
+        iTagEventId[ISODEP_TAG_EVENT_PRESENT] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_PRESENT, presentChanged, this);
+    } else {
+        iTag = Q_NULLPTR;
+    }
+    iTransceiver.setTag(iTag);
+}
+
+int
+NfcIsoDep::Private::transmit(
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    int aLe)
+{
+    const int id = nextId();
+
+    if (enqueue(Q_NULLPTR, id, aCla, aIns, aP1, aP2, aData, aLe)) {
+        submit();
+        return id;
+    }
+    return 0;
+}
+
+int
+NfcIsoDep::Private::readNdef(
+    bool aVerify)
+{
+    if (iTag) {
+        const int id = nextId();
+        Operation* op = new NdefReader(this, id, aVerify);
+
+        iOperations.append(op);
+        if (op->start()) {
+            // The operation is gone if the first APDU fails right away
+            submit();
+            return id;
+        }
+        dropOperation(op);
+    }
+    return 0;
+}
+
+int
+NfcIsoDep::Private::writeNdef(
+    const QByteArray& aNdef)
+{
+    // Offsets beyond 0x7fff can't be addressed with short APDUs
+    if (iTag && (T4_NLEN_SIZE + aNdef.size()) <= T4_MAX_FILE_SIZE) {
+        // Chunks which haven't changed since the last read are skipped
+        const QByteArray previous(iNdef.isValid() ? iNdef.data() :
+            QByteArray());
+        const int id = nextId();
+        Operation* op = new NdefWriter(this, id, aNdef,
+            iNdef.isValid() ? &previous : Q_NULLPTR);
+
+        iOperations.append(op);
+        if (op->start()) {
+            // The operation is gone if the first APDU fails right away
+            submit();
+            return id;
+        }
+        dropOperation(op);
+    }
+    return 0;
+}
+
+bool
+NfcIsoDep::Private::enqueue(
+    Operation* aOperation,
+    int aId,
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    int aLe)
+{
+    if (iTag && aLe >= 0 && aLe <= 0x10000 && aData.size() <= 0xffff) {
+        iQueue.enqueue(new Apdu(aOperation, aId, aCla, aIns, aP1, aP2,
+            aData, aLe));
+        return true;
+    }
+    return false;
+}
+
+bool
+NfcIsoDep::Private::cancel(
+    int aId)
+{
+    const int ops = iOperations.count();
+
+    for (int i = 0; i < ops; i++) {
+        Operation* op = iOperations.at(i);
+
+        if (op->iId == aId) {
+            dropOperation(op);
+            return true;
+        }
+    }
+
+    if (iCurrent && iCurrent->iId == aId) {
+        iTransceiver.cancel(iFrameId);
+        delete iCurrent;
+        iCurrent = Q_NULLPTR;
+        submit();
+        return true;
+    } else {
+        const int n = iQueue.count();
+
+        for (int i = 0; i < n; i++) {
+            Apdu* apdu = iQueue.at(i);
+
+            if (apdu->iId == aId) {
+                iQueue.removeAt(i);
+                delete apdu;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void
+NfcIsoDep::Private::failAll()
+{
+    static const QMetaMethod transmitFailed(QMetaMethod::fromSignal(
+        &NfcIsoDep::transmitFailed));
+
+    if (iCurrent) {
+        iQueue.prepend(iCurrent);
+        iCurrent = Q_NULLPTR;
+        iTransceiver.cancel(iFrameId);
+    }
+    while (!iQueue.isEmpty()) {
+        Apdu* apdu = iQueue.dequeue();
+
+        if (!apdu->iOperation) {
+            transmitFailed.invoke(iParent, Qt::QueuedConnection,
+                Q_ARG(int, apdu->iId));
+        }
+        delete apdu;
+    }
+    while (!iOperations.isEmpty()) {
+        Operation* op = iOperations.takeFirst();
+
+        op->failed();
+        delete op;
+    }
+}
+
+void
+NfcIsoDep::Private::submit()
+{
+    // Only one APDU is handed over to the transceiver at a time, so
+    // that continuation commands don't end up behind the queued ones.
+    while (!iCurrent && !iQueue.isEmpty()) {
+        iCurrent = iQueue.dequeue();
+        send(iCurrent->command());
+    }
+}
+
+void
+NfcIsoDep::Private::send(
+    const QByteArray& aFrame)
+{
+    HVERBOSE(aFrame.toHex());
+    iFrameId = iTransceiver.transceive(aFrame);
+    if (!iFrameId) {
+        Apdu* apdu = iCurrent;
+
+        iCurrent = Q_NULLPTR;
+        completed(apdu, false, 0);
+    }
+}
+
+void
+NfcIsoDep::Private::finish(
+    uint aSw)
+{
+    Apdu* apdu = iCurrent;
+
+    iCurrent = Q_NULLPTR;
+    HDEBUG(apdu->iId << hex << aSw << apdu->iResponse.size() << "bytes");
+    completed(apdu, true, aSw);
+}
+
+void
+NfcIsoDep::Private::completed(
+    Apdu* aApdu,
+    bool aOk,
+    uint aSw)
+{
+    static const QMetaMethod transmitDone(QMetaMethod::fromSignal(
+        &NfcIsoDep::transmitDone));
+    static const QMetaMethod transmitFailed(QMetaMethod::fromSignal(
+        &NfcIsoDep::transmitFailed));
+    Operation* op = aApdu->iOperation;
+
+    if (op) {
+        if (aOk) {
+            if (!op->apduDone(aApdu->iResponse, aSw)) {
+                dropOperation(op);
+            }
+        } else {
+            op->failed();
+            dropOperation(op);
+        }
+    } else if (aOk) {
+        transmitDone.invoke(iParent, Qt::QueuedConnection,
+            Q_ARG(int, aApdu->iId), Q_ARG(QByteArray, aApdu->iResponse),
+            Q_ARG(uint, aSw));
+    } else {
+        transmitFailed.invoke(iParent, Qt::QueuedConnection,
+            Q_ARG(int, aApdu->iId));
+    }
+    delete aApdu;
+
+    // The next one (or whatever the operation has queued) is submitted
+    // only now. If the transceiver fails it synchronously, that recurses
+    // into completed() and may delete the operation, so nothing may be
+    // touched after this.
+    submit();
+}
+
+void
+NfcIsoDep::Private::dropOperation(
+    Operation* aOperation)
+{
+    // Remove whatever is left of it from the queue
+    for (int i = iQueue.count() - 1; i >= 0; i--) {
+        if (iQueue.at(i)->iOperation == aOperation) {
+            delete iQueue.takeAt(i);
+        }
+    }
+    if (iCurrent && iCurrent->iOperation == aOperation) {
+        iTransceiver.cancel(iFrameId);
+        delete iCurrent;
+        iCurrent = Q_NULLPTR;
+        submit();
+    }
+    iOperations.removeOne(aOperation);
+    delete aOperation;
+}
+
+void
+NfcIsoDep::Private::ndefRead(
+    int aId,
+    const QByteArray& aNdef)
+{
+    static const QMetaMethod readNdefDone(QMetaMethod::fromSignal(
+        &NfcIsoDep::readNdefDone));
+
+    // Parsed once, right here
+    iNdef = NfcNdefMessage(aNdef);
+    readNdefDone.invoke(iParent, Qt::QueuedConnection, Q_ARG(int, aId),
+        Q_ARG(QByteArray, aNdef));
+    if (iListener) {
+        iListener->ndefReadDone(aId, aNdef);
+    }
+}
+
+void
+NfcIsoDep::Private::ndefVerified(
+    int aId,
+    const QByteArray& aNdef)
+{
+    // Compared with the last message read or written
+    const bool ok = (aNdef == iNdef.data());
+
+    if (!ok) {
+        HDEBUG("Verification failed" << aNdef.toHex());
+        iNdef = NfcNdefMessage(aNdef);
+    }
+    if (iListener) {
+        iListener->ndefVerifyDone(aId, ok);
+    }
+}
+
+void
+NfcIsoDep::Private::ndefWritten(
+    int aId,
+    const QByteArray& aNdef)
+{
+    static const QMetaMethod writeNdefDone(QMetaMethod::fromSignal(
+        &NfcIsoDep::writeNdefDone));
+
+    // What's on the tag now
+    iNdef = NfcNdefMessage(aNdef);
+    writeNdefDone.invoke(iParent, Qt::QueuedConnection, Q_ARG(int, aId));
+    if (iListener) {
+        iListener->ndefWriteDone(aId);
+    }
+}
+
+void
+NfcIsoDep::Private::transceiveDone(
+    int aFrameId,
+    const GUtilData* aResponse,
+    qint64)
+{
+    if (iCurrent && iFrameId == aFrameId) {
+        if (aResponse->size >= 2) {
+            const uint n = aResponse->size - 2;
+            const uchar sw1 = aResponse->bytes[n];
+            const uchar sw2 = aResponse->bytes[n + 1];
+
+            iCurrent->iResponse.append((char*)aResponse->bytes, n);
+            if (iCurrent->iContinuations < MAX_CONTINUATIONS) {
+                if (sw1 == ISO_SW1_MORE_DATA) {
+                    iCurrent->iContinuations++;
+                    send(iCurrent->getResponse(sw2));
+                    return;
+                } else if (sw1 == ISO_SW1_WRONG_LE) {
+                    iCurrent->iContinuations++;
+                    iCurrent->iLe = sw2 ? sw2 : ISO_SHORT_LE_MAX;
+                    send(iCurrent->command());
+                    return;
+                }
+            }
+            finish((((uint)sw1) << 8) | sw2);
+        } else {
+            HDEBUG("Response too short");
+            transceiveFailed(aFrameId);
+        }
+    }
+}
+
+void
+NfcIsoDep::Private::transceiveFailed(
+    int aFrameId)
+{
+    if (iCurrent && iFrameId == aFrameId) {
+        Apdu* apdu = iCurrent;
+
+        iCurrent = Q_NULLPTR;
+        completed(apdu, false, 0);
+    }
+}
+
+// Qt signals should be signalled from the Qt event loop
+// See https://bugreports.qt.io/browse/QTBUG-18434 for details
+
+inline
+void
+NfcIsoDep::Private::emitValidChanged()
+{
+    static const QMetaMethod validChanged(QMetaMethod::fromSignal(
+        &NfcIsoDep::validChanged));
+
+    validChanged.invoke(iParent, Qt::QueuedConnection);
+}
+
+inline
+void
+NfcIsoDep::Private::emitPresentChanged()
+{
+    static const QMetaMethod presentChanged(QMetaMethod::fromSignal(
+        &NfcIsoDep::presentChanged));
+
+    presentChanged.invoke(iParent, Qt::QueuedConnection);
+}
+
+/* static */
+void
+NfcIsoDep::Private::validChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->emitValidChanged();
+}
+
+/* static */
+void
+NfcIsoDep::Private::presentChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->emitPresentChanged();
+}
+
+// ==========================================================================
+// NfcIsoDep
+// ==========================================================================
+
+NfcIsoDep::NfcIsoDep(
+    QObject* aParent) :
+    QObject(aParent),
+    iPrivate(new Private(this))
+{
+}
+
+NfcIsoDep::~NfcIsoDep()
+{
+    NfcIoLock lock;
+
+    delete iPrivate;
+}
+
+void
+NfcIsoDep::setPath(
+    QString aPath)
+{
+    NfcIoLock lock;
+
+    const QString currentPath(path());
+
+    if (currentPath != aPath) {
+        const bool wasValid = valid();
+        const bool wasPresent = present();
+
+        HDEBUG(aPath);
+        if (aPath.isEmpty()) {
+            iPrivate->setPath(Q_NULLPTR);
+        } else {
+            QByteArray bytes(aPath.toLatin1());
+            iPrivate->setPath(bytes.constData());
+        }
+
+        Q_EMIT pathChanged();
+        if (wasValid != valid()) {
+            Q_EMIT validChanged();
+        }
+        if (wasPresent != present()) {
+            Q_EMIT presentChanged();
+        }
+    }
+}
+
+QString
+NfcIsoDep::path() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag ? QString(iPrivate->iTag->path) : QString();
+}
+
+bool
+NfcIsoDep::valid() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag && iPrivate->iTag->valid;
+}
+
+bool
+NfcIsoDep::present() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag && iPrivate->iTag->present;
+}
+
+int
+NfcIsoDep::transmit(
+    int aCla,
+    int aIns,
+    int aP1,
+    int aP2,
+    QByteArray aData,
+    int aLe)
+{
+    NfcIoLock lock;
+
+    return iPrivate->transmit(aCla, aIns, aP1, aP2, aData, aLe);
+}
+
+bool
+NfcIsoDep::cancel(
+    int aId)
+{
+    NfcIoLock lock;
+
+    return iPrivate->cancel(aId);
+}
+
+int
+NfcIsoDep::readNdef()
+{
+    NfcIoLock lock;
+
+    return iPrivate->readNdef(false);
+}
+
+int
+NfcIsoDep::writeNdef(
+    QByteArray aNdef)
+{
+    NfcIoLock lock;
+
+    return iPrivate->writeNdef(aNdef);
+}
+
+void
+NfcIsoDep::setNdefListener(
+    NfcNdefListener* aListener)
+{
+    NfcIoLock lock;
+
+    iPrivate->iListener = aListener;
+}
+
+int
+NfcIsoDep::verifyNdef()
+{
+    NfcIoLock lock;
+
+    return iPrivate->readNdef(true);
+}
+
+NfcNdefMessage
+NfcIsoDep::ndef() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iNdef;
+}
+
+/* static */
+QByteArray
+NfcIsoDep::buildApdu(
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    int aLe)
+{
+    const int lc = aData.size();
+    const bool extended = (lc > 0xff || aLe > 0x100);
+    QByteArray apdu;
+
+    apdu.reserve(4 + 3 + lc + 3);
+    apdu.append((char)aCla);
+    apdu.append((char)aIns);
+    apdu.append((char)aP1);
+    apdu.append((char)aP2);
+    if (lc) {
+        if (extended) {
+            apdu.append((char)0);
+            apdu.append((char)(lc >> 8));
+        }
+        apdu.append((char)lc);
+        apdu.append(aData);
+    }
+    if (aLe > 0) {
+        // 256 (or 65536) is encoded as zero(s)
+        if (extended) {
+            if (!lc) {
+                apdu.append((char)0);
+            }
+            apdu.append((char)(aLe >> 8));
+        }
+        apdu.append((char)aLe);
+    }
+    return apdu;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2021-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -39,9 +39,11 @@
 
 #include <nfcdc_daemon.h>
 
+#include "NfcIoThread.h"
 #include "NfcMode.h"
 
 #include "Debug.h"
+#include "Trace.h"
 
 // ==========================================================================
 // NfcMode::Private
@@ -65,16 +67,20 @@ public:
 };
 
 NfcMode::Private::Private() :
-    iDaemon(nfc_daemon_client_new()),
     iRequest(Q_NULLPTR),
     iEnableModes(NfcSystem::None),
     iDisableModes(NfcSystem::None),
     iActive(false)
 {
+    NfcIoLock lock;
+
+    iDaemon = nfc_daemon_client_new();
 }
 
 NfcMode::Private::~Private()
 {
+    NfcIoLock lock;
+
     nfc_mode_request_free(iRequest);
     nfc_daemon_client_unref(iDaemon);
 }
@@ -89,6 +95,8 @@ NfcMode::Private::needRequest() const
 void
 NfcMode::Private::updateRequest()
 {
+    NfcIoLock lock;
+
     if (needRequest()) {
         // Create new request before disposing of the old one, so that
         // RequestMode D-Bus call gets issued before ReleaseMode.
@@ -96,9 +104,12 @@ NfcMode::Private::updateRequest()
         // the nfcd side.
         NfcModeRequest* req = nfc_mode_request_new(iDaemon, (NFC_MODE)
             iEnableModes, (NFC_MODE)iDisableModes);
+
+        HTRACE2(mode_request, iEnableModes, iDisableModes);
         nfc_mode_request_free(iRequest);
         iRequest = req;
     } else if (iRequest) {
+        HTRACE(mode_release);
         nfc_mode_request_free(iRequest);
         iRequest = Q_NULLPTR;
     }
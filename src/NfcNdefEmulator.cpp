@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcNdefEmulator.h"
+#include "NfcIoThread.h"
+
+#include "Debug.h"
+
+#include <QtCore/QExplicitlySharedDataPointer>
+#include <QtCore/QFile>
+#include <QtCore/QSharedData>
+
+#include <glib.h>
+
+#define ISO_INS_SELECT (0xa4)
+#define ISO_INS_READ_BINARY (0xb0)
+#define ISO_INS_UPDATE_BINARY (0xd6)
+#define ISO_P1_SELECT_BY_ID (0x00)
+#define ISO_P1_SELECT_BY_NAME (0x04)
+#define ISO_P1_SFI (0x80)
+#define ISO_SW_OK (0x9000)
+#define ISO_SW_SECURITY_STATUS (0x6982)
+#define ISO_SW_NO_CURRENT_EF (0x6986)
+#define ISO_SW_FILE_NOT_FOUND (0x6a82)
+#define ISO_SW_INCORRECT_P1P2 (0x6a86)
+#define ISO_SW_WRONG_OFFSET (0x6b00)
+#define ISO_SW_INS_NOT_SUPPORTED (0x6d00)
+#define ISO_SHORT_LE_MAX (0x100)
+
+// NFC Forum Type 4 Tag
+static const uchar T4_NDEF_AID[] = {
+    0xd2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01
+};
+static const uchar T4_CC_FILE[] = { 0xe1, 0x03 };
+static const uchar T4_NDEF_FILE[] = { 0xe1, 0x04 };
+#define T4_CC_SIZE (15)
+#define T4_NLEN_SIZE (2)
+#define T4_MAPPING_VERSION (0x20)
+#define T4_MLE (0x00ff)
+#define T4_MLC (0x0001)     // Writing is not supported anyway
+#define T4_NDEF_FILE_CONTROL_TLV (0x04)
+#define T4_ACCESS_GRANTED (0x00)
+#define T4_ACCESS_DENIED (0xff)
+#define T4_MAX_FILE_SIZE (0x7fff) // Offsets are 15-bit
+
+// ==========================================================================
+// NfcNdefEmulator::Private
+// ==========================================================================
+
+class NfcNdefEmulator::Private
+{
+public:
+    class Image;
+    typedef QExplicitlySharedDataPointer<Image> ImageRef;
+
+    enum File {
+        NoFile,
+        CcFile,
+        NdefFile
+    };
+
+    Private() : iApplicationSelected(false), iFile(NoFile) {}
+
+    static bool isValid(const uchar*, qint64);
+    void setImage(const ImageRef&);
+    void reset();
+    uint select(uchar, const QByteArray&);
+    uint read(uchar, uchar, uint, NfcHost::Response*) const;
+
+public:
+    ImageRef iImage;
+    ImageRef iSession;  // Image being read by the reader
+    bool iApplicationSelected;
+    File iFile;
+};
+
+// ==========================================================================
+// NfcNdefEmulator::Private::Image
+//
+// The NDEF file and the matching Capability Container. Images are
+// shared with the reader session, the one being read stays alive
+// until the reader selects the application again and the replies
+// pointing into it are gone. The last reference may be dropped by
+// GDBus on its own thread, hence GMappedFile rather than QFile.
+// ==========================================================================
+
+class NfcNdefEmulator::Private::Image :
+    public QSharedData
+{
+public:
+    Image(const QByteArray&);
+    Image(GMappedFile*);
+    ~Image();
+
+    Image* addRef();
+    static void release(void*);
+
+private:
+    void init();
+
+public:
+    GMappedFile* iMappedFile;
+    const QByteArray iBuffer;
+    const uchar* iData;
+    const int iSize;
+    uchar iCc[T4_CC_SIZE];
+};
+
+NfcNdefEmulator::Private::Image::Image(
+    const QByteArray& aData) :
+    iMappedFile(Q_NULLPTR),
+    iBuffer(aData),
+    iData((const uchar*)iBuffer.constData()),
+    iSize(iBuffer.size())
+{
+    init();
+}
+
+NfcNdefEmulator::Private::Image::Image(
+    GMappedFile* aFile) :
+    iMappedFile(aFile),
+    iData((const uchar*)g_mapped_file_get_contents(aFile)),
+    iSize((int)g_mapped_file_get_length(aFile))
+{
+    init();
+}
+
+NfcNdefEmulator::Private::Image::~Image()
+{
+    if (iMappedFile) {
+        g_mapped_file_unref(iMappedFile);
+    }
+}
+
+NfcNdefEmulator::Private::Image*
+NfcNdefEmulator::Private::Image::addRef()
+{
+    ref.ref();
+    return this;
+}
+
+/* static */
+void
+NfcNdefEmulator::Private::Image::release(
+    void* aImage)
+{
+    // NfcHost::Response::ReleaseFunc, may be invoked on any thread
+    Image* self = (Image*)aImage;
+
+    if (!self->ref.deref()) {
+        delete self;
+    }
+}
+
+void
+NfcNdefEmulator::Private::Image::init()
+{
+    uchar* cc = iCc;
+
+    // Built once, served as is
+    *cc++ = 0;
+    *cc++ = T4_CC_SIZE;
+    *cc++ = T4_MAPPING_VERSION;
+    *cc++ = (uchar)(T4_MLE >> 8);
+    *cc++ = (uchar)T4_MLE;
+    *cc++ = (uchar)(T4_MLC >> 8);
+    *cc++ = (uchar)T4_MLC;
+    *cc++ = T4_NDEF_FILE_CONTROL_TLV;
+    *cc++ = 6;
+    *cc++ = T4_NDEF_FILE[0];
+    *cc++ = T4_NDEF_FILE[1];
+    *cc++ = (uchar)(iSize >> 8);
+    *cc++ = (uchar)iSize;
+    *cc++ = T4_ACCESS_GRANTED;
+    *cc++ = T4_ACCESS_DENIED;
+}
+
+// ==========================================================================
+// NfcNdefEmulator::Private
+// ==========================================================================
+
+/* static */
+bool
+NfcNdefEmulator::Private::isValid(
+    const uchar* aData,
+    qint64 aSize)
+{
+    return aSize >= T4_NLEN_SIZE && aSize <= T4_MAX_FILE_SIZE &&
+        (T4_NLEN_SIZE + ((((uint)aData[0]) << 8) | aData[1])) <= aSize;
+}
+
+void
+NfcNdefEmulator::Private::setImage(
+    const ImageRef& aImage)
+{
+    // The session (if any) keeps the old one
+    iImage = aImage;
+}
+
+void
+NfcNdefEmulator::Private::reset()
+{
+    iApplicationSelected = false;
+    iFile = NoFile;
+    iSession.reset();
+}
+
+uint
+NfcNdefEmulator::Private::select(
+    uchar aP1,
+    const QByteArray& aData)
+{
+    if (aP1 == ISO_P1_SELECT_BY_NAME) {
+        reset();
+        if (iImage && aData.size() == sizeof(T4_NDEF_AID) &&
+            !memcmp(aData.constData(), T4_NDEF_AID, sizeof(T4_NDEF_AID))) {
+            // The reader keeps seeing this image until the next SELECT
+            iApplicationSelected = true;
+            iSession = iImage;
+            return ISO_SW_OK;
+        }
+    } else if (aP1 == ISO_P1_SELECT_BY_ID && iApplicationSelected &&
+        aData.size() == 2) {
+        if (!memcmp(aData.constData(), T4_CC_FILE, 2)) {
+            iFile = CcFile;
+            return ISO_SW_OK;
+        } else if (!memcmp(aData.constData(), T4_NDEF_FILE, 2)) {
+            iFile = NdefFile;
+            return ISO_SW_OK;
+        }
+        iFile = NoFile;
+    }
+    return ISO_SW_FILE_NOT_FOUND;
+}
+
+uint
+NfcNdefEmulator::Private::read(
+    uchar aP1,
+    uchar aP2,
+    uint aLe,
+    NfcHost::Response* aResponse) const
+{
+    const uchar* data;
+    int size;
+
+    switch (iFile) {
+    case CcFile:
+        data = iSession->iCc;
+        size = T4_CC_SIZE;
+        break;
+    case NdefFile:
+        data = iSession->iData;
+        size = iSession->iSize;
+        break;
+    case NoFile:
+    default:
+        return ISO_SW_NO_CURRENT_EF;
+    }
+
+    if (aP1 & ISO_P1_SFI) {
+        return ISO_SW_INCORRECT_P1P2;
+    }
+
+    const int offset = (((int)aP1) << 8) | aP2;
+
+    if (offset > size) {
+        return ISO_SW_WRONG_OFFSET;
+    }
+
+    // No Le means the same as 00, i.e. up to 256 bytes
+    const int n = qMin((int)((aLe && aLe < ISO_SHORT_LE_MAX) ? aLe :
+        ISO_SHORT_LE_MAX), size - offset);
+
+    // No copying, the reply holds a reference to the image
+    aResponse->setData(data + offset, n, Image::release, iSession->addRef());
+    return ISO_SW_OK;
+}
+
+// ==========================================================================
+// NfcNdefEmulator
+// ==========================================================================
+
+NfcNdefEmulator::NfcNdefEmulator() :
+    iPrivate(new Private)
+{
+}
+
+NfcNdefEmulator::~NfcNdefEmulator()
+{
+    NfcIoLock lock;
+
+    delete iPrivate;
+}
+
+/* static */
+QByteArray
+NfcNdefEmulator::aid()
+{
+    return QByteArray((const char*)T4_NDEF_AID, sizeof(T4_NDEF_AID));
+}
+
+/* static */
+QByteArray
+NfcNdefEmulator::buildImage(
+    const QByteArray& aNdef)
+{
+    QByteArray image;
+    const int size = aNdef.size();
+
+    image.reserve(T4_NLEN_SIZE + size);
+    image.append((char)(size >> 8));
+    image.append((char)size);
+    image.append(aNdef);
+    return image;
+}
+
+bool
+NfcNdefEmulator::setImage(
+    const QByteArray& aImage)
+{
+    if (Private::isValid((const uchar*)aImage.constData(), aImage.size())) {
+        // Built outside of the lock
+        Private::ImageRef image(new Private::Image(aImage));
+        NfcIoLock lock;
+
+        HDEBUG(aImage.size() << "bytes");
+        iPrivate->setImage(image);
+        return true;
+    }
+    HDEBUG("Invalid image");
+    return false;
+}
+
+bool
+NfcNdefEmulator::setImageFile(
+    const QString& aPath)
+{
+    GError* error = Q_NULLPTR;
+    GMappedFile* file = g_mapped_file_new(QFile::encodeName(aPath).constData(),
+        FALSE, &error);
+
+    // The mapping remains valid after the file is closed
+    if (file) {
+        const uchar* map = (const uchar*)g_mapped_file_get_contents(file);
+        const gsize size = g_mapped_file_get_length(file);
+
+        if (map && Private::isValid(map, size)) {
+            Private::ImageRef image(new Private::Image(file));
+            NfcIoLock lock;
+
+            HDEBUG(aPath << size << "bytes");
+            iPrivate->setImage(image);
+            return true;
+        }
+        HDEBUG("Invalid image" << aPath);
+        g_mapped_file_unref(file);
+    } else {
+        HDEBUG("Failed to open" << aPath << error->message);
+        g_error_free(error);
+    }
+    return false;
+}
+
+void
+NfcNdefEmulator::clearImage()
+{
+    NfcIoLock lock;
+
+    iPrivate->setImage(Private::ImageRef());
+}
+
+bool
+NfcNdefEmulator::hasImage() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iImage;
+}
+
+uint
+NfcNdefEmulator::processApdu(
+    NfcHost*,
+    uchar,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    uint aLe,
+    NfcHost::Response* aResponse)
+{
+    // Invoked by NfcHost, with NfcIoLock held if necessary
+    switch (aIns) {
+    case ISO_INS_SELECT:
+        return iPrivate->select(aP1, aData);
+    case ISO_INS_READ_BINARY:
+        return iPrivate->read(aP1, aP2, aLe, aResponse);
+    case ISO_INS_UPDATE_BINARY:
+        return ISO_SW_SECURITY_STATUS;
+    }
+    return ISO_SW_INS_NOT_SUPPORTED;
+}
+
+void
+NfcNdefEmulator::hostReset(
+    NfcHost*)
+{
+    iPrivate->reset();
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcNdefMessage.h"
+
+#include "Debug.h"
+
+// NDEF record header
+#define NDEF_MB (0x80)  // Message Begin
+#define NDEF_ME (0x40)  // Message End
+#define NDEF_CF (0x20)  // Chunk Flag
+#define NDEF_SR (0x10)  // Short Record
+#define NDEF_IL (0x08)  // ID Length is present
+#define NDEF_TNF (0x07) // Type Name Format
+
+// ==========================================================================
+// NfcNdefMessage
+// ==========================================================================
+
+NfcNdefMessage::NfcNdefMessage() :
+    iOffset(0),
+    iSize(0),
+    iValid(false)
+{
+}
+
+NfcNdefMessage::NfcNdefMessage(
+    const QByteArray& aData) :
+    iBuffer(aData),
+    iOffset(0),
+    iSize(aData.size()),
+    iValid(false)
+{
+    iValid = parse();
+}
+
+NfcNdefMessage::NfcNdefMessage(
+    const QByteArray& aData,
+    int aOffset,
+    int aSize) :
+    iBuffer(aData),
+    iOffset(qBound(0, aOffset, aData.size())),
+    iSize(qBound(0, aSize, aData.size() - iOffset)),
+    iValid(false)
+{
+    iValid = parse();
+}
+
+bool
+NfcNdefMessage::parse()
+{
+    if (!parseRecords()) {
+        iRecords.clear();
+        return false;
+    }
+    return true;
+}
+
+bool
+NfcNdefMessage::parseRecords()
+{
+    const uchar* buf = (const uchar*)iBuffer.constData();
+    const int end = iOffset + iSize;
+    int pos = iOffset;
+    int chunkStart = -1;
+    QByteArray chunked;
+
+    while (pos < end) {
+        const uchar hdr = buf[pos++];
+        const NfcNdefRecord::Tnf tnf = (NfcNdefRecord::Tnf)(hdr & NDEF_TNF);
+        const int lenBytes = 1 + ((hdr & NDEF_SR) ? 1 : 4) +
+            ((hdr & NDEF_IL) ? 1 : 0);
+
+        if ((pos == iOffset + 1) != ((hdr & NDEF_MB) != 0) ||
+            (end - pos) < lenBytes) {
+            HDEBUG("Broken NDEF header at" << (pos - 1));
+            return false;
+        }
+
+        const int typeSize = buf[pos++];
+        quint32 payloadSize;
+
+        if (hdr & NDEF_SR) {
+            payloadSize = buf[pos++];
+        } else {
+            payloadSize = (((quint32)buf[pos]) << 24) |
+                (((quint32)buf[pos + 1]) << 16) |
+                (((quint32)buf[pos + 2]) << 8) |
+                ((quint32)buf[pos + 3]);
+            pos += 4;
+        }
+
+        const int idSize = (hdr & NDEF_IL) ? buf[pos++] : 0;
+        const int typeOffset = pos;
+        const int idOffset = typeOffset + typeSize;
+        const int payloadOffset = idOffset + idSize;
+
+        if (payloadOffset > end || payloadSize > (quint32)(end -
+            payloadOffset)) {
+            HDEBUG("NDEF record at" << typeOffset << "is too long");
+            return false;
+        }
+        pos = payloadOffset + payloadSize;
+
+        if (chunkStart >= 0) {
+            // Middle or terminating chunk
+            if (tnf != NfcNdefRecord::TnfUnchanged || typeSize || idSize) {
+                HDEBUG("Unexpected NDEF chunk at" << typeOffset);
+                return false;
+            }
+            chunked.append((const char*)buf + payloadOffset, payloadSize);
+            if (!(hdr & NDEF_CF)) {
+                // Record is complete, its payload now lives in its own
+                // buffer, prefixed by the type and id of the first chunk
+                const uchar* first = buf + chunkStart;
+                const int firstTypeSize = first[1];
+                const int firstIdOffset = (first[0] & NDEF_SR) ? 3 : 6;
+                const int firstIdSize = (first[0] & NDEF_IL) ?
+                    first[firstIdOffset] : 0;
+                const int prefixSize = firstTypeSize + firstIdSize;
+
+                iRecords.append(NfcNdefRecord(chunked,
+                    (NfcNdefRecord::Tnf)(first[0] & NDEF_TNF), 0,
+                    firstTypeSize, firstTypeSize, firstIdSize, prefixSize,
+                    chunked.size() - prefixSize));
+                chunked.clear();
+                chunkStart = -1;
+            }
+        } else if (tnf == NfcNdefRecord::TnfUnchanged) {
+            HDEBUG("Unexpected TNF at" << typeOffset);
+            return false;
+        } else if (hdr & NDEF_CF) {
+            // Initial chunk
+            chunkStart = typeOffset - lenBytes - 1;
+            chunked.reserve(typeSize + idSize + payloadSize);
+            chunked.append((const char*)buf + typeOffset, typeSize);
+            chunked.append((const char*)buf + idOffset, idSize);
+            chunked.append((const char*)buf + payloadOffset, payloadSize);
+        } else {
+            iRecords.append(NfcNdefRecord(iBuffer, tnf, typeOffset, typeSize,
+                idOffset, idSize, payloadOffset, payloadSize));
+        }
+
+        if (hdr & NDEF_ME) {
+            return chunkStart < 0;
+        }
+    }
+    HDEBUG("NDEF message end is missing");
+    return false;
+}
+
+bool
+NfcNdefMessage::isValid() const
+{
+    return iValid;
+}
+
+bool
+NfcNdefMessage::isEmpty() const
+{
+    return iRecords.isEmpty();
+}
+
+int
+NfcNdefMessage::count() const
+{
+    return iRecords.count();
+}
+
+const NfcNdefRecord&
+NfcNdefMessage::at(
+    int aIndex) const
+{
+    return iRecords.at(aIndex);
+}
+
+QByteArray
+NfcNdefMessage::data() const
+{
+    return iBuffer.mid(iOffset, iSize);
+}
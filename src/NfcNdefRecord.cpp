@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcNdefMessage.h"
+
+#include <QtCore/QVector>
+
+#include <string.h>
+
+// NFC Forum URI Record Type Definition
+static const char* const URI_PREFIX[] = {
+    "",                           // 0x00
+    "http://www.",                // 0x01
+    "https://www.",               // 0x02
+    "http://",                    // 0x03
+    "https://",                   // 0x04
+    "tel:",                       // 0x05
+    "mailto:",                    // 0x06
+    "ftp://anonymous:anonymous@", // 0x07
+    "ftp://ftp.",                 // 0x08
+    "ftps://",                    // 0x09
+    "sftp://",                    // 0x0A
+    "smb://",                     // 0x0B
+    "nfs://",                     // 0x0C
+    "ftp://",                     // 0x0D
+    "dav://",                     // 0x0E
+    "news:",                      // 0x0F
+    "telnet://",                  // 0x10
+    "imap:",                      // 0x11
+    "rtsp://",                    // 0x12
+    "urn:",                       // 0x13
+    "pop:",                       // 0x14
+    "sip:",                       // 0x15
+    "sips:",                      // 0x16
+    "tftp:",                      // 0x17
+    "btspp://",                   // 0x18
+    "btl2cap://",                 // 0x19
+    "btgoep://",                  // 0x1A
+    "tcpobex://",                 // 0x1B
+    "irdaobex://",                // 0x1C
+    "file://",                    // 0x1D
+    "urn:epc:id:",                // 0x1E
+    "urn:epc:tag:",               // 0x1F
+    "urn:epc:pat:",               // 0x20
+    "urn:epc:raw:",               // 0x21
+    "urn:epc:",                   // 0x22
+    "urn:nfc:"                    // 0x23
+};
+
+#define URI_PREFIX_COUNT (sizeof(URI_PREFIX)/sizeof(URI_PREFIX[0]))
+
+// NFC Forum Text Record Type Definition
+#define TEXT_UTF16 (0x80)
+#define TEXT_LANG_MASK (0x3f)
+
+// ==========================================================================
+// NfcNdefRecord
+// ==========================================================================
+
+NfcNdefRecord::NfcNdefRecord() :
+    iTnf(TnfEmpty),
+    iTypeOffset(0),
+    iTypeSize(0),
+    iIdOffset(0),
+    iIdSize(0),
+    iPayloadOffset(0),
+    iPayloadSize(0)
+{
+}
+
+NfcNdefRecord::NfcNdefRecord(
+    const QByteArray& aBuffer,
+    Tnf aTnf,
+    int aTypeOffset,
+    int aTypeSize,
+    int aIdOffset,
+    int aIdSize,
+    int aPayloadOffset,
+    int aPayloadSize) :
+    iBuffer(aBuffer),
+    iTnf(aTnf),
+    iTypeOffset(aTypeOffset),
+    iTypeSize(aTypeSize),
+    iIdOffset(aIdOffset),
+    iIdSize(aIdSize),
+    iPayloadOffset(aPayloadOffset),
+    iPayloadSize(aPayloadSize)
+{
+}
+
+bool
+NfcNdefRecord::isValid() const
+{
+    return !iBuffer.isNull();
+}
+
+NfcNdefRecord::Tnf
+NfcNdefRecord::tnf() const
+{
+    return iTnf;
+}
+
+bool
+NfcNdefRecord::isType(
+    Tnf aTnf,
+    const char* aType) const
+{
+    const int len = aType ? (int)strlen(aType) : 0;
+
+    return iTnf == aTnf && iTypeSize == len &&
+        !memcmp(iBuffer.constData() + iTypeOffset, aType, len);
+}
+
+QByteArray
+NfcNdefRecord::type() const
+{
+    return iBuffer.mid(iTypeOffset, iTypeSize);
+}
+
+QByteArray
+NfcNdefRecord::id() const
+{
+    return iBuffer.mid(iIdOffset, iIdSize);
+}
+
+const uchar*
+NfcNdefRecord::payloadData() const
+{
+    return (const uchar*)iBuffer.constData() + iPayloadOffset;
+}
+
+int
+NfcNdefRecord::payloadSize() const
+{
+    return iPayloadSize;
+}
+
+QByteArray
+NfcNdefRecord::payload() const
+{
+    return iBuffer.mid(iPayloadOffset, iPayloadSize);
+}
+
+bool
+NfcNdefRecord::isUri() const
+{
+    return isType(TnfWellKnown, "U") && iPayloadSize > 0;
+}
+
+QString
+NfcNdefRecord::uri() const
+{
+    if (isUri()) {
+        const uchar* data = payloadData();
+        const uint prefix = data[0];
+
+        return QString::fromUtf8((prefix < URI_PREFIX_COUNT) ?
+            URI_PREFIX[prefix] : "") + QString::fromUtf8((const char*)
+            data + 1, iPayloadSize - 1);
+    }
+    return QString();
+}
+
+bool
+NfcNdefRecord::isText() const
+{
+    return isType(TnfWellKnown, "T") && iPayloadSize > 0 &&
+        (payloadData()[0] & TEXT_LANG_MASK) < iPayloadSize;
+}
+
+QString
+NfcNdefRecord::text() const
+{
+    if (isText()) {
+        const uchar* data = payloadData();
+        const uchar status = data[0];
+        const int offset = 1 + (status & TEXT_LANG_MASK);
+        const uchar* text = data + offset;
+        const int size = iPayloadSize - offset;
+
+        if (status & TEXT_UTF16) {
+            // Big endian unless there's a BOM saying otherwise
+            int i = 0;
+            bool le = false;
+            const int n = size / 2;
+            QVector<ushort> chars;
+
+            if (n > 0) {
+                if (text[0] == 0xff && text[1] == 0xfe) {
+                    le = true;
+                    i++;
+                } else if (text[0] == 0xfe && text[1] == 0xff) {
+                    i++;
+                }
+            }
+            chars.reserve(n - i);
+            for (; i < n; i++) {
+                const uchar* c = text + 2 * i;
+
+                chars.append(le ? ((c[1] << 8) | c[0]) : ((c[0] << 8) | c[1]));
+            }
+            return QString::fromUtf16(chars.constData(), chars.count());
+        } else {
+            return QString::fromUtf8((const char*)text, size);
+        }
+    }
+    return QString();
+}
+
+QString
+NfcNdefRecord::textLanguage() const
+{
+    if (isText()) {
+        const uchar* data = payloadData();
+
+        return QString::fromLatin1((const char*)data + 1,
+            data[0] & TEXT_LANG_MASK);
+    }
+    return QString();
+}
+
+bool
+NfcNdefRecord::isSmartPoster() const
+{
+    return isType(TnfWellKnown, "Sp");
+}
+
+NfcNdefMessage
+NfcNdefRecord::smartPoster() const
+{
+    // Nested message shares the same buffer
+    return isSmartPoster() ?
+        NfcNdefMessage(iBuffer, iPayloadOffset, iPayloadSize) :
+        NfcNdefMessage();
+}
+
+bool
+NfcNdefRecord::isMediaType() const
+{
+    return iTnf == TnfMediaType && iTypeSize > 0;
+}
+
+QString
+NfcNdefRecord::mediaType() const
+{
+    return isMediaType() ? QString::fromLatin1(iBuffer.constData() +
+        iTypeOffset, iTypeSize) : QString();
+}
@@ -0,0 +1,684 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include <nfcdc_tag.h>
+
+#include <gio/gio.h>
+
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+#include "NfcNdefRecordModel.h"
+#include "NfcSignalTable.h"
+
+#include "Debug.h"
+
+#include <QtCore/QVector>
+
+#define NFCD_SERVICE "org.sailfishos.nfc.daemon"
+#define NFCD_NDEF_INTERFACE "org.sailfishos.nfc.NDEF"
+
+enum ndef_model_tag_events {
+    NDEF_MODEL_TAG_EVENT_VALID,
+    NDEF_MODEL_TAG_EVENT_RECORDS,
+    NDEF_MODEL_TAG_EVENT_COUNT
+};
+
+// ==========================================================================
+// NfcNdefRecordModel::Private
+// ==========================================================================
+
+class NfcNdefRecordModel::Private :
+    public QObject
+{
+    Q_OBJECT
+
+public:
+    class Record;
+    class Row;
+
+    Private(NfcNdefRecordModel*);
+    ~Private();
+
+    void setPath(const char*);
+    QList<QByteArray> currentPaths() const;
+    int indexOf(const QByteArray&) const;
+    int rowOf(const QByteArray&) const;
+    void startCall(Record*, const char*, GAsyncReadyCallback);
+    void fetchInfo(Record*);
+    void fetchPayload(Record*);
+    void notifyRecord(Record*, Role, const QVariant&);
+    static void busReady(GObject*, GAsyncResult*, gpointer);
+    static GVariant* finishCall(GObject*, GAsyncResult*, bool*);
+    static void tnfDone(GObject*, GAsyncResult*, gpointer);
+    static void typeDone(GObject*, GAsyncResult*, gpointer);
+    static void payloadDone(GObject*, GAsyncResult*, gpointer);
+    static void recordsChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+
+public Q_SLOTS:
+    void updateRecords();
+    void recordChanged(QByteArray, int, QVariant);
+
+public:
+    NfcNdefRecordModel* iParent;
+    GCancellable* iCancel;
+    GDBusConnection* iBus;      // Zero until g_bus_get completes
+    NfcTagClient* iTag;
+    gulong iTagEventId[NDEF_MODEL_TAG_EVENT_COUNT];
+    QList<Record*> iRecords;    // Protected by NfcIoLock
+    QList<Row> iRows;           // Only touched on the Qt thread
+    bool iUpdatePending;
+};
+
+// ==========================================================================
+// NfcNdefRecordModel::Private::Record
+// ==========================================================================
+
+class NfcNdefRecordModel::Private::Record
+{
+public:
+    Record(Private*, const QByteArray&);
+    ~Record();
+
+public:
+    Private* iOwner;
+    const QByteArray iPath;
+    GCancellable* iCancel;
+    bool iPayloadKnown;
+    bool iPayloadPending;
+    bool iPayloadFailed;    // Not retried until the records change
+};
+
+NfcNdefRecordModel::Private::Record::Record(
+    Private* aOwner,
+    const QByteArray& aPath) :
+    iOwner(aOwner),
+    iPath(aPath),
+    iCancel(g_cancellable_new()),
+    iPayloadKnown(false),
+    iPayloadPending(false),
+    iPayloadFailed(false)
+{
+}
+
+NfcNdefRecordModel::Private::Record::~Record()
+{
+    // Pending calls complete with G_IO_ERROR_CANCELLED
+    g_cancellable_cancel(iCancel);
+    g_object_unref(iCancel);
+}
+
+// ==========================================================================
+// NfcNdefRecordModel::Private::Row
+//
+// What the model exposes. The values are delivered by recordChanged()
+// so that data() never has to look at the Record, and doesn't need
+// the I/O lock.
+// ==========================================================================
+
+class NfcNdefRecordModel::Private::Row
+{
+public:
+    Row(const QByteArray& aPath) : iPath(aPath), iTnf(0),
+        iPayloadKnown(false) {}
+
+public:
+    QByteArray iPath;
+    uint iTnf;
+    QByteArray iType;
+    QByteArray iPayload;
+    bool iPayloadKnown;
+};
+
+// ==========================================================================
+// NfcNdefRecordModel::Private
+// ==========================================================================
+
+NfcNdefRecordModel::Private::Private(
+    NfcNdefRecordModel* aParent) :
+    iParent(aParent),
+    iCancel(g_cancellable_new()),
+    iBus(Q_NULLPTR),
+    iTag(Q_NULLPTR),
+    iUpdatePending(false)
+{
+    memset(iTagEventId, 0, sizeof(iTagEventId));
+
+    NfcIoLock lock;
+
+    // libgnfcdc has already connected to the bus (or is about to), so
+    // this doesn't block. Calls are made once the bus is there.
+    g_bus_get(G_BUS_TYPE_SYSTEM, iCancel, busReady, this);
+}
+
+NfcNdefRecordModel::Private::~Private()
+{
+    NfcIoLock lock;
+
+    // busReady() won't touch us anymore
+    g_cancellable_cancel(iCancel);
+    g_object_unref(iCancel);
+    qDeleteAll(iRecords);
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+    if (iBus) {
+        g_object_unref(iBus);
+    }
+}
+
+void
+NfcNdefRecordModel::Private::setPath(
+    const char* aPath)
+{
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+    if (aPath) {
+        iTag = NfcClientPool::get()->newTag(aPath);
+        iTagEventId[NDEF_MODEL_TAG_EVENT_VALID] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_VALID, recordsChanged, this);
+        iTagEventId[NDEF_MODEL_TAG_EVENT_RECORDS] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_NDEF_RECORDS, recordsChanged, this);
+    } else {
+        iTag = Q_NULLPTR;
+    }
+}
+
+QList<QByteArray>
+NfcNdefRecordModel::Private::currentPaths() const
+{
+    QList<QByteArray> paths;
+
+    if (iTag && iTag->valid && iTag->ndef_records) {
+        const char* const* ptr = iTag->ndef_records;
+
+        while (*ptr) {
+            paths.append(QByteArray(*ptr++));
+        }
+    }
+    return paths;
+}
+
+int
+NfcNdefRecordModel::Private::indexOf(
+    const QByteArray& aPath) const
+{
+    const int n = iRecords.count();
+
+    for (int i = 0; i < n; i++) {
+        if (iRecords.at(i)->iPath == aPath) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int
+NfcNdefRecordModel::Private::rowOf(
+    const QByteArray& aPath) const
+{
+    const int n = iRows.count();
+
+    for (int i = 0; i < n; i++) {
+        if (iRows.at(i).iPath == aPath) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void
+NfcNdefRecordModel::Private::startCall(
+    Record* aRecord,
+    const char* aMethod,
+    GAsyncReadyCallback aCallback)
+{
+    if (iBus) {
+        g_dbus_connection_call(iBus, NFCD_SERVICE, aRecord->iPath.constData(),
+            NFCD_NDEF_INTERFACE, aMethod, Q_NULLPTR, Q_NULLPTR,
+            G_DBUS_CALL_FLAGS_NONE, -1, aRecord->iCancel, aCallback,
+            aRecord);
+    }
+}
+
+void
+NfcNdefRecordModel::Private::fetchInfo(
+    Record* aRecord)
+{
+    // Otherwise busReady() will do it
+    if (iBus) {
+        startCall(aRecord, "GetTypeNameFormat", tnfDone);
+        startCall(aRecord, "GetType", typeDone);
+    }
+}
+
+void
+NfcNdefRecordModel::Private::fetchPayload(
+    Record* aRecord)
+{
+    if (!aRecord->iPayloadKnown && !aRecord->iPayloadPending &&
+        !aRecord->iPayloadFailed) {
+        HDEBUG(aRecord->iPath.constData());
+        aRecord->iPayloadPending = true;
+        if (iBus) {
+            startCall(aRecord, "GetPayload", payloadDone);
+        }
+    }
+}
+
+void
+NfcNdefRecordModel::Private::notifyRecord(
+    Record* aRecord,
+    Role aRole,
+    const QVariant& aValue)
+{
+    static const QMetaMethod recordChanged(nfcSlot<Private>(
+        "recordChanged(QByteArray,int,QVariant)"));
+
+    // Qt signals should be signalled from the Qt event loop
+    // See https://bugreports.qt.io/browse/QTBUG-18434 for details
+    recordChanged.invoke(this, Qt::QueuedConnection,
+        Q_ARG(QByteArray, aRecord->iPath), Q_ARG(int, aRole),
+        Q_ARG(QVariant, aValue));
+}
+
+/* static */
+void
+NfcNdefRecordModel::Private::busReady(
+    GObject*,
+    GAsyncResult* aResult,
+    gpointer aPrivate)
+{
+    GError* error = Q_NULLPTR;
+    GDBusConnection* bus = g_bus_get_finish(aResult, &error);
+
+    if (bus) {
+        Private* self = (Private*)aPrivate;
+        const int n = self->iRecords.count();
+
+        // Make the calls which have been waiting for the bus
+        self->iBus = bus;
+        for (int i = 0; i < n; i++) {
+            Record* record = self->iRecords.at(i);
+
+            self->fetchInfo(record);
+            if (record->iPayloadPending) {
+                self->startCall(record, "GetPayload", payloadDone);
+            }
+        }
+    } else {
+        // If the call has been cancelled, the object may be gone
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            qWarning() << error->message;
+        }
+        g_error_free(error);
+    }
+}
+
+/* static */
+GVariant*
+NfcNdefRecordModel::Private::finishCall(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    bool* aCancelled)
+{
+    GError* error = Q_NULLPTR;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(aBus),
+        aResult, &error);
+
+    // If the call has been cancelled, the record is gone
+    *aCancelled = false;
+    if (error) {
+        *aCancelled = g_error_matches(error, G_IO_ERROR,
+            G_IO_ERROR_CANCELLED);
+        HDEBUG(error->message);
+        g_error_free(error);
+    }
+    return ret;
+}
+
+/* static */
+void
+NfcNdefRecordModel::Private::tnfDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aRecord)
+{
+    bool cancelled;
+    GVariant* ret = finishCall(aBus, aResult, &cancelled);
+
+    if (ret) {
+        Record* record = (Record*)aRecord;
+        guint tnf = 0;
+
+        g_variant_get(ret, "(u)", &tnf);
+        g_variant_unref(ret);
+        record->iOwner->notifyRecord(record, TnfRole, QVariant((uint)tnf));
+    }
+}
+
+/* static */
+void
+NfcNdefRecordModel::Private::typeDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aRecord)
+{
+    bool cancelled;
+    GVariant* ret = finishCall(aBus, aResult, &cancelled);
+
+    if (ret) {
+        Record* record = (Record*)aRecord;
+        GVariant* type = g_variant_get_child_value(ret, 0);
+        gsize size = 0;
+        const void* data = g_variant_get_fixed_array(type, &size, 1);
+        const QByteArray bytes((const char*)data, (int)size);
+
+        g_variant_unref(type);
+        g_variant_unref(ret);
+        record->iOwner->notifyRecord(record, TypeRole, QVariant(bytes));
+    }
+}
+
+/* static */
+void
+NfcNdefRecordModel::Private::payloadDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aRecord)
+{
+    bool cancelled;
+    GVariant* ret = finishCall(aBus, aResult, &cancelled);
+
+    if (!cancelled) {
+        Record* record = (Record*)aRecord;
+
+        // Not retried until the records change, data() would keep
+        // asking for it on every repaint
+        record->iPayloadPending = false;
+        record->iPayloadFailed = !ret;
+        if (ret) {
+            GVariant* payload = g_variant_get_child_value(ret, 0);
+            gsize size = 0;
+            const void* data = g_variant_get_fixed_array(payload, &size, 1);
+            const QByteArray bytes((const char*)data, (int)size);
+
+            record->iPayloadKnown = true;
+            g_variant_unref(payload);
+            g_variant_unref(ret);
+            record->iOwner->notifyRecord(record, PayloadRole,
+                QVariant(bytes));
+        }
+    }
+}
+
+/* static */
+void
+NfcNdefRecordModel::Private::recordsChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aPrivate)
+{
+    Private* self = (Private*)aPrivate;
+
+    // Several notifications may be handled by a single update
+    if (!self->iUpdatePending) {
+        static const QMetaMethod updateRecords(nfcSlot<Private>(
+            "updateRecords()"));
+
+        self->iUpdatePending = true;
+        updateRecords.invoke(self, Qt::QueuedConnection);
+    }
+}
+
+void
+NfcNdefRecordModel::Private::updateRecords()
+{
+    const int prevCount = iRows.count();
+    QList<QByteArray> paths;
+    bool same;
+
+    // Only the record bookkeeping and the calls it starts need the lock,
+    // the model signals are emitted after it's released
+    {
+        NfcIoLock lock;
+
+        iUpdatePending = false;
+        paths = currentPaths();
+        same = (paths.count() == prevCount);
+        for (int i = 0; i < prevCount && same; i++) {
+            same = (iRows.at(i).iPath == paths.at(i));
+        }
+
+        if (!same) {
+            const int n = paths.count();
+            QList<Record*> records;
+
+            for (int i = 0; i < n; i++) {
+                const QByteArray& path = paths.at(i);
+                const int pos = indexOf(path);
+
+                if (pos >= 0) {
+                    Record* record = iRecords.takeAt(pos);
+
+                    // Give the failed payload another chance
+                    record->iPayloadFailed = false;
+                    records.append(record);
+                } else {
+                    Record* record = new Record(this, path);
+
+                    fetchInfo(record);
+                    records.append(record);
+                }
+            }
+            qDeleteAll(iRecords);
+            iRecords = records;
+        }
+    }
+
+    if (!same) {
+        const int n = paths.count();
+        QList<Row> rows;
+
+        for (int i = 0; i < n; i++) {
+            const QByteArray& path = paths.at(i);
+            const int pos = rowOf(path);
+
+            rows.append((pos >= 0) ? iRows.at(pos) : Row(path));
+        }
+
+        // Records rarely change, there's no point in being smart
+        HDEBUG(paths);
+        iParent->beginResetModel();
+        iRows = rows;
+        iParent->endResetModel();
+        if (prevCount != n) {
+            Q_EMIT iParent->countChanged();
+        }
+    }
+}
+
+void
+NfcNdefRecordModel::Private::recordChanged(
+    QByteArray aPath,
+    int aRole,
+    QVariant aValue)
+{
+    const int row = rowOf(aPath);
+
+    // Nothing to do if the record has gone by now
+    if (row >= 0) {
+        const QModelIndex index(iParent->index(row));
+        Row& entry = iRows[row];
+
+        switch ((Role)aRole) {
+        case TnfRole:
+            entry.iTnf = aValue.toUInt();
+            break;
+        case TypeRole:
+            entry.iType = aValue.toByteArray();
+            break;
+        case PayloadRole:
+            entry.iPayload = aValue.toByteArray();
+            entry.iPayloadKnown = true;
+            break;
+        case PathRole:
+            break;
+        }
+        Q_EMIT iParent->dataChanged(index, index, QVector<int>() << aRole);
+    }
+}
+
+// ==========================================================================
+// NfcNdefRecordModel
+// ==========================================================================
+
+NfcNdefRecordModel::NfcNdefRecordModel(
+    QObject* aParent) :
+    QAbstractListModel(aParent),
+    iPrivate(new Private(this))
+{
+}
+
+NfcNdefRecordModel::~NfcNdefRecordModel()
+{
+    delete iPrivate;
+}
+
+QString
+NfcNdefRecordModel::path() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag ? QString(iPrivate->iTag->path) : QString();
+}
+
+void
+NfcNdefRecordModel::setPath(
+    QString aPath)
+{
+    bool changed = false;
+
+    {
+        NfcIoLock lock;
+
+        if (path() != aPath) {
+            HDEBUG(aPath);
+            if (aPath.isEmpty()) {
+                iPrivate->setPath(Q_NULLPTR);
+            } else {
+                QByteArray bytes(aPath.toLatin1());
+                iPrivate->setPath(bytes.constData());
+            }
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        // Pooled client may already be valid
+        iPrivate->updateRecords();
+        Q_EMIT pathChanged();
+    }
+}
+
+int
+NfcNdefRecordModel::count() const
+{
+    return iPrivate->iRows.count();
+}
+
+QByteArray
+NfcNdefRecordModel::payload(
+    int aRow) const
+{
+    if (aRow >= 0 && aRow < iPrivate->iRows.count()) {
+        const Private::Row& row = iPrivate->iRows.at(aRow);
+
+        if (!row.iPayloadKnown) {
+            NfcIoLock lock;
+
+            // Rows and records are updated together on the Qt thread
+            iPrivate->fetchPayload(iPrivate->iRecords.at(aRow));
+        }
+        return row.iPayload;
+    }
+    return QByteArray();
+}
+
+QHash<int,QByteArray>
+NfcNdefRecordModel::roleNames() const
+{
+    QHash<int,QByteArray> roles;
+
+    roles.insert(PathRole, "path");
+    roles.insert(TnfRole, "tnf");
+    roles.insert(TypeRole, "type");
+    roles.insert(PayloadRole, "payload");
+    return roles;
+}
+
+int
+NfcNdefRecordModel::rowCount(
+    const QModelIndex& aParent) const
+{
+    return aParent.isValid() ? 0 : iPrivate->iRows.count();
+}
+
+QVariant
+NfcNdefRecordModel::data(
+    const QModelIndex& aIndex,
+    int aRole) const
+{
+    const int row = aIndex.row();
+
+    if (row >= 0 && row < iPrivate->iRows.count()) {
+        switch ((Role)aRole) {
+        case PathRole:
+            return QString(iPrivate->iRows.at(row).iPath);
+        case TnfRole:
+            return (int)iPrivate->iRows.at(row).iTnf;
+        case TypeRole:
+            return iPrivate->iRows.at(row).iType;
+        case PayloadRole:
+            return payload(row);
+        }
+    }
+    return QVariant();
+}
+
+#include "NfcNdefRecordModel.moc"
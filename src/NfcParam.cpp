@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2025-2026 Slava Monich <slava@monich.com>
  *
  * You may use this file under the terms of the BSD license as follows:
  *
@@ -38,8 +38,11 @@
 
 #include <nfcdc_default_adapter.h>
 
+#include "NfcIoThread.h"
 #include "NfcParam.h"
 
+#include "Trace.h"
+
 // This requires libgnfcdc 1.2.0 or newer
 #ifdef NFCDC_VERSION_1_2_0
 
@@ -69,17 +72,21 @@ public:
 };
 
 NfcParam::Private::Private() :
-    iAdapter(nfc_default_adapter_new()),
     iRequest(Q_NULLPTR),
     iT4Ndef(Q_NULLPTR),
     iLaNfcid1(Q_NULLPTR),
     iReset(false),
     iActive(false)
 {
+    NfcIoLock lock;
+
+    iAdapter = nfc_default_adapter_new();
 }
 
 NfcParam::Private::~Private()
 {
+    NfcIoLock lock;
+
     delete iT4Ndef;
     delete iLaNfcid1;
     nfc_default_adapter_param_req_free(iRequest);
@@ -96,6 +103,8 @@ NfcParam::Private::needRequest() const
 void
 NfcParam::Private::updateRequest()
 {
+    NfcIoLock lock;
+
     if (needRequest()) {
         int i = 0;
         NfcAdapterParamPtrC params[4];
@@ -104,9 +113,11 @@ NfcParam::Private::updateRequest()
         if (iLaNfcid1) params[i++] = iLaNfcid1;
         if (iLiAHb) params[i++] = iLiAHb;
         params[i] = Q_NULLPTR;
+        HTRACE2(param_request, i, iReset);
         nfc_default_adapter_param_req_free(iRequest);
         iRequest = nfc_default_adapter_param_req_new(iAdapter, iReset, params);
     } else if (iRequest) {
+        HTRACE(param_release);
         nfc_default_adapter_param_req_free(iRequest);
         iRequest = Q_NULLPTR;
     }
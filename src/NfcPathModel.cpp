@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include <nfcdc_daemon.h>
+#include <nfcdc_default_adapter.h>
+
+#include "NfcIoThread.h"
+#include "NfcPathModel.h"
+#include "NfcSignalTable.h"
+
+#include "Debug.h"
+
+// ==========================================================================
+// NfcPathModel::Private
+// ==========================================================================
+
+class NfcPathModel::Private :
+    public QObject
+{
+    Q_OBJECT
+
+public:
+    Private(NfcPathModel*);
+    ~Private();
+
+    void setKind(Kind);
+    QStringList currentPaths() const;
+    bool applyDiff(const QStringList&);
+    void schedulePathUpdate();
+    static void pathsChanged(NfcDefaultAdapter*, NFC_DEFAULT_ADAPTER_PROPERTY, void*);
+    static void adaptersChanged(NfcDaemonClient*, NFC_DAEMON_PROPERTY, void*);
+
+public Q_SLOTS:
+    void updatePaths();
+
+public:
+    NfcPathModel* iParent;
+    NfcDefaultAdapter* iAdapter;
+    gulong iAdapterEventId;
+    NfcDaemonClient* iDaemon;
+    gulong iDaemonEventId;
+    Kind iKind;
+    bool iUpdatePending;
+    QStringList iPaths;
+};
+
+NfcPathModel::Private::Private(
+    NfcPathModel* aParent) :
+    iParent(aParent),
+    iAdapterEventId(0),
+    iDaemonEventId(0),
+    iKind(Tags),
+    iUpdatePending(false)
+{
+    NfcIoLock lock;
+
+    iAdapter = nfc_default_adapter_new();
+    iDaemon = nfc_daemon_client_new();
+}
+
+NfcPathModel::Private::~Private()
+{
+    NfcIoLock lock;
+
+    nfc_default_adapter_remove_handler(iAdapter, iAdapterEventId);
+    nfc_default_adapter_unref(iAdapter);
+    nfc_daemon_client_remove_handler(iDaemon, iDaemonEventId);
+    nfc_daemon_client_unref(iDaemon);
+}
+
+void
+NfcPathModel::Private::setKind(
+    Kind aKind)
+{
+    NFC_DEFAULT_ADAPTER_PROPERTY property = NFC_DEFAULT_ADAPTER_PROPERTY_ANY;
+
+    switch (aKind) {
+    case Peers:
+        property = NFC_DEFAULT_ADAPTER_PROPERTY_PEERS;
+        break;
+    case Hosts:
+#ifdef NFCDC_VERSION_1_1_0
+        property = NFC_DEFAULT_ADAPTER_PROPERTY_HOSTS;
+#else
+        #pragma message("Please use libgnfcdc 1.1.0 or newer")
+#endif
+        break;
+    case Adapters:
+        break;
+    case Tags:
+    default:
+        property = NFC_DEFAULT_ADAPTER_PROPERTY_TAGS;
+        break;
+    }
+
+    iKind = aKind;
+    nfc_default_adapter_remove_handler(iAdapter, iAdapterEventId);
+    iAdapterEventId = (property == NFC_DEFAULT_ADAPTER_PROPERTY_ANY) ? 0 :
+        nfc_default_adapter_add_property_handler(iAdapter, property,
+            pathsChanged, this);
+    nfc_daemon_client_remove_handler(iDaemon, iDaemonEventId);
+    iDaemonEventId = (aKind != Adapters) ? 0 :
+        nfc_daemon_client_add_property_handler(iDaemon,
+            NFC_DAEMON_PROPERTY_ADAPTERS, adaptersChanged, this);
+}
+
+QStringList
+NfcPathModel::Private::currentPaths() const
+{
+    const char* const* ptr = Q_NULLPTR;
+    QStringList paths;
+
+    switch (iKind) {
+    case Tags:
+        ptr = iAdapter->tags;
+        break;
+    case Peers:
+        ptr = iAdapter->peers;
+        break;
+    case Hosts:
+#ifdef NFCDC_VERSION_1_1_0
+        ptr = iAdapter->hosts;
+#endif
+        break;
+    case Adapters:
+        ptr = iDaemon->adapters;
+        break;
+    }
+
+    while (ptr && *ptr) {
+        const char* path = *ptr++;
+
+        if (path[0]) {
+            paths.append(QString(path));
+        }
+    }
+    return paths;
+}
+
+bool
+NfcPathModel::Private::applyDiff(
+    const QStringList& aPaths)
+{
+    if (iPaths == aPaths) {
+        return false;
+    }
+
+    // Remove the paths which are gone, collapsing adjacent rows into
+    // a single removal
+    for (int i = iPaths.count() - 1; i >= 0;) {
+        if (aPaths.contains(iPaths.at(i))) {
+            i--;
+        } else {
+            int first = i;
+
+            while (first > 0 && !aPaths.contains(iPaths.at(first - 1))) {
+                first--;
+            }
+            iParent->beginRemoveRows(QModelIndex(), first, i);
+            for (int k = i; k >= first; k--) {
+                iPaths.removeAt(k);
+            }
+            iParent->endRemoveRows();
+            i = first - 1;
+        }
+    }
+
+    // The surviving paths are expected to keep their relative order,
+    // in which case it's just a matter of inserting the new ones
+    int pos = 0;
+
+    for (int i = 0; i < aPaths.count() && pos <= iPaths.count();) {
+        if (pos < iPaths.count() && iPaths.at(pos) == aPaths.at(i)) {
+            pos++;
+            i++;
+        } else if (!iPaths.contains(aPaths.at(i))) {
+            int last = i;
+
+            while ((last + 1) < aPaths.count() &&
+                !iPaths.contains(aPaths.at(last + 1))) {
+                last++;
+            }
+            iParent->beginInsertRows(QModelIndex(), pos, pos + last - i);
+            for (int k = i; k <= last; k++) {
+                iPaths.insert(pos++, aPaths.at(k));
+            }
+            iParent->endInsertRows();
+            i = last + 1;
+        } else {
+            break;
+        }
+    }
+
+    if (iPaths != aPaths) {
+        // The order has changed, which isn't supposed to happen
+        HDEBUG("Order changed, resetting the model");
+        iParent->beginResetModel();
+        iPaths = aPaths;
+        iParent->endResetModel();
+    }
+    return true;
+}
+
+void
+NfcPathModel::Private::schedulePathUpdate()
+{
+    // Qt signals should be signalled from the Qt event loop
+    // See https://bugreports.qt.io/browse/QTBUG-18434 for details
+    if (!iUpdatePending) {
+        static const QMetaMethod updatePaths(nfcSlot<Private>(
+            "updatePaths()"));
+
+        iUpdatePending = true;
+        updatePaths.invoke(this, Qt::QueuedConnection);
+    }
+}
+
+/* static */
+void
+NfcPathModel::Private::pathsChanged(
+    NfcDefaultAdapter*,
+    NFC_DEFAULT_ADAPTER_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->schedulePathUpdate();
+}
+
+/* static */
+void
+NfcPathModel::Private::adaptersChanged(
+    NfcDaemonClient*,
+    NFC_DAEMON_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->schedulePathUpdate();
+}
+
+void
+NfcPathModel::Private::updatePaths()
+{
+    const int prevCount = iPaths.count();
+    QStringList paths;
+
+    // The lock is only held while taking the snapshot, the model
+    // signals (and whatever the views do in response) run without it
+    {
+        NfcIoLock lock;
+
+        // Several notifications may be handled by a single update
+        iUpdatePending = false;
+        paths = currentPaths();
+    }
+
+    if (applyDiff(paths)) {
+        HDEBUG(iPaths);
+        if (prevCount != iPaths.count()) {
+            Q_EMIT iParent->countChanged();
+        }
+    }
+}
+
+// ==========================================================================
+// NfcPathModel
+// ==========================================================================
+
+NfcPathModel::NfcPathModel(
+    QObject* aParent) :
+    QAbstractListModel(aParent),
+    iPrivate(new Private(this))
+{
+    NfcIoLock lock;
+
+    iPrivate->setKind(Tags);
+    iPrivate->iPaths = iPrivate->currentPaths();
+}
+
+NfcPathModel::~NfcPathModel()
+{
+    delete iPrivate;
+}
+
+NfcPathModel::Kind
+NfcPathModel::kind() const
+{
+    return iPrivate->iKind;
+}
+
+void
+NfcPathModel::setKind(
+    Kind aKind)
+{
+    if (iPrivate->iKind != aKind) {
+        const int prevCount = iPrivate->iPaths.count();
+        QStringList paths;
+
+        HDEBUG(aKind);
+        {
+            NfcIoLock lock;
+
+            iPrivate->setKind(aKind);
+            paths = iPrivate->currentPaths();
+        }
+        beginResetModel();
+        iPrivate->iPaths = paths;
+        endResetModel();
+        Q_EMIT kindChanged();
+        if (prevCount != iPrivate->iPaths.count()) {
+            Q_EMIT countChanged();
+        }
+    }
+}
+
+int
+NfcPathModel::count() const
+{
+    return iPrivate->iPaths.count();
+}
+
+QStringList
+NfcPathModel::paths() const
+{
+    return iPrivate->iPaths;
+}
+
+QString
+NfcPathModel::get(
+    int aRow) const
+{
+    return iPrivate->iPaths.value(aRow);
+}
+
+QHash<int,QByteArray>
+NfcPathModel::roleNames() const
+{
+    QHash<int,QByteArray> roles;
+
+    roles.insert(PathRole, "path");
+    return roles;
+}
+
+int
+NfcPathModel::rowCount(
+    const QModelIndex& aParent) const
+{
+    return aParent.isValid() ? 0 : iPrivate->iPaths.count();
+}
+
+QVariant
+NfcPathModel::data(
+    const QModelIndex& aIndex,
+    int aRole) const
+{
+    const int row = aIndex.row();
+
+    if (row >= 0 && row < iPrivate->iPaths.count() &&
+        (aRole == PathRole || aRole == Qt::DisplayRole)) {
+        return iPrivate->iPaths.at(row);
+    }
+    return QVariant();
+}
+
+#include "NfcPathModel.moc"
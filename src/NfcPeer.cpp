@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021-2024 Slava Monich <slava@monich.com>
+ * Copyright (C) 2021-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -39,9 +39,13 @@
 
 #include <nfcdc_peer.h>
 
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
 #include "NfcPeer.h"
+#include "NfcSignalTable.h"
 
 #include "Debug.h"
+#include "Trace.h"
 
 // ==========================================================================
 // NfcPeer::Private
@@ -56,7 +60,10 @@ public:
     void setPath(const char*);
     void emitPropertySignal(NFC_PEER_PROPERTY);
 
-    static const char* SIGNAL_NAME[];
+    typedef NfcSignalTable<NfcPeer> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal PROPERTY_SIGNAL[];
+    static const SignalTable& signalTable();
     static void propertyChanged(NfcPeerClient*, NFC_PEER_PROPERTY, void*);
 
 public:
@@ -65,11 +72,11 @@ public:
     gulong iPeerEventId[3]; // Must match number of non-NULLs below:
 };
 
-const char* NfcPeer::Private::SIGNAL_NAME[] = {
-    Q_NULLPTR,          // NFC_PEER_PROPERTY_ANY
-    "validChanged",     // NFC_PEER_PROPERTY_VALID
-    "presentChanged",   // NFC_PEER_PROPERTY_PRESENT
-    "wksChanged",       // NFC_PEER_PROPERTY_WKS
+const NfcPeer::Private::Signal NfcPeer::Private::PROPERTY_SIGNAL[] = {
+    Q_NULLPTR,                 // NFC_PEER_PROPERTY_ANY
+    &NfcPeer::validChanged,    // NFC_PEER_PROPERTY_VALID
+    &NfcPeer::presentChanged,  // NFC_PEER_PROPERTY_PRESENT
+    &NfcPeer::wksChanged,      // NFC_PEER_PROPERTY_WKS
     // Remember to update iPeerEventId count when adding new handlers!
 };
 
@@ -79,13 +86,24 @@ NfcPeer::Private::Private(
     iPeer(Q_NULLPTR)
 {
     memset(iPeerEventId, 0, sizeof(iPeerEventId));
-    Q_STATIC_ASSERT(G_N_ELEMENTS(SIGNAL_NAME) == NFC_PEER_PROPERTY_COUNT);
+    Q_STATIC_ASSERT(G_N_ELEMENTS(PROPERTY_SIGNAL) == NFC_PEER_PROPERTY_COUNT);
 }
 
 NfcPeer::Private::~Private()
 {
+    NfcIoLock lock;
+
     nfc_peer_client_remove_all_handlers(iPeer, iPeerEventId);
-    nfc_peer_client_unref(iPeer);
+    NfcClientPool::get()->releasePeer(iPeer);
+}
+
+/* static */
+const NfcPeer::Private::SignalTable&
+NfcPeer::Private::signalTable()
+{
+    static const SignalTable table(PROPERTY_SIGNAL, NFC_PEER_PROPERTY_COUNT);
+
+    return table;
 }
 
 inline
@@ -95,38 +113,41 @@ NfcPeer::Private::emitPropertySignal(
 {
     // Qt signals should be signalled from the Qt event loop
     // See https://bugreports.qt.io/browse/QTBUG-18434 for details
-    QMetaObject::invokeMethod(iParent, SIGNAL_NAME[aProperty],
-        Qt::QueuedConnection);
+    signalTable().emitQueued(iParent, aProperty);
 }
 
 void
 NfcPeer::Private::setPath(
     const char* aPath)
 {
+    NfcIoLock lock;
     bool changed[NFC_PEER_PROPERTY_COUNT];
     NFC_PEER_PROPERTY p;
     gboolean valid = FALSE;
     gboolean present = FALSE;
     guint wks = 0;
 
+    HTRACE2(peer_path, this, aPath);
     memset(changed, 0, sizeof(changed));
     if (iPeer) {
         valid = iPeer->valid;
         present = iPeer->present;
         wks = iPeer->wks;
         nfc_peer_client_remove_all_handlers(iPeer, iPeerEventId);
-        nfc_peer_client_unref(iPeer);
+        NfcClientPool::get()->releasePeer(iPeer);
         iPeer = Q_NULLPTR;
     }
 
     if (aPath) {
         int k;
 
-        iPeer = nfc_peer_client_new(aPath);
+        const SignalTable& table = signalTable();
+
+        iPeer = NfcClientPool::get()->newPeer(aPath);
         for (p = NFC_PEER_PROPERTY_VALID, k = 0;
              p < NFC_PEER_PROPERTY_COUNT;
              p = NFC_PEER_PROPERTY(p+1)) {
-            if (SIGNAL_NAME[p]) {
+            if (table.contains(p)) {
                 iPeerEventId[k++] =
                     nfc_peer_client_add_property_handler(iPeer, p,
                         propertyChanged, this);
@@ -159,6 +180,7 @@ NfcPeer::Private::propertyChanged(
     NFC_PEER_PROPERTY aProperty,
     void* aPrivate)
 {
+    HTRACE2(peer_property, aPrivate, aProperty);
     ((Private*) aPrivate)->emitPropertySignal(aProperty);
 }
 
@@ -199,23 +221,31 @@ NfcPeer::setPath(
 QString
 NfcPeer::path() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iPeer ? QString(iPrivate->iPeer->path) : QString();
 }
 
 bool
 NfcPeer::valid() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iPeer && iPrivate->iPeer->valid;
 }
 
 bool
 NfcPeer::present() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iPeer && iPrivate->iPeer->present;
 }
 
 uint
 NfcPeer::wks() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iPeer ? iPrivate->iPeer->wks : 0;
 }
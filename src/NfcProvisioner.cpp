@@ -0,0 +1,577 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcProvisioner.h"
+#include "NfcAdapter.h"
+#include "NfcIoThread.h"
+#include "NfcIsoDep.h"
+#include "NfcNdefListener.h"
+#include "NfcSignalTable.h"
+#include "NfcTag.h"
+#include "NfcType2.h"
+
+#include "Debug.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QQueue>
+
+// UID, lock bytes, Capability Container and the beginning of the data
+// area (where the NDEF TLV normally is)
+#define TYPE2_HEADER_PAGES (8)
+
+// Number of tags the throughput is averaged over
+#define THROUGHPUT_WINDOW (16)
+
+// ==========================================================================
+// NfcProvisioner::Private
+//
+// Tag arrival and the per-tag results go through the Qt event loop,
+// everything in between is chained by the NfcNdefListener callbacks,
+// i.e. each step is started from the completion path of the previous
+// one. The state shared with those callbacks is protected by NfcIoLock.
+// ==========================================================================
+
+class NfcProvisioner::Private :
+    public QObject,
+    public NfcNdefListener
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Idle,
+        Detecting,
+        Preparing,
+        Writing,
+        Verifying,
+        Done
+    };
+
+    Private(NfcProvisioner*);
+    ~Private();
+
+    void start();
+    void stop();
+    void begin(const QString&);
+    void detect();
+    void write();
+    void finish(bool);
+    void succeed(qint64);
+    void fail();
+    void updateThroughput();
+    bool busy() const;
+
+    // NfcNdefListener
+    void ndefReadDone(int, const QByteArray&) Q_DECL_OVERRIDE;
+    void ndefWriteDone(int) Q_DECL_OVERRIDE;
+    void ndefVerifyDone(int, bool) Q_DECL_OVERRIDE;
+    void ndefFailed(int) Q_DECL_OVERRIDE;
+
+public Q_SLOTS:
+    void onTagPathChanged();
+    void onTagChanged();
+    void onTagDone(int, bool, qint64);
+
+public:
+    NfcProvisioner* iParent;
+    NfcAdapter* iAdapter;
+    NfcTag* iTag;
+    NfcType2* iType2;
+    NfcIsoDep* iIsoDep;
+    QQueue<QByteArray> iQueue;
+    QQueue<qint64> iCompletions;
+    QElapsedTimer iClock;
+    QString iTagPath;
+    qint64 iTagStart;
+    int iTagId;
+    bool iRunning;
+    bool iVerify;
+    int iProvisioned;
+    int iFailed;
+    qreal iThroughput;
+
+    // Protected by NfcIoLock
+    State iState;
+    NfcTag::Type iType;
+    QByteArray iMessage;
+    bool iVerifyTag;
+    bool iReadAll;
+};
+
+NfcProvisioner::Private::Private(
+    NfcProvisioner* aParent) :
+    QObject(aParent),
+    iParent(aParent),
+    iAdapter(new NfcAdapter(this)),
+    iTag(new NfcTag(this)),
+    iType2(new NfcType2(this)),
+    iIsoDep(new NfcIsoDep(this)),
+    iTagStart(0),
+    iTagId(0),
+    iRunning(false),
+    iVerify(true),
+    iProvisioned(0),
+    iFailed(0),
+    iThroughput(0),
+    iState(Idle),
+    iType(NfcTag::Unknown),
+    iVerifyTag(false),
+    iReadAll(false)
+{
+    iClock.start();
+    // Tag clients get created before tagPathChanged() is delivered
+    iAdapter->setWarmUpTags(true);
+    iType2->setNdefListener(this);
+    iIsoDep->setNdefListener(this);
+    connect(iAdapter, SIGNAL(tagPathChanged()), SLOT(onTagPathChanged()));
+    connect(iTag, SIGNAL(validChanged()), SLOT(onTagChanged()));
+    connect(iTag, SIGNAL(typeChanged()), SLOT(onTagChanged()));
+}
+
+NfcProvisioner::Private::~Private()
+{
+    // The children outlive this part of the object
+    iType2->setNdefListener(Q_NULLPTR);
+    iIsoDep->setNdefListener(Q_NULLPTR);
+}
+
+inline
+bool
+NfcProvisioner::Private::busy() const
+{
+    return iState != Idle && iState != Done;
+}
+
+void
+NfcProvisioner::Private::start()
+{
+    if (!iRunning && !iQueue.isEmpty()) {
+        const bool hadProvisioned = iProvisioned != 0;
+        const bool hadFailed = iFailed != 0;
+        const bool hadThroughput = iThroughput != 0;
+
+        HDEBUG(iQueue.count() << "message(s) queued");
+        iRunning = true;
+        iProvisioned = iFailed = 0;
+        iThroughput = 0;
+        iCompletions.clear();
+        Q_EMIT iParent->runningChanged();
+        if (hadProvisioned) {
+            Q_EMIT iParent->provisionedChanged();
+        }
+        if (hadFailed) {
+            Q_EMIT iParent->failedChanged();
+        }
+        if (hadThroughput) {
+            Q_EMIT iParent->throughputChanged();
+        }
+
+        // The tag may already be there
+        const QString path(iAdapter->tagPath());
+
+        if (!path.isEmpty()) {
+            begin(path);
+        }
+    }
+}
+
+void
+NfcProvisioner::Private::stop()
+{
+    if (iRunning) {
+        NfcIoLock lock;
+
+        HDEBUG("Stopping");
+        iRunning = false;
+        iState = Idle;
+        iTagPath.clear();
+        // This cancels whatever is still pending
+        iTag->setPath(QString());
+        iType2->setPath(QString());
+        iIsoDep->setPath(QString());
+        Q_EMIT iParent->runningChanged();
+    }
+}
+
+void
+NfcProvisioner::Private::begin(
+    const QString& aPath)
+{
+    NfcIoLock lock;
+
+    HDEBUG(aPath);
+    iTagPath = aPath;
+    iTagStart = iClock.elapsed();
+    iTagId++;
+    // Whatever fails now is none of our business
+    iState = Idle;
+    iType2->setPath(QString());
+    iIsoDep->setPath(QString());
+    iState = Detecting;
+    iTag->setPath(aPath);
+    detect();
+}
+
+void
+NfcProvisioner::Private::detect()
+{
+    NfcIoLock lock;
+
+    if (iState == Detecting && iTag->valid()) {
+        // Start fetching the UID, it will be there by the time we're done
+        iTag->uid();
+        iType = iTag->type();
+        iMessage = iQueue.head();
+        iVerifyTag = iVerify;
+        iReadAll = false;
+        switch (iType) {
+        case NfcTag::Type2:
+            // CC and the TLVs preceding the NDEF one are needed first
+            iState = Preparing;
+            iType2->setPath(iTagPath);
+            if (!iType2->read(0, TYPE2_HEADER_PAGES)) {
+                finish(false);
+            }
+            return;
+        case NfcTag::IsoDep:
+            // NdefWriter reads the CC by itself
+            iIsoDep->setPath(iTagPath);
+            write();
+            return;
+        case NfcTag::Unknown:
+            break;
+        }
+        HDEBUG("Unsupported tag" << iTagPath);
+        finish(false);
+    }
+}
+
+void
+NfcProvisioner::Private::write()
+{
+    // Called with NfcIoLock held. A zero id means that nothing has been
+    // started (and nothing is going to be reported), anything else may
+    // complete before the call returns.
+    int id;
+
+    iState = Writing;
+    if (iType == NfcTag::Type2) {
+        id = iType2->writeNdef(iMessage);
+        if (!id && !iReadAll) {
+            // The NDEF TLV may be further away, read everything
+            iReadAll = true;
+            iState = Preparing;
+            id = iType2->readAll();
+        }
+    } else {
+        id = iIsoDep->writeNdef(iMessage);
+    }
+    if (!id) {
+        finish(false);
+    }
+}
+
+void
+NfcProvisioner::Private::finish(
+    bool aOk)
+{
+    static const QMetaMethod tagDone(nfcSlot<Private>(
+        "onTagDone(int,bool,qint64)"));
+
+    // Called with NfcIoLock held, possibly on the I/O thread
+    iState = Done;
+    tagDone.invoke(this, Qt::QueuedConnection, Q_ARG(int, iTagId),
+        Q_ARG(bool, aOk), Q_ARG(qint64, iClock.elapsed()));
+}
+
+void
+NfcProvisioner::Private::succeed(
+    qint64 aTime)
+{
+    const int msec = (int)(aTime - iTagStart);
+
+    HDEBUG(iTagPath << "provisioned in" << msec << "ms");
+    iQueue.dequeue();
+    iProvisioned++;
+    iCompletions.enqueue(aTime);
+    if (iCompletions.count() > THROUGHPUT_WINDOW) {
+        iCompletions.dequeue();
+    }
+    updateThroughput();
+    Q_EMIT iParent->pendingChanged();
+    Q_EMIT iParent->provisionedChanged();
+    Q_EMIT iParent->tagProvisioned(iTagPath, iTag->uid(), msec);
+    if (iQueue.isEmpty()) {
+        stop();
+        Q_EMIT iParent->finished();
+    }
+}
+
+void
+NfcProvisioner::Private::fail()
+{
+    HDEBUG(iTagPath << "failed");
+    iFailed++;
+    Q_EMIT iParent->failedChanged();
+    Q_EMIT iParent->tagFailed(iTagPath, iTag->uid());
+}
+
+void
+NfcProvisioner::Private::updateThroughput()
+{
+    const int n = iCompletions.count();
+    qreal throughput = 0;
+
+    if (n > 1) {
+        const qint64 span = iCompletions.last() - iCompletions.first();
+
+        if (span > 0) {
+            throughput = (n - 1) * 60000.0 / span;
+        }
+    }
+    if (iThroughput != throughput) {
+        iThroughput = throughput;
+        Q_EMIT iParent->throughputChanged();
+    }
+}
+
+void
+NfcProvisioner::Private::ndefReadDone(
+    int,
+    const QByteArray&)
+{
+    if (iState == Preparing) {
+        write();
+    }
+}
+
+void
+NfcProvisioner::Private::ndefWriteDone(
+    int)
+{
+    if (iState == Writing) {
+        if (iVerifyTag) {
+            iState = Verifying;
+            if (!(iType == NfcTag::Type2 ? iType2->verifyNdef() :
+                iIsoDep->verifyNdef())) {
+                finish(false);
+            }
+        } else {
+            finish(true);
+        }
+    }
+}
+
+void
+NfcProvisioner::Private::ndefVerifyDone(
+    int,
+    bool aOk)
+{
+    if (iState == Verifying) {
+        finish(aOk);
+    }
+}
+
+void
+NfcProvisioner::Private::ndefFailed(
+    int)
+{
+    if (busy()) {
+        finish(false);
+    }
+}
+
+void
+NfcProvisioner::Private::onTagPathChanged()
+{
+    const QString path(iAdapter->tagPath());
+
+    if (iRunning && path != iTagPath) {
+        bool gone;
+
+        {
+            NfcIoLock lock;
+
+            gone = busy();
+            iState = Idle;
+        }
+        if (gone) {
+            HDEBUG(iTagPath << "is gone");
+            fail();
+        }
+        iTagPath.clear();
+        if (!path.isEmpty()) {
+            begin(path);
+        }
+    }
+}
+
+void
+NfcProvisioner::Private::onTagChanged()
+{
+    detect();
+}
+
+void
+NfcProvisioner::Private::onTagDone(
+    int aTagId,
+    bool aOk,
+    qint64 aTime)
+{
+    // Ignore the results for the tags which are gone
+    if (iRunning && aTagId == iTagId) {
+        if (aOk) {
+            succeed(aTime);
+        } else {
+            fail();
+        }
+    }
+}
+
+// ==========================================================================
+// NfcProvisioner
+// ==========================================================================
+
+NfcProvisioner::NfcProvisioner(
+    QObject* aParent) :
+    QObject(aParent),
+    iPrivate(new Private(this))
+{
+}
+
+NfcProvisioner::~NfcProvisioner()
+{
+    delete iPrivate;
+}
+
+QString
+NfcProvisioner::path() const
+{
+    return iPrivate->iAdapter->path();
+}
+
+void
+NfcProvisioner::setPath(
+    QString aPath)
+{
+    if (path() != aPath) {
+        HDEBUG(aPath);
+        iPrivate->stop();
+        iPrivate->iAdapter->setPath(aPath);
+        Q_EMIT pathChanged();
+    }
+}
+
+bool
+NfcProvisioner::running() const
+{
+    return iPrivate->iRunning;
+}
+
+bool
+NfcProvisioner::verify() const
+{
+    return iPrivate->iVerify;
+}
+
+void
+NfcProvisioner::setVerify(
+    bool aVerify)
+{
+    if (iPrivate->iVerify != aVerify) {
+        iPrivate->iVerify = aVerify;
+        Q_EMIT verifyChanged();
+    }
+}
+
+int
+NfcProvisioner::pending() const
+{
+    return iPrivate->iQueue.count();
+}
+
+int
+NfcProvisioner::provisioned() const
+{
+    return iPrivate->iProvisioned;
+}
+
+int
+NfcProvisioner::failed() const
+{
+    return iPrivate->iFailed;
+}
+
+qreal
+NfcProvisioner::throughput() const
+{
+    return iPrivate->iThroughput;
+}
+
+void
+NfcProvisioner::enqueue(
+    QByteArray aNdef)
+{
+    iPrivate->iQueue.enqueue(aNdef);
+    Q_EMIT pendingChanged();
+}
+
+void
+NfcProvisioner::clear()
+{
+    if (!iPrivate->iQueue.isEmpty()) {
+        // Can't provision anything without a message
+        iPrivate->stop();
+        iPrivate->iQueue.clear();
+        Q_EMIT pendingChanged();
+    }
+}
+
+void
+NfcProvisioner::start()
+{
+    iPrivate->start();
+}
+
+void
+NfcProvisioner::stop()
+{
+    iPrivate->stop();
+}
+
+#include "NfcProvisioner.moc"
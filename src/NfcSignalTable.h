@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_SIGNAL_TABLE_H
+#define QNFCDC_SIGNAL_TABLE_H
+
+#include "NfcEventTrace.h"
+
+#include <QtCore/QMetaMethod>
+#include <QtCore/QVector>
+
+// Parameterless signals of class T, indexed by libgnfcdc property id.
+// QMetaMethods are resolved once, so that emitting a signal doesn't
+// involve the name lookup which QMetaObject::invokeMethod performs on
+// every call. NULL entries are allowed.
+
+template <class T>
+class NfcSignalTable
+{
+public:
+    typedef void (T::*Signal)();
+
+    NfcSignalTable(const Signal* aSignals, int aCount) :
+        iSignals(aSignals),
+        iMethods(aCount)
+    {
+        for (int i = 0; i < aCount; i++) {
+            if (aSignals[i]) {
+                iMethods[i] = QMetaMethod::fromSignal(aSignals[i]);
+            }
+        }
+    }
+
+    int count() const
+        { return iMethods.count(); }
+    bool contains(int aIndex) const
+        { return iSignals[aIndex] != Q_NULLPTR; }
+
+    // Timestamp of the libgnfcdc callback for NfcEventTrace, to be taken
+    // on entry if anything happens between the callback and emitQueued.
+    // Zero if tracing is off.
+    static qint64 callbackTime()
+        { return NfcEventTrace::callbackTime(); }
+
+    // Qt signals should be signalled from the Qt event loop
+    // See https://bugreports.qt.io/browse/QTBUG-18434 for details
+    void emitQueued(T* aObject, int aIndex, qint64 aTime = 0) const
+    {
+        if (NfcEventTrace::active()) {
+            NfcEventTrace::emitQueued(aObject, iMethods.at(aIndex), aTime);
+        } else {
+            iMethods.at(aIndex).invoke(aObject, Qt::QueuedConnection);
+        }
+    }
+
+    // Must be called on the thread aObject lives in. Traced if the
+    // callback time is known.
+    void emitDirect(T* aObject, int aIndex, qint64 aTime = 0) const
+    {
+        if (aTime && NfcEventTrace::active()) {
+            NfcEventTrace::emitted(iMethods.at(aIndex), aTime);
+        }
+        Q_EMIT (aObject->*iSignals[aIndex])();
+    }
+
+private:
+    const Signal* iSignals;
+    QVector<QMetaMethod> iMethods;
+};
+
+// Slots can't be resolved by pointer, only by the normalized signature.
+// Meant to initialize a static QMetaMethod, i.e. to be called once.
+// Signals with arguments are resolved with QMetaMethod::fromSignal.
+
+template <class T>
+inline
+QMetaMethod
+nfcSlot(
+    const char* aSignature)
+{
+    const QMetaObject* mo = &T::staticMetaObject;
+
+    return mo->method(mo->indexOfSlot(aSignature));
+}
+
+#endif // QNFCDC_SIGNAL_TABLE_H
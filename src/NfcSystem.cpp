@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -39,9 +39,13 @@
 
 #include <nfcdc_daemon.h>
 
+#include "NfcGlibDispatcher.h"
+#include "NfcIoThread.h"
+#include "NfcSignalTable.h"
 #include "NfcSystem.h"
 
 #include "Debug.h"
+#include "Trace.h"
 
 Q_STATIC_ASSERT(NfcSystem::Version_1_0_26 == NFC_DAEMON_VERSION(1,0,26));
 Q_STATIC_ASSERT(NfcSystem::Version_1_1_0 == NFC_DAEMON_VERSION(1,1,0));
@@ -60,51 +64,82 @@ Q_STATIC_ASSERT((int)NfcSystem::NfcA == (int)NFC_TECH_A);
 Q_STATIC_ASSERT((int)NfcSystem::NfcB == (int)NFC_TECH_B);
 Q_STATIC_ASSERT((int)NfcSystem::NfcF == (int)NFC_TECH_F);
 
+#define PROPERTY_BIT(p) (1 << NFC_DAEMON_PROPERTY_##p)
+Q_STATIC_ASSERT(NfcSystem::ValidProperty == PROPERTY_BIT(VALID));
+Q_STATIC_ASSERT(NfcSystem::PresentProperty == PROPERTY_BIT(PRESENT));
+Q_STATIC_ASSERT(NfcSystem::EnabledProperty == PROPERTY_BIT(ENABLED));
+Q_STATIC_ASSERT(NfcSystem::AdaptersProperty == PROPERTY_BIT(ADAPTERS));
+Q_STATIC_ASSERT(NfcSystem::VersionProperty == PROPERTY_BIT(VERSION));
+Q_STATIC_ASSERT(NfcSystem::ModeProperty == PROPERTY_BIT(MODE));
+#ifdef NFCDC_VERSION_1_1_0
+Q_STATIC_ASSERT(NfcSystem::TechsProperty == PROPERTY_BIT(TECHS));
+#endif
+
 // ==========================================================================
 // NfcSystem::Private
 // ==========================================================================
 
-class NfcSystem::Private
+class NfcSystem::Private :
+    public QObject
 {
+    Q_OBJECT
+
 public:
     Private(NfcSystem*);
     ~Private();
 
-    static const char* SIGNAL_NAME[];
+    typedef NfcSignalTable<NfcSystem> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal PROPERTY_SIGNAL[];
+    static const SignalTable& signalTable();
     static void propertyChanged(NfcDaemonClient*, NFC_DAEMON_PROPERTY, void*);
 
+public Q_SLOTS:
+    void flushChanges();
+
 public:
+    NfcSystem* iParent;
     NfcDaemonClient* iDaemon;
-    gulong iDaemonEventId[6]; // Must not be less than the number of non-NULLs:
+    bool iCoalesceChanges;
+    QAtomicInt iPendingChanges;
+    qint64 iPendingTime;  // Protected by NfcIoLock
+    gulong iDaemonEventId[7]; // Must not be less than the number of non-NULLs:
 };
 
-const char* NfcSystem::Private::SIGNAL_NAME[] = {
-    Q_NULLPTR,          // NFC_DAEMON_PROPERTY_ANY
-    "validChanged",     // NFC_DAEMON_PROPERTY_VALID
-    "presentChanged",   // NFC_DAEMON_PROPERTY_PRESENT
-    Q_NULLPTR,          // NFC_DAEMON_PROPERTY_ERROR
-    "enabledChanged",   // NFC_DAEMON_PROPERTY_ENABLED
-    Q_NULLPTR,          // NFC_DAEMON_PROPERTY_ADAPTERS
-    "versionChanged",   // NFC_DAEMON_PROPERTY_VERSION
-    "modeChanged",      // NFC_DAEMON_PROPERTY_MODE
+const NfcSystem::Private::Signal NfcSystem::Private::PROPERTY_SIGNAL[] = {
+    Q_NULLPTR,                    // NFC_DAEMON_PROPERTY_ANY
+    &NfcSystem::validChanged,     // NFC_DAEMON_PROPERTY_VALID
+    &NfcSystem::presentChanged,   // NFC_DAEMON_PROPERTY_PRESENT
+    Q_NULLPTR,                    // NFC_DAEMON_PROPERTY_ERROR
+    &NfcSystem::enabledChanged,   // NFC_DAEMON_PROPERTY_ENABLED
+    &NfcSystem::adaptersChanged,  // NFC_DAEMON_PROPERTY_ADAPTERS
+    &NfcSystem::versionChanged,   // NFC_DAEMON_PROPERTY_VERSION
+    &NfcSystem::modeChanged,      // NFC_DAEMON_PROPERTY_MODE
 #ifdef NFCDC_VERSION_1_1_0
-    "techsChanged"       // NFC_DAEMON_PROPERTY_MODE
+    &NfcSystem::techsChanged,     // NFC_DAEMON_PROPERTY_TECHS
 #endif
     // Remember to update iDaemonEventId count when adding new handlers!
 };
 
 NfcSystem::Private::Private(
     NfcSystem* aParent) :
-    iDaemon(nfc_daemon_client_new())
+    iParent(aParent),
+    iCoalesceChanges(false),
+    iPendingChanges(0),
+    iPendingTime(0)
 {
-    Q_STATIC_ASSERT(G_N_ELEMENTS(NfcSystem::Private::SIGNAL_NAME) ==
+    Q_STATIC_ASSERT(G_N_ELEMENTS(NfcSystem::Private::PROPERTY_SIGNAL) ==
         NFC_DAEMON_PROPERTY_COUNT);
+    const SignalTable& table = signalTable();
+    NfcIoLock lock;
     uint k = 0;
+
+    iDaemon = nfc_daemon_client_new();
     for (uint i = 0; i < NFC_DAEMON_PROPERTY_COUNT; i++) {
-        if (SIGNAL_NAME[i]) {
+        if (table.contains(i)) {
             iDaemonEventId[k++] =
                 nfc_daemon_client_add_property_handler(iDaemon,
-                    (NFC_DAEMON_PROPERTY)i, propertyChanged, aParent);
+                    (NFC_DAEMON_PROPERTY)i, propertyChanged, this);
         }
     }
     HASSERT(k <= G_N_ELEMENTS(iDaemonEventId));
@@ -115,21 +150,76 @@ NfcSystem::Private::Private(
 
 NfcSystem::Private::~Private()
 {
+    NfcIoLock lock;
+
     nfc_daemon_client_remove_all_handlers(iDaemon, iDaemonEventId);
     nfc_daemon_client_unref(iDaemon);
 }
 
+/* static */
+const NfcSystem::Private::SignalTable&
+NfcSystem::Private::signalTable()
+{
+    static const SignalTable table(PROPERTY_SIGNAL,
+        NFC_DAEMON_PROPERTY_COUNT);
+
+    return table;
+}
+
 /* static */
 void
 NfcSystem::Private::propertyChanged(
     NfcDaemonClient*,
     NFC_DAEMON_PROPERTY aProperty,
-    void* aTarget)
+    void* aPrivate)
 {
+    Private* self = (Private*)aPrivate;
+
+    HTRACE1(system_property, aProperty);
+
     // Qt signals should be signalled from the Qt event loop
     // See https://bugreports.qt.io/browse/QTBUG-18434 for details
-    QMetaObject::invokeMethod((QObject*)aTarget, SIGNAL_NAME[aProperty],
-        Qt::QueuedConnection);
+    if (self->iCoalesceChanges) {
+        // Changes may be flushed on another thread
+        if (!self->iPendingChanges.fetchAndOrOrdered(1 << aProperty)) {
+            static const QMetaMethod flushChanges(nfcSlot<Private>(
+                "flushChanges()"));
+
+            self->iPendingTime = SignalTable::callbackTime();
+            flushChanges.invoke(self, Qt::QueuedConnection);
+        }
+    } else {
+        signalTable().emitQueued(self->iParent, aProperty);
+    }
+}
+
+void
+NfcSystem::Private::flushChanges()
+{
+    int mask;
+    qint64 time;
+
+    // Only to pick up the time along with the changes, the signals are
+    // emitted without holding the lock
+    {
+        NfcIoLock lock;
+
+        mask = iPendingChanges.fetchAndStoreOrdered(0);
+        time = iPendingTime;
+        iPendingTime = 0;
+    }
+
+    if (mask) {
+        const SignalTable& table = signalTable();
+
+        HDEBUG("Changes" << mask);
+        for (uint i = 0; i < NFC_DAEMON_PROPERTY_COUNT; i++) {
+            if (mask & (1 << i)) {
+                table.emitDirect(iParent, i, time);
+            }
+        }
+        Q_EMIT iParent->propertiesChanged(mask);
+    }
 }
 
 // ==========================================================================
@@ -158,39 +248,65 @@ NfcSystem::createSingleton(
     return new NfcSystem;
 }
 
+/* static */
+void
+NfcSystem::startIoThread()
+{
+    NfcIoThread::startThread();
+}
+
+/* static */
+bool
+NfcSystem::attachGlibContext()
+{
+    return NfcGlibDispatcher::attach();
+}
+
 bool
 NfcSystem::valid() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iDaemon->valid;
 }
 
 bool
 NfcSystem::present() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iDaemon->present;
 }
 
 bool
 NfcSystem::enabled() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iDaemon->enabled;
 }
 
 int
 NfcSystem::version() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iDaemon->version;
 }
 
 int
 NfcSystem::mode() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iDaemon->mode;
 }
 
 int
 NfcSystem::techs() const
 {
+    NfcIoLock lock;
+
 #ifdef NFCDC_VERSION_1_1_0
     return iPrivate->iDaemon->techs;
 #else
@@ -198,3 +314,39 @@ NfcSystem::techs() const
     return 0;
 #endif
 }
+
+QStringList
+NfcSystem::adapters() const
+{
+    NfcIoLock lock;
+
+    QStringList list;
+
+    for (const char* const* ptr = iPrivate->iDaemon->adapters;
+         ptr && *ptr; ptr++) {
+        list.append(QString(*ptr));
+    }
+    return list;
+}
+
+bool
+NfcSystem::coalesceChanges() const
+{
+    return iPrivate->iCoalesceChanges;
+}
+
+void
+NfcSystem::setCoalesceChanges(
+    bool aCoalesce)
+{
+    NfcIoLock lock;
+
+    if (iPrivate->iCoalesceChanges != aCoalesce) {
+        // Changes which have already been accumulated are still
+        // delivered by the pending flush
+        iPrivate->iCoalesceChanges = aCoalesce;
+        Q_EMIT coalesceChangesChanged();
+    }
+}
+
+#include "NfcSystem.moc"
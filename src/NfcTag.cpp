@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2024 Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 Slava Monich <slava@monich.com>
  * Copyright (C) 2019-2021 Jolla Ltd.
  *
  * You may use this file under the terms of the BSD license as follows:
@@ -41,9 +41,15 @@
 
 #include <gutil_strv.h>
 
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+#include "NfcSignalTable.h"
 #include "NfcTag.h"
+#include "NfcTagIdentity.h"
+#include "NfcTransceiver.h"
 
 #include "Debug.h"
+#include "Trace.h"
 
 enum tag_events {
     TAG_EVENT_VALID,
@@ -52,11 +58,21 @@ enum tag_events {
     TAG_EVENT_COUNT
 };
 
+enum tag_signals {
+    TAG_SIGNAL_VALID,
+    TAG_SIGNAL_PRESENT,
+    TAG_SIGNAL_TYPE,
+    TAG_SIGNAL_IDENTITY,
+    TAG_SIGNAL_COUNT
+};
+
 // ==========================================================================
 // NfcTag::Private
 // ==========================================================================
 
-class NfcTag::Private
+class NfcTag::Private :
+    public NfcTransceiver::Listener,
+    public NfcTagIdentity::Listener
 {
 public:
     Private(NfcTag*);
@@ -66,25 +82,45 @@ public:
     bool updateType();
     void updateTypeAndEmitSignal();
 
-    void emitValidChanged();
-    void emitPresentChanged();
-    void emitTypeChanged();
+    typedef NfcSignalTable<NfcTag> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal SIGNAL_TABLE[];
+    static const SignalTable& signalTable();
+    void emitQueued(tag_signals);
 
     static void validChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
     static void presentChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
     static void interfacesChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
 
+    // NfcTransceiver::Listener
+    void transceiveDone(int, const GUtilData*, qint64) Q_DECL_OVERRIDE;
+    void transceiveFailed(int) Q_DECL_OVERRIDE;
+
+    // NfcTagIdentity::Listener
+    void identityFetched() Q_DECL_OVERRIDE;
+
 public:
     NfcTag* iParent;
     NfcTagClient* iTag;
     gulong iTagEventId[TAG_EVENT_COUNT];
+    NfcTransceiver iTransceiver;
+    NfcTagIdentity iIdentity;
     Type iType;
 };
 
+const NfcTag::Private::Signal NfcTag::Private::SIGNAL_TABLE[] = {
+    &NfcTag::validChanged,    // TAG_SIGNAL_VALID
+    &NfcTag::presentChanged,  // TAG_SIGNAL_PRESENT
+    &NfcTag::typeChanged,     // TAG_SIGNAL_TYPE
+    &NfcTag::identityChanged  // TAG_SIGNAL_IDENTITY
+};
+
 NfcTag::Private::Private(
     NfcTag* aParent) :
     iParent(aParent),
     iTag(Q_NULLPTR),
+    iTransceiver(this),
+    iIdentity(this),
     iType(Unknown)
 {
     memset(iTagEventId, 0, sizeof(iTagEventId));
@@ -93,17 +129,20 @@ NfcTag::Private::Private(
 NfcTag::Private::~Private()
 {
     nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
-    nfc_tag_client_unref(iTag);
+    NfcClientPool::get()->releaseTag(iTag);
 }
 
 void
 NfcTag::Private::setPath(
     const char* aPath)
 {
+    NfcIoLock lock;
+
+    HTRACE2(tag_path, this, aPath);
     nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
-    nfc_tag_client_unref(iTag);
+    NfcClientPool::get()->releaseTag(iTag);
     if (aPath) {
-        iTag = nfc_tag_client_new(aPath);
+        iTag = NfcClientPool::get()->newTag(aPath);
         iTagEventId[TAG_EVENT_VALID] =
             nfc_tag_client_add_property_handler(iTag,
                 NFC_TAG_PROPERTY_VALID, validChanged, this);
@@ -116,6 +155,8 @@ NfcTag::Private::setPath(
     } else {
         iTag = Q_NULLPTR;
     }
+    iTransceiver.setTag(iTag);
+    iIdentity.setPath(aPath);
     updateType();
 }
 
@@ -144,28 +185,52 @@ NfcTag::Private::updateType()
 // Qt signals should be signalled from the Qt event loop
 // See https://bugreports.qt.io/browse/QTBUG-18434 for details
 
+/* static */
+const NfcTag::Private::SignalTable&
+NfcTag::Private::signalTable()
+{
+    Q_STATIC_ASSERT(G_N_ELEMENTS(SIGNAL_TABLE) == TAG_SIGNAL_COUNT);
+    static const SignalTable table(SIGNAL_TABLE, TAG_SIGNAL_COUNT);
+
+    return table;
+}
+
 inline
 void
-NfcTag::Private::emitValidChanged()
+NfcTag::Private::emitQueued(
+    tag_signals aSignal)
 {
-    QMetaObject::invokeMethod(iParent, "validChanged",
-        Qt::QueuedConnection);
+    signalTable().emitQueued(iParent, aSignal);
+}
+
+void
+NfcTag::Private::transceiveDone(
+    int aId,
+    const GUtilData* aResponse,
+    qint64 aNanoseconds)
+{
+    static const QMetaMethod signal(QMetaMethod::fromSignal(&NfcTag::
+        transceiveDone));
+
+    signal.invoke(iParent, Qt::QueuedConnection, Q_ARG(int, aId),
+        Q_ARG(QByteArray, QByteArray((char*)aResponse->bytes,
+        aResponse->size)), Q_ARG(qint64, aNanoseconds / 1000));
 }
 
-inline
 void
-NfcTag::Private::emitPresentChanged()
+NfcTag::Private::transceiveFailed(
+    int aId)
 {
-    QMetaObject::invokeMethod(iParent, "presentChanged",
-        Qt::QueuedConnection);
+    static const QMetaMethod signal(QMetaMethod::fromSignal(&NfcTag::
+        transceiveFailed));
+
+    signal.invoke(iParent, Qt::QueuedConnection, Q_ARG(int, aId));
 }
 
-inline
 void
-NfcTag::Private::emitTypeChanged()
+NfcTag::Private::identityFetched()
 {
-    QMetaObject::invokeMethod(iParent, "typeChanged",
-        Qt::QueuedConnection);
+    emitQueued(TAG_SIGNAL_IDENTITY);
 }
 
 inline
@@ -173,7 +238,7 @@ void
 NfcTag::Private::updateTypeAndEmitSignal()
 {
     if (updateType()) {
-        emitTypeChanged();
+        emitQueued(TAG_SIGNAL_TYPE);
     }
 }
 
@@ -181,16 +246,17 @@ NfcTag::Private::updateTypeAndEmitSignal()
 void
 NfcTag::Private::validChanged(
     NfcTagClient* aTag,
-    NFC_TAG_PROPERTY,
+    NFC_TAG_PROPERTY aProperty,
     void* aPrivate)
 {
     Private* self = (Private*)aPrivate;
 
+    HTRACE2(tag_property, self, aProperty);
     if (aTag->valid) {
         self->updateTypeAndEmitSignal();
-        self->emitValidChanged();
+        self->emitQueued(TAG_SIGNAL_VALID);
     } else {
-        self->emitValidChanged();
+        self->emitQueued(TAG_SIGNAL_VALID);
         self->updateTypeAndEmitSignal();
     }
 }
@@ -199,22 +265,24 @@ NfcTag::Private::validChanged(
 void
 NfcTag::Private::presentChanged(
     NfcTagClient*,
-    NFC_TAG_PROPERTY,
+    NFC_TAG_PROPERTY aProperty,
     void* aPrivate)
 {
     Private* self = (Private*)aPrivate;
 
+    HTRACE2(tag_property, self, aProperty);
     self->updateTypeAndEmitSignal();
-    self->emitPresentChanged();
+    self->emitQueued(TAG_SIGNAL_PRESENT);
 }
 
 /* static */
 void
 NfcTag::Private::interfacesChanged(
     NfcTagClient*,
-    NFC_TAG_PROPERTY,
+    NFC_TAG_PROPERTY aProperty,
     void* aPrivate)
 {
+    HTRACE2(tag_property, aPrivate, aProperty);
     ((Private*)aPrivate)->updateTypeAndEmitSignal();
 }
 
@@ -231,6 +299,8 @@ NfcTag::NfcTag(
 
 NfcTag::~NfcTag()
 {
+    NfcIoLock lock;
+
     delete iPrivate;
 }
 
@@ -243,6 +313,7 @@ NfcTag::setPath(QString aPath)
         const bool wasValid = valid();
         const bool wasPresent = present();
         const Type prevType = type();
+        const bool hadIdentity = iPrivate->iIdentity.known();
 
         HDEBUG(aPath);
         if (aPath.isEmpty()) {
@@ -263,6 +334,9 @@ NfcTag::setPath(QString aPath)
         if (prevType != type()) {
             Q_EMIT typeChanged();
         }
+        if (hadIdentity) {
+            Q_EMIT identityChanged();
+        }
         if (valid() && !wasValid) {
             // valid has become true
             Q_EMIT validChanged();
@@ -273,23 +347,95 @@ NfcTag::setPath(QString aPath)
 QString
 NfcTag::path() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iTag ? QString(iPrivate->iTag->path) : QString();
 }
 
 bool
 NfcTag::valid() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iTag && iPrivate->iTag->valid;
 }
 
 bool
 NfcTag::present() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iTag && iPrivate->iTag->present;
 }
 
 NfcTag::Type
 NfcTag::type() const
 {
+    NfcIoLock lock;
+
     return iPrivate->iType;
 }
+
+int
+NfcTag::technology() const
+{
+    NfcIoLock lock;
+
+    iPrivate->iIdentity.fetch();
+    return iPrivate->iIdentity.technology();
+}
+
+int
+NfcTag::protocol() const
+{
+    NfcIoLock lock;
+
+    iPrivate->iIdentity.fetch();
+    return iPrivate->iIdentity.protocol();
+}
+
+int
+NfcTag::tagType() const
+{
+    NfcIoLock lock;
+
+    iPrivate->iIdentity.fetch();
+    return iPrivate->iIdentity.type();
+}
+
+QByteArray
+NfcTag::uid() const
+{
+    NfcIoLock lock;
+
+    iPrivate->iIdentity.fetch();
+    return iPrivate->iIdentity.uid();
+}
+
+QByteArray
+NfcTag::pollParameter(
+    QString aName) const
+{
+    NfcIoLock lock;
+
+    iPrivate->iIdentity.fetch();
+    return iPrivate->iIdentity.pollParameter(aName.toLatin1());
+}
+
+int
+NfcTag::transceive(
+    QByteArray aData)
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTransceiver.transceive(aData);
+}
+
+bool
+NfcTag::cancelTransceive(
+    int aId)
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTransceiver.cancel(aId);
+}
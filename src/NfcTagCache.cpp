@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcTagCache.h"
+
+#include "Debug.h"
+
+#include <QtCore/QMutexLocker>
+
+#define DEFAULT_CAPACITY (32)
+
+// ==========================================================================
+// NfcTagCache
+// ==========================================================================
+
+NfcTagCache::NfcTagCache() :
+    iCapacity(DEFAULT_CAPACITY)
+{
+}
+
+/* static */
+NfcTagCache*
+NfcTagCache::get()
+{
+    static NfcTagCache cache;
+
+    return &cache;
+}
+
+/* static */
+QByteArray
+NfcTagCache::key(
+    Tech aTech,
+    const QByteArray& aUid)
+{
+    QByteArray key;
+
+    key.reserve(aUid.size() + 1);
+    key.append((char)aTech);
+    key.append(aUid);
+    return key;
+}
+
+bool
+NfcTagCache::lookup(
+    Tech aTech,
+    const QByteArray& aUid,
+    int aTtlMs,
+    Entry* aEntry)
+{
+    const QByteArray k(key(aTech, aUid));
+    QMutexLocker lock(&iMutex);
+    QHash<QByteArray,Entry>::const_iterator it = iEntries.constFind(k);
+
+    if (it != iEntries.constEnd()) {
+        if (it.value().iTime.hasExpired(aTtlMs)) {
+            HDEBUG(aUid.toHex() << "expired");
+            iEntries.remove(k);
+            iLru.removeOne(k);
+        } else {
+            const int pos = iLru.indexOf(k);
+
+            if (pos > 0) {
+                iLru.move(pos, 0);
+            }
+            HDEBUG(aUid.toHex() << "found");
+            *aEntry = it.value();
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+NfcTagCache::insert(
+    Tech aTech,
+    const QByteArray& aUid,
+    const QByteArray& aData,
+    const NfcNdefMessage& aNdef)
+{
+    QMutexLocker lock(&iMutex);
+
+    if (iCapacity > 0) {
+        const QByteArray k(key(aTech, aUid));
+        Entry& entry = iEntries[k];
+
+        HDEBUG(aUid.toHex() << aData.size() << "bytes");
+        entry.iData = aData;
+        entry.iNdef = aNdef;
+        entry.iTime.start();
+        iLru.removeOne(k);
+        iLru.prepend(k);
+        shrink(iCapacity);
+    }
+}
+
+void
+NfcTagCache::remove(
+    Tech aTech,
+    const QByteArray& aUid)
+{
+    const QByteArray k(key(aTech, aUid));
+    QMutexLocker lock(&iMutex);
+
+    if (iEntries.remove(k)) {
+        iLru.removeOne(k);
+    }
+}
+
+int
+NfcTagCache::capacity() const
+{
+    QMutexLocker lock(&iMutex);
+
+    return iCapacity;
+}
+
+void
+NfcTagCache::setCapacity(
+    int aCapacity)
+{
+    QMutexLocker lock(&iMutex);
+
+    iCapacity = qMax(aCapacity, 0);
+    shrink(iCapacity);
+}
+
+void
+NfcTagCache::shrink(
+    int aCapacity)
+{
+    while (iLru.count() > aCapacity) {
+        iEntries.remove(iLru.takeLast());
+    }
+}
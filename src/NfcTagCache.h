@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TAG_CACHE_H
+#define QNFCDC_TAG_CACHE_H
+
+#include "NfcNdefMessage.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+
+// Internal process-wide LRU cache of tag contents, keyed by UID and
+// technology. NfcIoLock doesn't serialize anything unless the I/O thread
+// is running, and the capacity is set by a static NfcType2 method which
+// may be called on any thread, so the cache has its own lock. Entries
+// are copied out (the data are implicitly shared).
+
+class NfcTagCache
+{
+    Q_DISABLE_COPY(NfcTagCache)
+    NfcTagCache();
+
+public:
+    enum Tech {
+        Type2
+    };
+
+    class Entry {
+    public:
+        QByteArray iData;
+        NfcNdefMessage iNdef;
+        QElapsedTimer iTime;
+    };
+
+    static NfcTagCache* get();
+
+    bool lookup(Tech, const QByteArray&, int, Entry*);
+    void insert(Tech, const QByteArray&, const QByteArray&,
+        const NfcNdefMessage&);
+    void remove(Tech, const QByteArray&);
+
+    int capacity() const;
+    void setCapacity(int);
+
+private:
+    static QByteArray key(Tech, const QByteArray&);
+    void shrink(int);
+
+private:
+    mutable QMutex iMutex;
+    QHash<QByteArray,Entry> iEntries;
+    QList<QByteArray> iLru; // Most recently used first
+    int iCapacity;
+};
+
+#endif // QNFCDC_TAG_CACHE_H
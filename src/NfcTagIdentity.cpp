@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcTagIdentity.h"
+
+#include "Debug.h"
+
+#define NFCD_SERVICE "org.sailfishos.nfc.daemon"
+#define NFCD_TAG_INTERFACE "org.sailfishos.nfc.Tag"
+
+#define IDENTITY_RETRY_INTERVAL (1000000) // microseconds
+
+// Poll parameters which carry the UID, for NFC-A and NFC-B
+static const char* const UID_PARAMETERS[] = { "NFCID1", "NFCID0" };
+
+// GetAll3 isn't supported by older versions of nfcd. Only touched on
+// the thread running the NFC callbacks (or with NfcIoLock held).
+static bool gGetAll3Missing = false;
+
+// ==========================================================================
+// NfcTagIdentity::Fetch
+// ==========================================================================
+
+class NfcTagIdentity::Fetch
+{
+public:
+    Fetch(NfcTagIdentity*);
+    ~Fetch();
+
+public:
+    NfcTagIdentity* iOwner; // Zero if the fetch has been abandoned
+    GCancellable* iCancel;
+    GDBusConnection* iBus;
+    bool iGetAll3;
+};
+
+NfcTagIdentity::Fetch::Fetch(
+    NfcTagIdentity* aOwner) :
+    iOwner(aOwner),
+    iCancel(g_cancellable_new()),
+    iBus(Q_NULLPTR),
+    iGetAll3(false)
+{
+}
+
+NfcTagIdentity::Fetch::~Fetch()
+{
+    if (iBus) {
+        g_object_unref(iBus);
+    }
+    g_object_unref(iCancel);
+}
+
+// ==========================================================================
+// NfcTagIdentity
+// ==========================================================================
+
+NfcTagIdentity::NfcTagIdentity(
+    Listener* aListener) :
+    iListener(aListener),
+    iFetch(Q_NULLPTR),
+    iFailTime(0),
+    iKnown(false),
+    iTechnology(0),
+    iProtocol(0),
+    iType(0)
+{
+}
+
+NfcTagIdentity::~NfcTagIdentity()
+{
+    reset();
+}
+
+void
+NfcTagIdentity::reset()
+{
+    if (iFetch) {
+        // The callbacks won't find their owner anymore
+        iFetch->iOwner = Q_NULLPTR;
+        g_cancellable_cancel(iFetch->iCancel);
+        iFetch = Q_NULLPTR;
+    }
+    iFailTime = 0;
+    iKnown = false;
+    iTechnology = 0;
+    iProtocol = 0;
+    iType = 0;
+    iPollParameters.clear();
+}
+
+void
+NfcTagIdentity::setPath(
+    const char* aPath)
+{
+    reset();
+    iPath = QByteArray(aPath);
+}
+
+void
+NfcTagIdentity::fetch()
+{
+    if (!iKnown && !iFetch && !iPath.isEmpty() && (!iFailTime ||
+        (g_get_monotonic_time() - iFailTime) >= IDENTITY_RETRY_INTERVAL)) {
+        HDEBUG(iPath.constData());
+        iFetch = new Fetch(this);
+
+        // libgnfcdc has already connected to the bus, so this doesn't
+        // block and completes on the next iteration of the event loop
+        g_bus_get(G_BUS_TYPE_SYSTEM, iFetch->iCancel, busReady, iFetch);
+    }
+}
+
+/* static */
+void
+NfcTagIdentity::busReady(
+    GObject*,
+    GAsyncResult* aResult,
+    gpointer aFetch)
+{
+    Fetch* fetch = (Fetch*)aFetch;
+    GError* error = Q_NULLPTR;
+
+    fetch->iBus = g_bus_get_finish(aResult, &error);
+    if (fetch->iBus) {
+        if (fetch->iOwner) {
+            startCall(fetch);
+            return;
+        }
+    } else {
+        HDEBUG(error->message);
+        g_error_free(error);
+    }
+    finish(fetch, false);
+}
+
+/* static */
+void
+NfcTagIdentity::startCall(
+    Fetch* aFetch)
+{
+    // Everything comes in one reply
+    aFetch->iGetAll3 = !gGetAll3Missing;
+    g_dbus_connection_call(aFetch->iBus, NFCD_SERVICE,
+        aFetch->iOwner->iPath.constData(), NFCD_TAG_INTERFACE,
+        aFetch->iGetAll3 ? "GetAll3" : "GetAll", Q_NULLPTR, Q_NULLPTR,
+        G_DBUS_CALL_FLAGS_NONE, -1, aFetch->iCancel, callDone, aFetch);
+}
+
+/* static */
+void
+NfcTagIdentity::callDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aFetch)
+{
+    Fetch* fetch = (Fetch*)aFetch;
+    GError* error = Q_NULLPTR;
+    GVariant* ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(aBus),
+        aResult, &error);
+
+    if (ret) {
+        const bool ok = fetch->iOwner && fetch->iOwner->parse(ret);
+
+        g_variant_unref(ret);
+        finish(fetch, ok);
+    } else {
+        HDEBUG(error->message);
+        if (fetch->iGetAll3 && g_error_matches(error, G_DBUS_ERROR,
+            G_DBUS_ERROR_UNKNOWN_METHOD)) {
+            // Older nfcd, no poll parameters
+            gGetAll3Missing = true;
+            if (fetch->iOwner) {
+                g_error_free(error);
+                startCall(fetch);
+                return;
+            }
+        }
+        g_error_free(error);
+        finish(fetch, false);
+    }
+}
+
+/* static */
+void
+NfcTagIdentity::finish(
+    Fetch* aFetch,
+    bool aOk)
+{
+    NfcTagIdentity* self = aFetch->iOwner;
+
+    delete aFetch;
+    if (self) {
+        self->iFetch = Q_NULLPTR;
+        if (aOk) {
+            self->iKnown = true;
+            self->iListener->identityFetched();
+        } else {
+            // Try again on the next access
+            self->iFailTime = g_get_monotonic_time();
+        }
+    }
+}
+
+bool
+NfcTagIdentity::parse(
+    GVariant* aReply)
+{
+    if (g_variant_is_of_type(aReply, G_VARIANT_TYPE("(ibuuuasaoa{sv})"))) {
+        GVariant* dict = Q_NULLPTR;
+
+        g_variant_get(aReply, "(ibuuuasao@a{sv})", Q_NULLPTR, Q_NULLPTR,
+            &iTechnology, &iProtocol, &iType, Q_NULLPTR, Q_NULLPTR, &dict);
+        setPollParameters(dict);
+        g_variant_unref(dict);
+        return true;
+    } else if (g_variant_is_of_type(aReply, G_VARIANT_TYPE("(ibuuuasao)"))) {
+        g_variant_get(aReply, "(ibuuuasao)", Q_NULLPTR, Q_NULLPTR,
+            &iTechnology, &iProtocol, &iType, Q_NULLPTR, Q_NULLPTR);
+        return true;
+    } else {
+        HDEBUG("Unexpected reply" << g_variant_get_type_string(aReply));
+        return false;
+    }
+}
+
+void
+NfcTagIdentity::setPollParameters(
+    GVariant* aDict)
+{
+    GVariantIter it;
+    const char* name;
+    GVariant* value;
+
+    // Binary parameters are byte arrays, nothing else is expected
+    g_variant_iter_init(&it, aDict);
+    while (g_variant_iter_next(&it, "{&sv}", &name, &value)) {
+        if (g_variant_is_of_type(value, G_VARIANT_TYPE_BYTESTRING)) {
+            gsize size = 0;
+            const void* data = g_variant_get_fixed_array(value, &size, 1);
+
+            iPollParameters.insert(QByteArray(name),
+                QByteArray((const char*)data, (int)size));
+        }
+        g_variant_unref(value);
+    }
+}
+
+bool
+NfcTagIdentity::known() const
+{
+    return iKnown;
+}
+
+uint
+NfcTagIdentity::technology() const
+{
+    return iTechnology;
+}
+
+uint
+NfcTagIdentity::protocol() const
+{
+    return iProtocol;
+}
+
+uint
+NfcTagIdentity::type() const
+{
+    return iType;
+}
+
+QByteArray
+NfcTagIdentity::uid() const
+{
+    for (uint i = 0; i < G_N_ELEMENTS(UID_PARAMETERS); i++) {
+        const QByteArray uid(iPollParameters.value(UID_PARAMETERS[i]));
+
+        if (!uid.isEmpty()) {
+            return uid;
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray
+NfcTagIdentity::pollParameter(
+    const QByteArray& aName) const
+{
+    return iPollParameters.value(aName);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TAG_IDENTITY_H
+#define QNFCDC_TAG_IDENTITY_H
+
+#include <gio/gio.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+
+// Internal helper which fetches tag identification data (technology,
+// protocol, tag type and poll parameters) straight from nfcd, because
+// NfcTagClient doesn't provide it. Nothing is fetched until fetch() is
+// called, and then it takes a single GetAll3 call (or GetAll if nfcd is
+// too old to have poll parameters). If that fails, the identity remains
+// unknown and fetch() tries again, but not more often than once a
+// second.
+//
+// The listener is invoked from the D-Bus completion callback, on the
+// thread running the NFC callbacks.
+
+class NfcTagIdentity
+{
+    Q_DISABLE_COPY(NfcTagIdentity)
+
+public:
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        virtual void identityFetched() = 0;
+    };
+
+    NfcTagIdentity(Listener*);
+    ~NfcTagIdentity();
+
+    void setPath(const char*);
+    void fetch();
+    bool known() const;
+
+    uint technology() const;
+    uint protocol() const;
+    uint type() const;
+    QByteArray uid() const;
+    QByteArray pollParameter(const QByteArray&) const;
+
+private:
+    class Fetch;
+
+    void reset();
+    void setPollParameters(GVariant*);
+    bool parse(GVariant*);
+    static void startCall(Fetch*);
+    static void busReady(GObject*, GAsyncResult*, gpointer);
+    static void callDone(GObject*, GAsyncResult*, gpointer);
+    static void finish(Fetch*, bool);
+
+private:
+    Listener* iListener;
+    QByteArray iPath;
+    Fetch* iFetch;
+    gint64 iFailTime;
+    bool iKnown;
+    uint iTechnology;
+    uint iProtocol;
+    uint iType;
+    QHash<QByteArray,QByteArray> iPollParameters;
+};
+
+#endif // QNFCDC_TAG_IDENTITY_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024-2025 Slava Monich <slava@monich.com>
+ * Copyright (C) 2024-2026 Slava Monich <slava@monich.com>
  *
  * You may use this file under the terms of the BSD license as follows:
  *
@@ -38,8 +38,11 @@
 
 #include <nfcdc_daemon.h>
 
+#include "NfcIoThread.h"
 #include "NfcTech.h"
 
+#include "Trace.h"
+
 // This requires libgnfcdc 1.1.0 or newer
 #ifdef NFCDC_VERSION_1_1_0
 
@@ -65,16 +68,20 @@ public:
 };
 
 NfcTech::Private::Private() :
-    iDaemon(nfc_daemon_client_new()),
     iRequest(Q_NULLPTR),
     iAllowTechs(NFC_TECH_NONE),
     iDisallowTechs(NFC_TECH_NONE),
     iActive(false)
 {
+    NfcIoLock lock;
+
+    iDaemon = nfc_daemon_client_new();
 }
 
 NfcTech::Private::~Private()
 {
+    NfcIoLock lock;
+
     nfc_tech_request_free(iRequest);
     nfc_daemon_client_unref(iDaemon);
 }
@@ -89,6 +96,8 @@ NfcTech::Private::needRequest() const
 void
 NfcTech::Private::updateRequest()
 {
+    NfcIoLock lock;
+
     if (needRequest()) {
         // Create new request before disposing of the old one, so that
         // RequestTechs D-Bus call gets issued before ReleaseTechs.
@@ -96,9 +105,12 @@ NfcTech::Private::updateRequest()
         // the nfcd side.
         NfcTechRequest* req = nfc_tech_request_new(iDaemon, iAllowTechs,
             iDisallowTechs);
+
+        HTRACE2(tech_request, iAllowTechs, iDisallowTechs);
         nfc_tech_request_free(iRequest);
         iRequest = req;
     } else if (iRequest) {
+        HTRACE(tech_release);
         nfc_tech_request_free(iRequest);
         iRequest = Q_NULLPTR;
     }
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcTransceiver.h"
+
+#include "Debug.h"
+#include "Trace.h"
+
+#include <QtCore/QElapsedTimer>
+
+// ==========================================================================
+// NfcTransceiver::Request
+// ==========================================================================
+
+class NfcTransceiver::Request
+{
+public:
+    Request(NfcTransceiver*, int, const QByteArray&);
+    ~Request();
+
+public:
+    NfcTransceiver* iOwner; // Zero if the request has been abandoned
+    const int iId;
+    const QByteArray iData;
+    GUtilData iBytes;
+    GCancellable* iCancel;
+    QElapsedTimer iTimer;
+};
+
+NfcTransceiver::Request::Request(
+    NfcTransceiver* aOwner,
+    int aId,
+    const QByteArray& aData) :
+    iOwner(aOwner),
+    iId(aId),
+    iData(aData),
+    iCancel(g_cancellable_new())
+{
+    iBytes.bytes = (const guint8*) iData.constData();
+    iBytes.size = iData.size();
+}
+
+NfcTransceiver::Request::~Request()
+{
+    g_object_unref(iCancel);
+}
+
+// ==========================================================================
+// NfcTransceiver
+// ==========================================================================
+
+NfcTransceiver::NfcTransceiver(
+    Listener* aListener) :
+    iListener(aListener),
+    iTag(Q_NULLPTR),
+    iValidId(0),
+    iActive(Q_NULLPTR),
+    iLastId(0)
+{
+}
+
+NfcTransceiver::~NfcTransceiver()
+{
+    abandon(false);
+    nfc_tag_client_remove_handler(iTag, iValidId);
+    nfc_tag_client_unref(iTag);
+}
+
+void
+NfcTransceiver::setTag(
+    NfcTagClient* aTag)
+{
+    if (iTag != aTag) {
+        nfc_tag_client_remove_handler(iTag, iValidId);
+        nfc_tag_client_unref(iTag);
+        if (aTag) {
+            iTag = nfc_tag_client_ref(aTag);
+            iValidId = nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_VALID, validChanged, this);
+        } else {
+            iTag = Q_NULLPTR;
+            iValidId = 0;
+        }
+        // Whatever was queued was meant for the other tag
+        abandon(true);
+    }
+}
+
+int
+NfcTransceiver::transceive(
+    const QByteArray& aData)
+{
+    if (iTag && !aData.isEmpty()) {
+        // Zero is never a valid id
+        const int id = iLastId = (iLastId < G_MAXINT) ? (iLastId + 1) : 1;
+        Request* req = new Request(this, id, aData);
+
+        if (iActive || !iQueue.isEmpty() || !iTag->valid) {
+            iQueue.enqueue(req);
+        } else if (!start(req)) {
+            // The caller is told right away, no callback
+            delete req;
+            return 0;
+        }
+        return id;
+    }
+    return 0;
+}
+
+bool
+NfcTransceiver::cancel(
+    int aId)
+{
+    if (iActive && iActive->iId == aId) {
+        iActive->iOwner = Q_NULLPTR;
+        g_cancellable_cancel(iActive->iCancel);
+        iActive = Q_NULLPTR;
+        submit();
+        return true;
+    } else {
+        const int n = iQueue.count();
+
+        for (int i = 0; i < n; i++) {
+            Request* req = iQueue.at(i);
+
+            if (req->iId == aId) {
+                iQueue.removeAt(i);
+                delete req;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void
+NfcTransceiver::cancelAll()
+{
+    abandon(false);
+}
+
+bool
+NfcTransceiver::busy() const
+{
+    return iActive || !iQueue.isEmpty();
+}
+
+void
+NfcTransceiver::abandon(
+    bool aNotify)
+{
+    QList<int> failed;
+
+    if (iActive) {
+        // The callback won't find its owner anymore
+        failed.append(iActive->iId);
+        iActive->iOwner = Q_NULLPTR;
+        g_cancellable_cancel(iActive->iCancel);
+        iActive = Q_NULLPTR;
+    }
+    while (!iQueue.isEmpty()) {
+        Request* req = iQueue.dequeue();
+
+        failed.append(req->iId);
+        delete req;
+    }
+    if (aNotify) {
+        const int n = failed.count();
+
+        for (int i = 0; i < n; i++) {
+            iListener->transceiveFailed(failed.at(i));
+        }
+    }
+}
+
+bool
+NfcTransceiver::start(
+    Request* aRequest)
+{
+#ifdef NFCDC_VERSION_1_2_0
+    aRequest->iTimer.start();
+    if (nfc_tag_client_transceive(iTag, &aRequest->iBytes,
+        aRequest->iCancel, requestDone, aRequest, requestDestroy)) {
+        HTRACE3(transceive_start, iTag->path, aRequest->iId,
+            aRequest->iData.size());
+        HVERBOSE(aRequest->iId << aRequest->iData.toHex());
+        iActive = aRequest;
+        return true;
+    }
+#else
+#pragma message("Please use libgnfcdc 1.2.0 or newer")
+#endif
+    HDEBUG("Failed to submit" << aRequest->iId);
+    return false;
+}
+
+void
+NfcTransceiver::submit()
+{
+    while (!iActive && iTag && iTag->valid && !iQueue.isEmpty()) {
+        Request* req = iQueue.dequeue();
+
+        if (!start(req)) {
+            const int id = req->iId;
+
+            delete req;
+            iListener->transceiveFailed(id);
+        }
+    }
+}
+
+/* static */
+void
+NfcTransceiver::validChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aSelf)
+{
+    // Flush the frames queued while the tag wasn't ready
+    ((NfcTransceiver*)aSelf)->submit();
+}
+
+/* static */
+void
+NfcTransceiver::requestDone(
+    NfcTagClient*,
+    const GUtilData* aResponse,
+    const GError* aError,
+    void* aRequest)
+{
+    Request* req = (Request*) aRequest;
+    NfcTransceiver* self = req->iOwner;
+
+    if (self) {
+        const qint64 ns = req->iTimer.nsecsElapsed();
+
+        HASSERT(self->iActive == req);
+        req->iOwner = Q_NULLPTR;
+        self->iActive = Q_NULLPTR;
+
+        // Put the next frame on the wire before anyone gets notified
+        self->submit();
+        if (aResponse && !aError) {
+            HTRACE3(transceive_done, req->iId, aResponse->size, ns);
+            HVERBOSE(req->iId << QByteArray((char*)aResponse->bytes,
+                aResponse->size).toHex() << ns << "ns");
+            self->iListener->transceiveDone(req->iId, aResponse, ns);
+        } else {
+            HTRACE1(transceive_fail, req->iId);
+            HDEBUG(req->iId << (aError ? aError->message : "failed"));
+            self->iListener->transceiveFailed(req->iId);
+        }
+    }
+}
+
+/* static */
+void
+NfcTransceiver::requestDestroy(
+    void* aRequest)
+{
+    delete (Request*) aRequest;
+}
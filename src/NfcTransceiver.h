@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TRANSCEIVER_H
+#define QNFCDC_TRANSCEIVER_H
+
+#include <nfcdc_tag.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QQueue>
+
+// Internal helper which sends raw frames to the tag one by one. Frames
+// are queued and the next one is handed over to nfcd straight from the
+// completion callback of the previous one, i.e. without waiting for the
+// Qt event loop. Queued frames are held until the tag becomes valid.
+//
+// The listener is invoked from the completion callback too, it may queue
+// more frames but must not delete the transceiver. If a frame can't be
+// submitted right away, transceive() returns zero and the listener isn't
+// notified about it.
+
+class NfcTransceiver
+{
+    Q_DISABLE_COPY(NfcTransceiver)
+
+public:
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        virtual void transceiveDone(int, const GUtilData*, qint64) = 0;
+        virtual void transceiveFailed(int) = 0;
+    };
+
+    NfcTransceiver(Listener*);
+    ~NfcTransceiver();
+
+    void setTag(NfcTagClient*);
+    int transceive(const QByteArray&);
+    bool cancel(int);
+    void cancelAll();
+    bool busy() const;
+
+private:
+    class Request;
+
+    void abandon(bool);
+    bool start(Request*);
+    void submit();
+
+    static void validChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+    static void requestDone(NfcTagClient*, const GUtilData*, const GError*,
+        void*);
+    static void requestDestroy(void*);
+
+private:
+    Listener* iListener;
+    NfcTagClient* iTag;
+    gulong iValidId;
+    QQueue<Request*> iQueue;
+    Request* iActive;
+    int iLastId;
+};
+
+#endif // QNFCDC_TRANSCEIVER_H
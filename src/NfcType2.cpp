@@ -0,0 +1,1310 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcType2.h"
+#include "NfcClientPool.h"
+#include "NfcIoThread.h"
+#include "NfcNdefListener.h"
+#include "NfcNdefMessage.h"
+#include "NfcSignalTable.h"
+#include "NfcTagCache.h"
+#include "NfcTransceiver.h"
+
+#include "Debug.h"
+
+#include <QtCore/QBitArray>
+#include <QtCore/QHash>
+
+enum type2_tag_events {
+    TYPE2_TAG_EVENT_VALID,
+    TYPE2_TAG_EVENT_PRESENT,
+    TYPE2_TAG_EVENT_COUNT
+};
+
+// NFC Forum Type 2 Tag and NXP NTAG21x commands
+#define T2_CMD_READ (0x30)
+#define T2_CMD_FAST_READ (0x3a)
+#define T2_CMD_WRITE (0xa2)
+#define T2_ACK (0x0a)       // 4-bit ACK
+
+#define T2_PAGE_SIZE (4)
+#define T2_READ_PAGES (4)
+#define T2_MAX_PAGES (256)  // Single byte page address
+#define T2_DATA_PAGE (4)    // First page of the data area
+#define T2_CC_PAGE (3)      // Capability Container
+#define T2_CC_MAGIC (0xe1)
+#define T2_CC_ACCESS (3)    // Read (high nibble) and write access
+#define T2_UID_SIZE (7)
+
+// UID, lock bytes, Capability Container and the first 16 bytes of
+// the data area (normally the NDEF TLV header). Cached contents are
+// reused only if these pages still match.
+#define T2_CHECK_PAGES (8)
+
+// TLV blocks
+#define T2_TLV_NULL (0x00)
+#define T2_TLV_NDEF (0x03)
+#define T2_TLV_SHORT_LENGTH_MAX (0xfe)
+#define T2_TLV_TERMINATOR (0xfe)
+#define T2_TLV_LONG_LENGTH (0xff)
+
+// Keeps FAST_READ response well within 256 byte RF frame size
+#define T2_FAST_READ_MAX_PAGES (60)
+
+// ==========================================================================
+// NfcType2::Private
+// ==========================================================================
+
+class NfcType2::Private :
+    public NfcTransceiver::Listener
+{
+public:
+    class Frame {
+    public:
+        Frame() : iPage(0), iCount(0), iFastRead(false) {}
+        Frame(int aPage, int aCount, bool aFastRead) :
+            iPage(aPage), iCount(aCount), iFastRead(aFastRead) {}
+
+    public:
+        int iPage;
+        int iCount;
+        bool iFastRead;
+    };
+
+    class Request {
+    public:
+        Request(int aId, int aPage, int aCount) :
+            iId(aId), iPage(aPage), iCount(aCount) {}
+
+    public:
+        int iId;
+        int iPage;
+        int iCount; // Negative means the whole memory
+        QByteArray iExpected; // Non-empty for verification
+    };
+
+    class PageWrite {
+    public:
+        PageWrite() : iRequestId(0), iPage(0) {}
+        PageWrite(int aRequestId, int aPage, const QByteArray& aData) :
+            iRequestId(aRequestId), iPage(aPage), iData(aData) {}
+
+    public:
+        int iRequestId;
+        int iPage;
+        QByteArray iData;
+    };
+
+    Private(NfcType2*);
+    ~Private();
+
+    int nextId();
+    void setPath(const char*);
+    void clearCache();
+    int read(int, int);
+    int writeNdef(const QByteArray&);
+    int verifyNdef();
+    int ndefTlvOffset() const;
+    bool sendWrite(int, int, const QByteArray&);
+    void writeDone(int);
+    void cancelWrite(int);
+    void failWrite(int);
+    void failWrites();
+    void updateData();
+    bool cached(int, int) const;
+    bool complete() const;
+    QByteArray pages(int, int) const;
+    QByteArray uid() const;
+    bool cacheCheckPending() const;
+    void prepareCacheCheck();
+    bool restore();
+    void store(int, const guint8*, int);
+    void schedule();
+    bool sendRead(int);
+    bool sendFastRead(int, int);
+    void checkRequests();
+    void failRequests();
+
+    static int findNdefTlv(const QByteArray&, int*);
+    static NfcNdefMessage findNdef(const QByteArray&);
+
+    enum Type2Signal {
+        SignalValidChanged,
+        SignalPresentChanged,
+        SignalSizeChanged,
+        SignalDataChanged,
+        SignalCount
+    };
+
+    typedef NfcSignalTable<NfcType2> SignalTable;
+    typedef SignalTable::Signal Signal;
+    static const Signal TYPE2_SIGNAL[];
+    static const SignalTable& signalTable();
+    void emitSignal(Type2Signal);
+    static void validChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+    static void presentChanged(NfcTagClient*, NFC_TAG_PROPERTY, void*);
+
+    // NfcTransceiver::Listener
+    void transceiveDone(int, const GUtilData*, qint64) Q_DECL_OVERRIDE;
+    void transceiveFailed(int) Q_DECL_OVERRIDE;
+
+public:
+    NfcType2* iParent;
+    NfcTagClient* iTag;
+    gulong iTagEventId[TYPE2_TAG_EVENT_COUNT];
+    NfcTransceiver iTransceiver;
+    NfcNdefListener* iListener;
+    QHash<int,Frame> iFrames;
+    QHash<int,PageWrite> iWrites;
+    QList<Request> iRequests;
+    QBitArray iCached;
+    QBitArray iPending;
+    uchar iImage[T2_MAX_PAGES * T2_PAGE_SIZE];
+    QByteArray iData;
+    NfcNdefMessage iNdef;
+    int iTotalPages;
+    int iWritePage;     // Pages covering the NDEF TLV written last
+    int iWriteCount;
+    int iCacheTtl;
+    int iCheckPages;    // How much to compare with the cached image
+    NfcTagCache::Entry iCacheEntry;
+    bool iCacheChecked;
+    bool iFastRead;
+    bool iFastReadWorks;
+    bool iFastReadFailed;
+    int iLastId;
+};
+
+const NfcType2::Private::Signal NfcType2::Private::TYPE2_SIGNAL[] = {
+    &NfcType2::validChanged,     // SignalValidChanged
+    &NfcType2::presentChanged,   // SignalPresentChanged
+    &NfcType2::sizeChanged,      // SignalSizeChanged
+    &NfcType2::dataChanged       // SignalDataChanged
+};
+
+NfcType2::Private::Private(
+    NfcType2* aParent) :
+    iParent(aParent),
+    iTag(Q_NULLPTR),
+    iTransceiver(this),
+    iListener(Q_NULLPTR),
+    iCached(T2_MAX_PAGES),
+    iPending(T2_MAX_PAGES),
+    iTotalPages(0),
+    iWritePage(0),
+    iWriteCount(0),
+    iCacheTtl(0),
+    iCheckPages(0),
+    iCacheChecked(false),
+    iFastRead(true),
+    iFastReadWorks(false),
+    iFastReadFailed(false),
+    iLastId(0)
+{
+    memset(iTagEventId, 0, sizeof(iTagEventId));
+    memset(iImage, 0, sizeof(iImage));
+    Q_STATIC_ASSERT(G_N_ELEMENTS(TYPE2_SIGNAL) == SignalCount);
+}
+
+NfcType2::Private::~Private()
+{
+    iTransceiver.cancelAll();
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+}
+
+void
+NfcType2::Private::setPath(
+    const char* aPath)
+{
+    // Forget the frames first, the transceiver is going to fail them
+    iFrames.clear();
+    failRequests();
+    failWrites();
+    clearCache();
+    iFastReadWorks = false;
+    iFastReadFailed = false;
+    nfc_tag_client_remove_all_handlers(iTag, iTagEventId);
+    NfcClientPool::get()->releaseTag(iTag);
+    if (aPath) {
+        iTag = NfcClientPool::get()->newTag(aPath);
+        iTagEventId[TYPE2_TAG_EVENT_VALID] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_VALID, validChanged, this);
+        iTagEventId[TYPE2_TAG_EVENT_PRESENT] =
+            nfc_tag_client_add_property_handler(iTag,
+                NFC_TAG_PROPERTY_PRESENT, presentChanged, this);
+    } else {
+        iTag = Q_NULLPTR;
+    }
+    iTransceiver.setTag(iTag);
+}
+
+int
+NfcType2::Private::nextId()
+{
+    iLastId = (iLastId < G_MAXINT) ? (iLastId + 1) : 1;
+    return iLastId;
+}
+
+void
+NfcType2::Private::clearCache()
+{
+    iCached.fill(false);
+    memset(iImage, 0, sizeof(iImage));
+    iData.clear();
+    iNdef = NfcNdefMessage();
+    iTotalPages = 0;
+    iWriteCount = 0;
+    iCheckPages = 0;
+    iCacheEntry = NfcTagCache::Entry();
+    iCacheChecked = false;
+}
+
+int
+NfcType2::Private::read(
+    int aPage,
+    int aCount)
+{
+    if (iTag && aPage >= 0 && aPage < T2_MAX_PAGES &&
+        (aCount < 0 || (aCount > 0 && (aPage + aCount) <= T2_MAX_PAGES))) {
+        const int id = nextId();
+
+        iRequests.append(Request(id, aPage, aCount));
+        // The data may already be there
+        checkRequests();
+        schedule();
+        return id;
+    }
+    return 0;
+}
+
+int
+NfcType2::Private::ndefTlvOffset() const
+{
+    const int end = iTotalPages * T2_PAGE_SIZE;
+    int pos = T2_DATA_PAGE * T2_PAGE_SIZE;
+
+    // Skip the TLVs preceding the NDEF one (or the terminator, meaning
+    // that there's no NDEF TLV yet). They all have to be in the cache.
+    while (pos < end && cached(pos / T2_PAGE_SIZE, 1)) {
+        const uchar t = iImage[pos];
+
+        if (t == T2_TLV_NDEF || t == T2_TLV_TERMINATOR) {
+            return pos;
+        } else if (t == T2_TLV_NULL) {
+            pos++;
+        } else if ((pos + 1) < end && cached((pos + 1) / T2_PAGE_SIZE, 1)) {
+            int len = iImage[pos + 1];
+
+            pos += 2;
+            if (len == T2_TLV_LONG_LENGTH) {
+                if ((pos + 1) >= end || !cached(pos / T2_PAGE_SIZE, 1) ||
+                    !cached((pos + 1) / T2_PAGE_SIZE, 1)) {
+                    break;
+                }
+                len = (((int)iImage[pos]) << 8) | iImage[pos + 1];
+                pos += 2;
+            }
+            pos += len;
+        } else {
+            break;
+        }
+    }
+    return -1;
+}
+
+int
+NfcType2::Private::writeNdef(
+    const QByteArray& aNdef)
+{
+    const uchar* cc = iImage + T2_CC_PAGE * T2_PAGE_SIZE;
+
+    if (!iTag || !iTotalPages || !cached(T2_CC_PAGE, 1) ||
+        cc[0] != T2_CC_MAGIC || (cc[T2_CC_ACCESS] & 0x0f)) {
+        HDEBUG("Not a writable NDEF tag");
+        return 0;
+    }
+
+    const int offset = ndefTlvOffset();
+    const int size = aNdef.size();
+    const int lenSize = (size > T2_TLV_SHORT_LENGTH_MAX) ? 3 : 1;
+    const int end = offset + 1 + lenSize + size;
+    const int total = iTotalPages * T2_PAGE_SIZE;
+
+    if (offset < 0 || end > total || size > 0xffff) {
+        HDEBUG("Can't write" << size << "bytes at" << offset);
+        return 0;
+    }
+
+    // New contents of the affected pages. Partial pages at either end
+    // keep whatever was there.
+    const int firstPage = offset / T2_PAGE_SIZE;
+    const int lastPage = qMin(end, total - 1) / T2_PAGE_SIZE;
+    QByteArray image(pages(firstPage, lastPage - firstPage + 1));
+    uchar* tlv = (uchar*)image.data() + (offset % T2_PAGE_SIZE);
+
+    *tlv++ = T2_TLV_NDEF;
+    if (lenSize > 1) {
+        *tlv++ = T2_TLV_LONG_LENGTH;
+        *tlv++ = (uchar)(size >> 8);
+    }
+    *tlv++ = (uchar)size;
+    memcpy(tlv, aNdef.constData(), size);
+    if (end < total) {
+        tlv[size] = T2_TLV_TERMINATOR;
+    }
+
+    // Same thing with zero length
+    QByteArray empty(image);
+    uchar* len = (uchar*)empty.data() + (offset % T2_PAGE_SIZE) + lenSize;
+
+    len[0] = 0;
+    if (lenSize > 1) {
+        len[-1] = 0;
+    }
+
+    // Pages holding the length field are written last, only if
+    // something else changes they get cleared first.
+    const int lenFirst = (offset + 1) / T2_PAGE_SIZE;
+    const int lenLast = (offset + lenSize) / T2_PAGE_SIZE;
+    QList<int> body;
+    bool lengthChanged = false;
+
+    for (int page = firstPage; page <= lastPage; page++) {
+        const char* data = image.constData() +
+            (page - firstPage) * T2_PAGE_SIZE;
+
+        if (!cached(page, 1) || memcmp(iImage + page * T2_PAGE_SIZE, data,
+            T2_PAGE_SIZE)) {
+            if (page >= lenFirst && page <= lenLast) {
+                lengthChanged = true;
+            } else {
+                body.append(page);
+            }
+        }
+    }
+
+    const int id = nextId();
+
+    HDEBUG("Writing" << size << "bytes at" << offset << "in" <<
+        body.count() << "page(s)");
+    iWritePage = firstPage;
+    iWriteCount = lastPage - firstPage + 1;
+    if (!body.isEmpty()) {
+        for (int page = lenFirst; page <= lenLast; page++) {
+            if (!sendWrite(id, page, empty.mid((page - firstPage) *
+                T2_PAGE_SIZE, T2_PAGE_SIZE))) {
+                cancelWrite(id);
+                return 0;
+            }
+        }
+        for (int i = 0; i < body.count(); i++) {
+            const int page = body.at(i);
+
+            if (!sendWrite(id, page, image.mid((page - firstPage) *
+                T2_PAGE_SIZE, T2_PAGE_SIZE))) {
+                cancelWrite(id);
+                return 0;
+            }
+        }
+        lengthChanged = true;
+    }
+    if (lengthChanged) {
+        for (int page = lenFirst; page <= lenLast; page++) {
+            if (!sendWrite(id, page, image.mid((page - firstPage) *
+                T2_PAGE_SIZE, T2_PAGE_SIZE))) {
+                cancelWrite(id);
+                return 0;
+            }
+        }
+    } else {
+        static const QMetaMethod writeNdefDone(QMetaMethod::fromSignal(
+            &NfcType2::writeNdefDone));
+
+        // Nothing to write
+        writeNdefDone.invoke(iParent, Qt::QueuedConnection, Q_ARG(int, id));
+        if (iListener) {
+            iListener->ndefWriteDone(id);
+        }
+    }
+    return id;
+}
+
+int
+NfcType2::Private::verifyNdef()
+{
+    // Only the pages holding the NDEF TLV written last are re-read
+    if (iTag && iWriteCount && iWrites.isEmpty()) {
+        const int id = nextId();
+        Request req(id, iWritePage, iWriteCount);
+
+        req.iExpected = pages(iWritePage, iWriteCount);
+        iCached.fill(false, iWritePage, iWritePage + iWriteCount);
+        iRequests.append(req);
+        schedule();
+        return id;
+    }
+    return 0;
+}
+
+bool
+NfcType2::Private::sendWrite(
+    int aRequestId,
+    int aPage,
+    const QByteArray& aData)
+{
+    QByteArray cmd;
+
+    cmd.reserve(2 + T2_PAGE_SIZE);
+    cmd.append((char)T2_CMD_WRITE);
+    cmd.append((char)aPage);
+    cmd.append(aData);
+
+    const int id = iTransceiver.transceive(cmd);
+
+    if (id) {
+        iWrites.insert(id, PageWrite(aRequestId, aPage, aData));
+        return true;
+    }
+    return false;
+}
+
+void
+NfcType2::Private::writeDone(
+    int aFrameId)
+{
+    static const QMetaMethod writeNdefDone(QMetaMethod::fromSignal(
+        &NfcType2::writeNdefDone));
+    const PageWrite write(iWrites.take(aFrameId));
+
+    memcpy(iImage + write.iPage * T2_PAGE_SIZE, write.iData.constData(),
+        T2_PAGE_SIZE);
+    iCached.setBit(write.iPage);
+    for (QHash<int,PageWrite>::const_iterator it = iWrites.constBegin();
+        it != iWrites.constEnd(); ++it) {
+        if (it.value().iRequestId == write.iRequestId) {
+            // More to come
+            return;
+        }
+    }
+    updateData();
+    writeNdefDone.invoke(iParent, Qt::QueuedConnection,
+        Q_ARG(int, write.iRequestId));
+    if (iListener) {
+        iListener->ndefWriteDone(write.iRequestId);
+    }
+}
+
+void
+NfcType2::Private::cancelWrite(
+    int aRequestId)
+{
+    QHash<int,PageWrite>::iterator it = iWrites.begin();
+
+    // There's nothing to verify
+    iWriteCount = 0;
+    while (it != iWrites.end()) {
+        if (it.value().iRequestId == aRequestId) {
+            iTransceiver.cancel(it.key());
+            it = iWrites.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+NfcType2::Private::failWrite(
+    int aRequestId)
+{
+    static const QMetaMethod writeNdefFailed(QMetaMethod::fromSignal(
+        &NfcType2::writeNdefFailed));
+
+    cancelWrite(aRequestId);
+    // The pages written so far are in the image
+    updateData();
+    writeNdefFailed.invoke(iParent, Qt::QueuedConnection,
+        Q_ARG(int, aRequestId));
+    if (iListener) {
+        iListener->ndefFailed(aRequestId);
+    }
+}
+
+void
+NfcType2::Private::failWrites()
+{
+    while (!iWrites.isEmpty()) {
+        failWrite(iWrites.begin().value().iRequestId);
+    }
+}
+
+void
+NfcType2::Private::updateData()
+{
+    const QByteArray tagUid(uid());
+
+    // The cached copy (if any) is no longer valid
+    if (!tagUid.isEmpty()) {
+        NfcTagCache::get()->remove(NfcTagCache::Type2, tagUid);
+    }
+    if (complete()) {
+        iData = pages(0, iTotalPages);
+        iNdef = findNdef(iData);
+        if (iCacheTtl > 0) {
+            NfcTagCache::get()->insert(NfcTagCache::Type2, tagUid,
+                iData, iNdef);
+        }
+        emitSignal(SignalDataChanged);
+    }
+}
+
+bool
+NfcType2::Private::cached(
+    int aPage,
+    int aCount) const
+{
+    for (int i = 0; i < aCount; i++) {
+        if (!iCached.testBit(aPage + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline
+bool
+NfcType2::Private::complete() const
+{
+    return iTotalPages && cached(0, iTotalPages);
+}
+
+inline
+QByteArray
+NfcType2::Private::pages(
+    int aPage,
+    int aCount) const
+{
+    return QByteArray((char*)iImage + aPage * T2_PAGE_SIZE,
+        aCount * T2_PAGE_SIZE);
+}
+
+QByteArray
+NfcType2::Private::uid() const
+{
+    // Pages 0-2 hold UID0-2, BCC0, UID3-6 and BCC1
+    if (cached(0, 3)) {
+        QByteArray uid;
+
+        uid.reserve(T2_UID_SIZE);
+        uid.append((char*)iImage, 3);
+        uid.append((char*)iImage + T2_PAGE_SIZE, 4);
+        return uid;
+    }
+    return QByteArray();
+}
+
+inline
+bool
+NfcType2::Private::cacheCheckPending() const
+{
+    return iCacheTtl > 0 && !iCacheChecked;
+}
+
+void
+NfcType2::Private::prepareCacheCheck()
+{
+    NfcTagCache::Entry entry;
+
+    if (NfcTagCache::get()->lookup(NfcTagCache::Type2, uid(), iCacheTtl,
+        &entry) && entry.iData.size() == iTotalPages * T2_PAGE_SIZE) {
+        int len = 0;
+        const int pos = findNdefTlv(entry.iData, &len);
+        const int end = (pos >= 0) ? (pos + len) : 0;
+
+        // Everything up to the end of the NDEF message has to match
+        iCheckPages = qMin(qMax(T2_CHECK_PAGES, (end + T2_PAGE_SIZE - 1) /
+            T2_PAGE_SIZE), iTotalPages);
+        iCacheEntry = entry;
+        HDEBUG("Checking" << iCheckPages << "pages");
+    } else {
+        // Nothing to compare with
+        iCacheChecked = true;
+    }
+}
+
+bool
+NfcType2::Private::restore()
+{
+    const QByteArray data(iCacheEntry.iData);
+    const NfcNdefMessage ndef(iCacheEntry.iNdef);
+
+    iCacheEntry = NfcTagCache::Entry();
+    if (!memcmp(data.constData(), iImage, iCheckPages * T2_PAGE_SIZE)) {
+        HDEBUG("Using cached contents");
+        memcpy(iImage, data.constData(), data.size());
+        iCached.fill(true, 0, iTotalPages);
+        iData = data;
+        iNdef = ndef;
+        return true;
+    }
+    HDEBUG("Cached contents don't match");
+    return false;
+}
+
+void
+NfcType2::Private::store(
+    int aPage,
+    const guint8* aData,
+    int aCount)
+{
+    const bool wasComplete = complete();
+    const int maxPages = iTotalPages ? iTotalPages : T2_MAX_PAGES;
+
+    // READ wraps around at the end of memory, drop those pages
+    for (int i = 0; i < aCount && (aPage + i) < maxPages; i++) {
+        memcpy(iImage + (aPage + i) * T2_PAGE_SIZE,
+            aData + i * T2_PAGE_SIZE, T2_PAGE_SIZE);
+        iCached.setBit(aPage + i);
+    }
+
+    if (!iTotalPages && iCached.testBit(T2_CC_PAGE)) {
+        const uchar* cc = iImage + T2_CC_PAGE * T2_PAGE_SIZE;
+
+        if (cc[0] == T2_CC_MAGIC) {
+            // Size of the data area is in units of 8 bytes
+            iTotalPages = qMin(T2_DATA_PAGE + cc[2] * 2, T2_MAX_PAGES);
+        } else {
+            // Not NDEF formatted, assume the smallest Ultralight
+            iTotalPages = 16;
+        }
+        HDEBUG("Memory size" << iTotalPages * T2_PAGE_SIZE << "bytes");
+        emitSignal(SignalSizeChanged);
+    }
+
+    if (!wasComplete && iTotalPages && cacheCheckPending() &&
+        cached(0, T2_DATA_PAGE)) {
+        if (!iCheckPages) {
+            prepareCacheCheck();
+        }
+        if (iCheckPages && cached(0, iCheckPages)) {
+            iCacheChecked = true;
+            restore();
+        }
+    }
+
+    if (!wasComplete && complete()) {
+        if (iData.isEmpty()) {
+            // The image and the NDEF message are built only once
+            iData = pages(0, iTotalPages);
+            iNdef = findNdef(iData);
+            if (iCacheTtl > 0) {
+                NfcTagCache::get()->insert(NfcTagCache::Type2, uid(),
+                    iData, iNdef);
+            }
+        }
+        emitSignal(SignalDataChanged);
+    }
+}
+
+/* static */
+NfcNdefMessage
+NfcType2::Private::findNdef(
+    const QByteArray& aData)
+{
+    int len = 0;
+    const int pos = findNdefTlv(aData, &len);
+
+    if (pos >= 0) {
+        HDEBUG("NDEF at" << pos << len << "bytes");
+        return NfcNdefMessage(aData, pos, len);
+    }
+    return NfcNdefMessage();
+}
+
+/* static */
+int
+NfcType2::Private::findNdefTlv(
+    const QByteArray& aData,
+    int* aLength)
+{
+    const uchar* buf = (const uchar*)aData.constData();
+    const int end = aData.size();
+    int pos = T2_DATA_PAGE * T2_PAGE_SIZE;
+
+    // Reserved memory areas (described by Lock Control and Memory
+    // Control TLVs) are assumed to be outside of the NDEF message.
+    while (pos < end) {
+        const uchar t = buf[pos++];
+
+        if (t == T2_TLV_NULL) {
+            continue;
+        } else if (t == T2_TLV_TERMINATOR || pos >= end) {
+            break;
+        } else {
+            int len = buf[pos++];
+
+            if (len == T2_TLV_LONG_LENGTH) {
+                if (pos + 2 > end) {
+                    break;
+                }
+                len = (((int)buf[pos]) << 8) | buf[pos + 1];
+                pos += 2;
+            }
+            if (t == T2_TLV_NDEF) {
+                // Value offset, the length may run past the end
+                *aLength = len;
+                return pos;
+            }
+            pos += len;
+        }
+    }
+    return -1;
+}
+
+void
+NfcType2::Private::schedule()
+{
+    QBitArray need(T2_MAX_PAGES);
+    const int n = iRequests.count();
+
+    for (int i = 0; i < n; i++) {
+        const Request& req = iRequests.at(i);
+
+        if (req.iCount >= 0) {
+            need.fill(true, req.iPage, req.iPage + req.iCount);
+        } else if (cacheCheckPending()) {
+            // Just enough to validate the cached contents
+            need.fill(true, 0, iCheckPages ? iCheckPages : iTotalPages ?
+                qMin(T2_CHECK_PAGES, iTotalPages) : T2_CHECK_PAGES);
+        } else if (iTotalPages) {
+            need.fill(true, 0, iTotalPages);
+        } else {
+            // Capability Container first
+            need.fill(true, 0, T2_DATA_PAGE);
+        }
+    }
+    need &= ~iCached;
+    need &= ~iPending;
+
+    int page = 0;
+    const bool fast = iFastRead && !iFastReadFailed;
+
+    // Until FAST_READ is known to work, only one frame at a time
+    if (fast && !iFastReadWorks && !iFrames.isEmpty()) {
+        return;
+    }
+
+    while (page < T2_MAX_PAGES) {
+        if (!need.testBit(page)) {
+            page++;
+        } else if (fast) {
+            int end = page + 1;
+
+            while (end < T2_MAX_PAGES && need.testBit(end) &&
+                (end - page) < T2_FAST_READ_MAX_PAGES) {
+                end++;
+            }
+            if (!sendFastRead(page, end - page) || !iFastReadWorks) {
+                break;
+            }
+            page = end;
+        } else if (sendRead(page)) {
+            page += T2_READ_PAGES;
+        } else {
+            break;
+        }
+    }
+}
+
+bool
+NfcType2::Private::sendRead(
+    int aPage)
+{
+    QByteArray cmd;
+
+    cmd.reserve(2);
+    cmd.append((char)T2_CMD_READ);
+    cmd.append((char)aPage);
+
+    const int id = iTransceiver.transceive(cmd);
+    const int count = qMin(T2_READ_PAGES, T2_MAX_PAGES - aPage);
+
+    if (id) {
+        iFrames.insert(id, Frame(aPage, count, false));
+        iPending.fill(true, aPage, aPage + count);
+        return true;
+    } else {
+        failRequests();
+        return false;
+    }
+}
+
+bool
+NfcType2::Private::sendFastRead(
+    int aPage,
+    int aCount)
+{
+    QByteArray cmd;
+
+    cmd.reserve(3);
+    cmd.append((char)T2_CMD_FAST_READ);
+    cmd.append((char)aPage);
+    cmd.append((char)(aPage + aCount - 1));
+
+    const int id = iTransceiver.transceive(cmd);
+
+    if (id) {
+        iFrames.insert(id, Frame(aPage, aCount, true));
+        iPending.fill(true, aPage, aPage + aCount);
+        return true;
+    } else {
+        failRequests();
+        return false;
+    }
+}
+
+void
+NfcType2::Private::checkRequests()
+{
+    static const QMetaMethod readDone(QMetaMethod::fromSignal(
+        &NfcType2::readDone));
+    QList<Request> done;
+
+    for (int i = 0; i < iRequests.count();) {
+        Request& req = iRequests[i];
+
+        if (req.iCount < 0 && iTotalPages) {
+            req.iCount = iTotalPages;
+        }
+        if (req.iCount >= 0 && cached(req.iPage, req.iCount)) {
+            done.append(iRequests.takeAt(i));
+        } else {
+            i++;
+        }
+    }
+
+    // The listener may start more requests
+    for (int i = 0; i < done.count(); i++) {
+        const Request& req = done.at(i);
+        const QByteArray data(pages(req.iPage, req.iCount));
+
+        if (req.iExpected.isEmpty()) {
+            readDone.invoke(iParent, Qt::QueuedConnection,
+                Q_ARG(int, req.iId), Q_ARG(QByteArray, data));
+            if (iListener) {
+                iListener->ndefReadDone(req.iId, data);
+            }
+        } else {
+            const bool ok = (data == req.iExpected);
+
+            if (!ok) {
+                // What's actually on the tag
+                HDEBUG("Verification failed" << data.toHex());
+                updateData();
+            }
+            if (iListener) {
+                iListener->ndefVerifyDone(req.iId, ok);
+            }
+        }
+    }
+}
+
+void
+NfcType2::Private::failRequests()
+{
+    static const QMetaMethod readFailed(QMetaMethod::fromSignal(
+        &NfcType2::readFailed));
+    const QList<Request> failed(iRequests);
+    const int n = failed.count();
+
+    iRequests.clear();
+
+    // Writes are not affected
+    for (QHash<int,Frame>::const_iterator it = iFrames.constBegin();
+        it != iFrames.constEnd(); ++it) {
+        iTransceiver.cancel(it.key());
+    }
+    iFrames.clear();
+    iPending.fill(false);
+
+    for (int i = 0; i < n; i++) {
+        const Request& req = failed.at(i);
+
+        if (req.iExpected.isEmpty()) {
+            readFailed.invoke(iParent, Qt::QueuedConnection,
+                Q_ARG(int, req.iId));
+        }
+        if (iListener) {
+            iListener->ndefFailed(req.iId);
+        }
+    }
+}
+
+void
+NfcType2::Private::transceiveDone(
+    int aId,
+    const GUtilData* aResponse,
+    qint64)
+{
+    if (iWrites.contains(aId)) {
+        if (aResponse->size >= 1 &&
+            (aResponse->bytes[0] & 0x0f) == T2_ACK) {
+            writeDone(aId);
+        } else {
+            HDEBUG("WRITE rejected" << QByteArray((char*)
+                aResponse->bytes, aResponse->size).toHex());
+            failWrite(iWrites.value(aId).iRequestId);
+        }
+    } else if (iFrames.contains(aId)) {
+        const Frame frame(iFrames.take(aId));
+        const int expected = T2_PAGE_SIZE *
+            (frame.iFastRead ? frame.iCount : T2_READ_PAGES);
+
+        iPending.fill(false, frame.iPage, frame.iPage + frame.iCount);
+        if ((int)aResponse->size == expected) {
+            if (frame.iFastRead && !iFastReadWorks) {
+                HDEBUG("FAST_READ works");
+                iFastReadWorks = true;
+            }
+            store(frame.iPage, aResponse->bytes, frame.iCount);
+            checkRequests();
+            schedule();
+        } else if (frame.iFastRead && !iFastReadWorks) {
+            HDEBUG("FAST_READ rejected");
+            iFastReadFailed = true;
+            schedule();
+        } else {
+            HDEBUG("Unexpected response" << QByteArray((char*)
+                aResponse->bytes, aResponse->size).toHex());
+            failRequests();
+        }
+    }
+}
+
+void
+NfcType2::Private::transceiveFailed(
+    int aId)
+{
+    if (iWrites.contains(aId)) {
+        failWrite(iWrites.value(aId).iRequestId);
+    } else if (iFrames.contains(aId)) {
+        const Frame frame(iFrames.take(aId));
+
+        iPending.fill(false, frame.iPage, frame.iPage + frame.iCount);
+        if (frame.iFastRead && !iFastReadWorks) {
+            HDEBUG("FAST_READ failed");
+            iFastReadFailed = true;
+            schedule();
+        } else {
+            failRequests();
+        }
+    }
+}
+
+// Qt signals should be signalled from the Qt event loop
+// See https://bugreports.qt.io/browse/QTBUG-18434 for details
+
+/* static */
+const NfcType2::Private::SignalTable&
+NfcType2::Private::signalTable()
+{
+    static const SignalTable table(TYPE2_SIGNAL, SignalCount);
+
+    return table;
+}
+
+inline
+void
+NfcType2::Private::emitSignal(
+    Type2Signal aSignal)
+{
+    signalTable().emitQueued(iParent, aSignal);
+}
+
+/* static */
+void
+NfcType2::Private::validChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->emitSignal(SignalValidChanged);
+}
+
+/* static */
+void
+NfcType2::Private::presentChanged(
+    NfcTagClient*,
+    NFC_TAG_PROPERTY,
+    void* aPrivate)
+{
+    ((Private*)aPrivate)->emitSignal(SignalPresentChanged);
+}
+
+// ==========================================================================
+// NfcType2
+// ==========================================================================
+
+NfcType2::NfcType2(
+    QObject* aParent) :
+    QObject(aParent),
+    iPrivate(new Private(this))
+{
+}
+
+NfcType2::~NfcType2()
+{
+    NfcIoLock lock;
+
+    delete iPrivate;
+}
+
+void
+NfcType2::setPath(
+    QString aPath)
+{
+    NfcIoLock lock;
+
+    const QString currentPath(path());
+
+    if (currentPath != aPath) {
+        const bool wasValid = valid();
+        const bool wasPresent = present();
+        const bool hadSize = size() != 0;
+        const bool hadData = iPrivate->complete();
+
+        HDEBUG(aPath);
+        if (aPath.isEmpty()) {
+            iPrivate->setPath(Q_NULLPTR);
+        } else {
+            QByteArray bytes(aPath.toLatin1());
+            iPrivate->setPath(bytes.constData());
+        }
+
+        Q_EMIT pathChanged();
+        if (wasValid != valid()) {
+            Q_EMIT validChanged();
+        }
+        if (wasPresent != present()) {
+            Q_EMIT presentChanged();
+        }
+        if (hadSize) {
+            Q_EMIT sizeChanged();
+        }
+        if (hadData) {
+            Q_EMIT dataChanged();
+        }
+    }
+}
+
+QString
+NfcType2::path() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag ? QString(iPrivate->iTag->path) : QString();
+}
+
+bool
+NfcType2::valid() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag && iPrivate->iTag->valid;
+}
+
+bool
+NfcType2::present() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTag && iPrivate->iTag->present;
+}
+
+bool
+NfcType2::fastRead() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iFastRead;
+}
+
+void
+NfcType2::setFastRead(
+    bool aFastRead)
+{
+    NfcIoLock lock;
+
+    if (iPrivate->iFastRead != aFastRead) {
+        iPrivate->iFastRead = aFastRead;
+        Q_EMIT fastReadChanged();
+    }
+}
+
+int
+NfcType2::cacheTtl() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iCacheTtl;
+}
+
+void
+NfcType2::setCacheTtl(
+    int aMsec)
+{
+    NfcIoLock lock;
+
+    const int ttl = qMax(aMsec, 0);
+
+    if (iPrivate->iCacheTtl != ttl) {
+        iPrivate->iCacheTtl = ttl;
+        Q_EMIT cacheTtlChanged();
+    }
+}
+
+/* static */
+int
+NfcType2::cacheCapacity()
+{
+    NfcIoLock lock;
+
+    return NfcTagCache::get()->capacity();
+}
+
+/* static */
+void
+NfcType2::setCacheCapacity(
+    int aCount)
+{
+    NfcIoLock lock;
+
+    NfcTagCache::get()->setCapacity(aCount);
+}
+
+int
+NfcType2::size() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iTotalPages * T2_PAGE_SIZE;
+}
+
+QByteArray
+NfcType2::data() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iData;
+}
+
+NfcNdefMessage
+NfcType2::ndef() const
+{
+    NfcIoLock lock;
+
+    return iPrivate->iNdef;
+}
+
+int
+NfcType2::read(
+    int aPage,
+    int aCount)
+{
+    NfcIoLock lock;
+
+    return iPrivate->read(aPage, aCount);
+}
+
+int
+NfcType2::readAll()
+{
+    NfcIoLock lock;
+
+    return iPrivate->read(0, -1);
+}
+
+int
+NfcType2::writeNdef(
+    QByteArray aNdef)
+{
+    NfcIoLock lock;
+
+    return iPrivate->writeNdef(aNdef);
+}
+
+void
+NfcType2::setNdefListener(
+    NfcNdefListener* aListener)
+{
+    NfcIoLock lock;
+
+    iPrivate->iListener = aListener;
+}
+
+int
+NfcType2::verifyNdef()
+{
+    NfcIoLock lock;
+
+    return iPrivate->verifyNdef();
+}
+
+void
+NfcType2::clearCache()
+{
+    NfcIoLock lock;
+
+    const bool hadSize = size() != 0;
+    const bool hadData = iPrivate->complete();
+
+    // Pages which are being read will still end up in the cache
+    const QByteArray uid(iPrivate->uid());
+
+    if (!uid.isEmpty()) {
+        NfcTagCache::get()->remove(NfcTagCache::Type2, uid);
+    }
+    iPrivate->clearCache();
+    if (hadSize) {
+        Q_EMIT sizeChanged();
+    }
+    if (hadData) {
+        Q_EMIT dataChanged();
+    }
+}
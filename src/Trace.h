@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TRACE_H
+#define QNFCDC_TRACE_H
+
+// Static tracepoints. Unlike HDEBUG, these are compiled into release
+// builds configured with CONFIG+=usdt, in which case each of them is a
+// single nop until something (perf, bpftrace, SystemTap) attaches to
+// it. Otherwise they expand to nothing. The provider is "qnfcdc", e.g.
+//
+//   bpftrace -e 'usdt:/usr/lib/libqnfcdc.so.1:qnfcdc:tag_path
+//                { printf("%s\n", str(arg1)); }'
+//
+// Integer arguments are libgnfcdc property ids, modes, techs and such.
+// Strings are passed as const char* and may be NULL.
+
+#ifdef QNFCDC_USDT
+#  include <sys/sdt.h>
+#  define HTRACE(probe) DTRACE_PROBE(qnfcdc, probe)
+#  define HTRACE1(probe,a) DTRACE_PROBE1(qnfcdc, probe, a)
+#  define HTRACE2(probe,a,b) DTRACE_PROBE2(qnfcdc, probe, a, b)
+#  define HTRACE3(probe,a,b,c) DTRACE_PROBE3(qnfcdc, probe, a, b, c)
+#else
+#  define HTRACE(probe) ((void)0)
+#  define HTRACE1(probe,a) ((void)0)
+#  define HTRACE2(probe,a,b) ((void)0)
+#  define HTRACE3(probe,a,b,c) ((void)0)
+#endif // QNFCDC_USDT
+
+#endif // QNFCDC_TRACE_H
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcSignalTable.h"
+
+#include <QtTest>
+
+// Queued emission of a signal looked up by name on every call (what
+// QMetaObject::invokeMethod does) vs the QMetaMethod resolved once.
+// Each iteration queues a batch of events and delivers them, so that
+// the event queue doesn't grow and the delivery is accounted for too.
+
+#define BATCH (1000)
+
+class Sender :
+    public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void changed();
+    void done(int, QByteArray);
+};
+
+class BenchDispatch :
+    public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchDispatch() : iCount(0) {}
+
+private Q_SLOTS:
+    void initTestCase();
+    void queued_data();
+    void queued();
+    void queuedArgs_data();
+    void queuedArgs();
+
+    void onChanged() { iCount++; }
+    void onDone(int, QByteArray) { iCount++; }
+
+private:
+    enum Method {
+        ByName,
+        Resolved,
+        Table
+    };
+
+    void flush(int);
+
+private:
+    Sender iSender;
+    int iCount;
+};
+
+void
+BenchDispatch::initTestCase()
+{
+    connect(&iSender, SIGNAL(changed()), SLOT(onChanged()));
+    connect(&iSender, SIGNAL(done(int,QByteArray)),
+        SLOT(onDone(int,QByteArray)));
+}
+
+void
+BenchDispatch::flush(
+    int aExpected)
+{
+    QCoreApplication::sendPostedEvents();
+    QCOMPARE(iCount, aExpected);
+    iCount = 0;
+}
+
+void
+BenchDispatch::queued_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("invokeMethod") << (int)ByName;
+    QTest::newRow("QMetaMethod") << (int)Resolved;
+    QTest::newRow("NfcSignalTable") << (int)Table;
+}
+
+void
+BenchDispatch::queued()
+{
+    typedef NfcSignalTable<Sender> SignalTable;
+    static const SignalTable::Signal SENDER_SIGNAL[] = { &Sender::changed };
+    static const SignalTable table(SENDER_SIGNAL, 1);
+    static const QMetaMethod changed(QMetaMethod::fromSignal(
+        &Sender::changed));
+
+    QFETCH(int, method);
+
+    switch (method) {
+    case ByName:
+        QBENCHMARK {
+            for (int i = 0; i < BATCH; i++) {
+                QMetaObject::invokeMethod(&iSender, "changed",
+                    Qt::QueuedConnection);
+            }
+            flush(BATCH);
+        }
+        break;
+    case Resolved:
+        QBENCHMARK {
+            for (int i = 0; i < BATCH; i++) {
+                changed.invoke(&iSender, Qt::QueuedConnection);
+            }
+            flush(BATCH);
+        }
+        break;
+    case Table:
+        QBENCHMARK {
+            for (int i = 0; i < BATCH; i++) {
+                table.emitQueued(&iSender, 0);
+            }
+            flush(BATCH);
+        }
+        break;
+    }
+}
+
+void
+BenchDispatch::queuedArgs_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("invokeMethod") << (int)ByName;
+    QTest::newRow("QMetaMethod") << (int)Resolved;
+}
+
+void
+BenchDispatch::queuedArgs()
+{
+    static const QMetaMethod done(QMetaMethod::fromSignal(&Sender::done));
+    const QByteArray data(16, 'x');
+
+    QFETCH(int, method);
+
+    if (method == ByName) {
+        QBENCHMARK {
+            for (int i = 0; i < BATCH; i++) {
+                QMetaObject::invokeMethod(&iSender, "done",
+                    Qt::QueuedConnection, Q_ARG(int, i),
+                    Q_ARG(QByteArray, data));
+            }
+            flush(BATCH);
+        }
+    } else {
+        QBENCHMARK {
+            for (int i = 0; i < BATCH; i++) {
+                done.invoke(&iSender, Qt::QueuedConnection, Q_ARG(int, i),
+                    Q_ARG(QByteArray, data));
+            }
+            flush(BATCH);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchDispatch)
+#include "bench_dispatch.moc"
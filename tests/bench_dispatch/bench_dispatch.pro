@@ -0,0 +1,5 @@
+include(../common.pri)
+
+TARGET = bench_dispatch
+INCLUDEPATH += $$LIB_DIR/src
+SOURCES += bench_dispatch.cpp
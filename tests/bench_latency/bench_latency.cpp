@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcAdapter.h"
+#include "NfcEventTrace.h"
+#include "NfcMode.h"
+#include "NfcParam.h"
+#include "NfcSystem.h"
+#include "NfcTag.h"
+
+#include "NfcdMock.h"
+
+#include <QtTest>
+
+#include <glib.h>
+
+#include <algorithm>
+
+// End-to-end latency of the path from nfcd emitting a D-Bus signal to the
+// corresponding Qt signal reaching a slot. Each sample is split into two
+// hops: "dbus" (request issued to the mock until the libgnfcdc callback)
+// and "queue" (libgnfcdc callback until the queued Qt signal is emitted,
+// as recorded by NfcEventTrace). Timestamps are g_get_monotonic_time().
+//
+// Percentiles are printed after each benchmark, QBENCHMARK reports the
+// time per iteration. The number of samples can be changed with the
+// BENCH_SAMPLES environment variable.
+
+#define DEFAULT_SAMPLES 200
+#define STORM_SIZE 64
+#define WAIT_TIMEOUT_MS 5000
+
+// NFC_MODE_CARD_EMULATION
+#define MODE_CE 0x08
+
+// ==========================================================================
+// Probe - stamps the arrival of a signal
+// ==========================================================================
+
+class Probe :
+    public QObject
+{
+    Q_OBJECT
+
+public:
+    Probe(QObject* aSender, const char* aSignal);
+
+    bool wait(qint64* aTime = Q_NULLPTR);
+
+public Q_SLOTS:
+    void record();
+
+private:
+    QEventLoop iLoop;
+    QTimer iTimeout;
+    qint64 iTime;
+};
+
+Probe::Probe(
+    QObject* aSender,
+    const char* aSignal) :
+    iTime(0)
+{
+    iTimeout.setSingleShot(true);
+    iTimeout.setInterval(WAIT_TIMEOUT_MS);
+    connect(&iTimeout, SIGNAL(timeout()), &iLoop, SLOT(quit()));
+    connect(aSender, aSignal, SLOT(record()));
+}
+
+void
+Probe::record()
+{
+    if (!iTime) {
+        iTime = g_get_monotonic_time();
+    }
+    iLoop.quit();
+}
+
+bool
+Probe::wait(
+    qint64* aTime)
+{
+    if (!iTime) {
+        iTimeout.start();
+        iLoop.exec();
+        iTimeout.stop();
+    }
+    if (aTime) {
+        *aTime = iTime;
+    }
+    const bool ok = (iTime != 0);
+    iTime = 0;
+    return ok;
+}
+
+// ==========================================================================
+// Latency - collects samples and prints percentiles
+// ==========================================================================
+
+class Latency
+{
+public:
+    Latency(const char* aName);
+    ~Latency();
+
+    void add(qint64 aStart, qint64 aEnd, const char* aSignal);
+
+private:
+    static qint64 percentile(const QVector<qint64>&, int);
+    void print(const char*, QVector<qint64>) const;
+
+private:
+    const char* iName;
+    QVector<qint64> iTotal;
+    QVector<qint64> iDbus;
+    QVector<qint64> iQueue;
+};
+
+Latency::Latency(
+    const char* aName) :
+    iName(aName)
+{
+}
+
+Latency::~Latency()
+{
+    print("total", iTotal);
+    print("dbus", iDbus);
+    print("queue", iQueue);
+}
+
+void
+Latency::add(
+    qint64 aStart,
+    qint64 aEnd,
+    const char* aSignal)
+{
+    iTotal.append(aEnd - aStart);
+
+    // Find the matching NfcEventTrace sample (if any)
+    const QList<NfcEventTrace::Sample> samples(NfcEventTrace::samples());
+    for (int i = samples.count() - 1; i >= 0; i--) {
+        const NfcEventTrace::Sample& sample = samples.at(i);
+
+        if (sample.iCallbackTime >= aStart && sample.iEmitTime <= aEnd &&
+            sample.iSignal == aSignal) {
+            iDbus.append(sample.iCallbackTime - aStart);
+            iQueue.append(sample.iEmitTime - sample.iCallbackTime);
+            break;
+        }
+    }
+}
+
+qint64
+Latency::percentile(
+    const QVector<qint64>& aSorted,
+    int aPercent)
+{
+    const int n = aSorted.count();
+
+    return aSorted.at(qMin(n - 1, (n * aPercent) / 100));
+}
+
+void
+Latency::print(
+    const char* aHop,
+    QVector<qint64> aSamples) const
+{
+    if (!aSamples.isEmpty()) {
+        std::sort(aSamples.begin(), aSamples.end());
+        qDebug("%s %-5s n=%d p50=%lld p90=%lld p99=%lld max=%lld us", iName,
+            aHop, aSamples.count(), percentile(aSamples, 50),
+            percentile(aSamples, 90), percentile(aSamples, 99),
+            aSamples.last());
+    }
+}
+
+// ==========================================================================
+// BenchLatency
+// ==========================================================================
+
+class BenchLatency :
+    public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchLatency();
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+    void tagArrival();
+    void tagDeparture();
+    void tagStorm();
+    void modeRequest();
+    void paramRequest();
+
+private:
+    int iSamples;
+    NfcdMock iMock;
+};
+
+BenchLatency::BenchLatency() :
+    iSamples(qgetenv("BENCH_SAMPLES").toInt())
+{
+    if (iSamples <= 0) {
+        iSamples = DEFAULT_SAMPLES;
+    }
+}
+
+void
+BenchLatency::initTestCase()
+{
+    if (!iMock.available()) {
+        QSKIP("Mock nfcd is not running, use run-tests.sh");
+    }
+    NfcEventTrace::setEnabled(true);
+}
+
+void
+BenchLatency::init()
+{
+    QVERIFY(iMock.reset());
+    NfcEventTrace::reset();
+}
+
+void
+BenchLatency::cleanupTestCase()
+{
+    NfcEventTrace::setEnabled(false);
+    iMock.reset();
+}
+
+void
+BenchLatency::tagArrival()
+{
+    NfcAdapter adapter;
+    Probe probe(&adapter, SIGNAL(tagPathChanged()));
+    Latency latency("tagArrival");
+
+    QTRY_VERIFY(adapter.valid());
+    for (int i = 0; i < iSamples; i++) {
+        qint64 end;
+        const qint64 start = g_get_monotonic_time();
+        const QString path(iMock.addTag());
+
+        QVERIFY(probe.wait(&end));
+        QCOMPARE(adapter.tagPath(), path);
+        latency.add(start, end, "tagPathChanged");
+        QVERIFY(iMock.removeTag(path));
+        QVERIFY(probe.wait());
+    }
+
+    QBENCHMARK {
+        const QString path(iMock.addTag());
+
+        probe.wait();
+        iMock.removeTag(path);
+        probe.wait();
+    }
+}
+
+void
+BenchLatency::tagDeparture()
+{
+    NfcAdapter adapter;
+    Probe probe(&adapter, SIGNAL(tagPathChanged()));
+    Latency latency("tagDeparture");
+
+    QTRY_VERIFY(adapter.valid());
+    for (int i = 0; i < iSamples; i++) {
+        const QString path(iMock.addTag());
+        QVERIFY(probe.wait());
+
+        NfcTag tag;
+        Probe tagProbe(&tag, SIGNAL(presentChanged()));
+        tag.setPath(path);
+        QTRY_VERIFY(tag.present());
+
+        qint64 end;
+        const qint64 start = g_get_monotonic_time();
+        QVERIFY(iMock.removeTag(path));
+        QVERIFY(tagProbe.wait(&end));
+        QVERIFY(!tag.present());
+        latency.add(start, end, "presentChanged");
+        QVERIFY(probe.wait());
+    }
+}
+
+void
+BenchLatency::tagStorm()
+{
+    // STORM_SIZE arrivals and departures back to back, followed by a
+    // sentinel tag. Reports the time until the sentinel shows up.
+    NfcAdapter adapter;
+    Latency latency("tagStorm");
+
+    QTRY_VERIFY(adapter.valid());
+    QBENCHMARK {
+        Probe probe(&adapter, SIGNAL(tagPathChanged()));
+        const qint64 start = g_get_monotonic_time();
+
+        for (int i = 0; i < STORM_SIZE; i++) {
+            iMock.removeTag(iMock.addTag());
+        }
+
+        const QString sentinel(iMock.addTag());
+        qint64 end = 0;
+        while (adapter.tagPath() != sentinel && probe.wait(&end));
+        QCOMPARE(adapter.tagPath(), sentinel);
+        latency.add(start, end, "tagPathChanged");
+        QVERIFY(iMock.removeTag(sentinel));
+        QTRY_VERIFY(adapter.tagPath().isEmpty());
+    }
+}
+
+void
+BenchLatency::modeRequest()
+{
+    NfcSystem system;
+    Probe probe(&system, SIGNAL(modeChanged()));
+    Latency latency("modeRequest");
+
+    QTRY_VERIFY(system.valid());
+    QVERIFY(!(system.mode() & MODE_CE));
+    for (int i = 0; i < iSamples; i++) {
+        NfcMode mode;
+        qint64 end;
+
+        mode.setEnableModes(MODE_CE);
+        const qint64 start = g_get_monotonic_time();
+        mode.setActive(true);
+        QVERIFY(probe.wait(&end));
+        QVERIFY(system.mode() & MODE_CE);
+        latency.add(start, end, "modeChanged");
+        mode.setActive(false);
+        QVERIFY(probe.wait());
+        QVERIFY(!(system.mode() & MODE_CE));
+    }
+}
+
+void
+BenchLatency::paramRequest()
+{
+    NfcAdapter adapter;
+    Probe probe(&adapter, SIGNAL(t4NdefChanged()));
+    Latency latency("paramRequest");
+
+    QTRY_VERIFY(adapter.valid());
+    QTRY_VERIFY(adapter.t4Ndef());
+    for (int i = 0; i < iSamples; i++) {
+        NfcParam param;
+        qint64 end;
+
+        param.setT4Ndef(false);
+        const qint64 start = g_get_monotonic_time();
+        param.setActive(true);
+        QVERIFY(probe.wait(&end));
+        QVERIFY(!adapter.t4Ndef());
+        latency.add(start, end, "t4NdefChanged");
+        param.setActive(false);
+        QVERIFY(probe.wait());
+        QVERIFY(adapter.t4Ndef());
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchLatency)
+#include "bench_latency.moc"
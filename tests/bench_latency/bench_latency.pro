@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = bench_latency
+SOURCES += bench_latency.cpp
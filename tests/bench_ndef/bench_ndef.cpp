@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcNdefMessage.h"
+
+#include <QtTest>
+
+// NDEF record header flags
+#define NDEF_MB 0x80
+#define NDEF_ME 0x40
+#define NDEF_CF 0x20
+#define NDEF_SR 0x10
+
+class BenchNdef :
+    public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void parse_data();
+    void parse();
+
+private:
+    static QByteArray record(uchar, NfcNdefRecord::Tnf, const QByteArray&,
+        const QByteArray&);
+    static QByteArray records(int, int);
+    static QByteArray chunked(int, int);
+};
+
+QByteArray
+BenchNdef::record(
+    uchar aFlags,
+    NfcNdefRecord::Tnf aTnf,
+    const QByteArray& aType,
+    const QByteArray& aPayload)
+{
+    QByteArray rec;
+    const int size = aPayload.size();
+    const bool sr = size < 0x100;
+
+    rec.append((char)(aFlags | (sr ? NDEF_SR : 0) | aTnf));
+    rec.append((char)aType.size());
+    if (sr) {
+        rec.append((char)size);
+    } else {
+        rec.append((char)(size >> 24));
+        rec.append((char)(size >> 16));
+        rec.append((char)(size >> 8));
+        rec.append((char)size);
+    }
+    rec.append(aType);
+    rec.append(aPayload);
+    return rec;
+}
+
+// aCount media type records, aSize bytes of payload each
+QByteArray
+BenchNdef::records(
+    int aCount,
+    int aSize)
+{
+    const QByteArray type("application/octet-stream");
+    QByteArray ndef;
+
+    for (int i = 0; i < aCount; i++) {
+        ndef.append(record((i ? 0 : NDEF_MB) | ((i == aCount - 1) ?
+            NDEF_ME : 0), NfcNdefRecord::TnfMediaType, type,
+            QByteArray(aSize, (char)i)));
+    }
+    return ndef;
+}
+
+// One record split into aCount chunks, aSize bytes each
+QByteArray
+BenchNdef::chunked(
+    int aCount,
+    int aSize)
+{
+    QByteArray ndef;
+
+    for (int i = 0; i < aCount; i++) {
+        const bool first = !i;
+        const bool last = (i == aCount - 1);
+
+        ndef.append(record((first ? NDEF_MB : 0) | (last ? NDEF_ME :
+            NDEF_CF), first ? NfcNdefRecord::TnfMediaType :
+            NfcNdefRecord::TnfUnchanged, first ? QByteArray("text/plain") :
+            QByteArray(), QByteArray(aSize, (char)i)));
+    }
+    return ndef;
+}
+
+void
+BenchNdef::parse_data()
+{
+    QTest::addColumn<QByteArray>("ndef");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("payload");
+
+    QTest::newRow("records 1000x16") << records(1000, 16) << 1000 << 16000;
+    QTest::newRow("records 100x1k") << records(100, 1024) << 100 << 102400;
+    QTest::newRow("record 32k") << records(1, 0x8000) << 1 << 0x8000;
+    QTest::newRow("record 1M") << records(1, 0x100000) << 1 << 0x100000;
+    QTest::newRow("chunked 16x4k") << chunked(16, 4096) << 1 << 65536;
+    QTest::newRow("chunked 256x255") << chunked(256, 255) << 1 << 65280;
+    QTest::newRow("chunked 4096x64") << chunked(4096, 64) << 1 << 262144;
+}
+
+void
+BenchNdef::parse()
+{
+    QFETCH(QByteArray, ndef);
+    QFETCH(int, count);
+    QFETCH(int, payload);
+
+    // Sanity check outside of the benchmark loop
+    NfcNdefMessage msg(ndef);
+    QVERIFY(msg.isValid());
+    QCOMPARE(msg.count(), count);
+
+    int total = 0;
+    for (int i = 0; i < msg.count(); i++) {
+        total += msg.at(i).payloadSize();
+    }
+    QCOMPARE(total, payload);
+
+    // Parse and touch every payload
+    QBENCHMARK {
+        NfcNdefMessage parsed(ndef);
+        int n = 0;
+
+        for (int i = 0; i < parsed.count(); i++) {
+            n += parsed.at(i).payloadData()[0];
+        }
+        Q_UNUSED(n);
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchNdef)
+#include "bench_ndef.moc"
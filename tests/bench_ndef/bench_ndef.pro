@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = bench_ndef
+SOURCES += bench_ndef.cpp
@@ -0,0 +1,25 @@
+# Common settings for tests and benchmarks. They link against the library
+# built in the top-level directory and expect run-tests.sh to provide the
+# mock nfcd (see mock/nfcd-mock.py) on a private bus.
+
+TEMPLATE = app
+CONFIG += testcase link_pkgconfig
+CONFIG -= app_bundle
+PKGCONFIG += libgnfcdc libglibutil gio-2.0
+QT += testlib
+QT -= gui
+
+QMAKE_CXXFLAGS += -Wno-unused-parameter
+
+LIB_DIR = $$PWD/..
+COMMON_DIR = $$PWD/common
+
+INCLUDEPATH += $$LIB_DIR/include $$COMMON_DIR
+LIBS += -L$$OUT_PWD/../.. -lqnfcdc
+QMAKE_RPATHDIR += $$OUT_PWD/../..
+
+HEADERS += \
+    $$COMMON_DIR/NfcdMock.h
+
+SOURCES += \
+    $$COMMON_DIR/NfcdMock.cpp
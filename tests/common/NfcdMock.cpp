@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcdMock.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <gio/gio.h>
+
+#define NFCD_SERVICE "org.sailfishos.nfc.daemon"
+#define MOCK_PATH "/mock"
+#define MOCK_INTERFACE "org.sailfishos.nfc.Mock"
+#define MOCK_TIMEOUT_MS 5000
+
+// ==========================================================================
+// NfcdMock::Private
+// ==========================================================================
+
+class NfcdMock::Private
+{
+public:
+    Private();
+    ~Private();
+
+    GVariant* call(const char*, GVariant*, const GVariantType*);
+    bool call(const char*, GVariant*);
+    QString addObject(const char*, GVariantBuilder*);
+    static void callDone(GObject*, GAsyncResult*, gpointer);
+
+    static QVariant toQVariant(GVariant*);
+
+public:
+    GDBusConnection* iBus;
+};
+
+NfcdMock::Private::Private() :
+    iBus(g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, NULL))
+{
+}
+
+NfcdMock::Private::~Private()
+{
+    if (iBus) {
+        g_object_unref(iBus);
+    }
+}
+
+GVariant*
+NfcdMock::Private::call(
+    const char* aMethod,
+    GVariant* aArgs,
+    const GVariantType* aReplyType)
+{
+    GVariant* reply = NULL;
+
+    if (iBus) {
+        GError* error = NULL;
+
+        reply = g_dbus_connection_call_sync(iBus, NFCD_SERVICE, MOCK_PATH,
+            MOCK_INTERFACE, aMethod, aArgs, aReplyType,
+            G_DBUS_CALL_FLAGS_NONE, MOCK_TIMEOUT_MS, NULL, &error);
+        if (error) {
+            qWarning() << aMethod << error->message;
+            g_error_free(error);
+        }
+    } else if (aArgs) {
+        g_variant_unref(g_variant_ref_sink(aArgs));
+    }
+    return reply;
+}
+
+bool
+NfcdMock::Private::call(
+    const char* aMethod,
+    GVariant* aArgs)
+{
+    GVariant* reply = call(aMethod, aArgs, NULL);
+
+    if (reply) {
+        g_variant_unref(reply);
+        return true;
+    }
+    return false;
+}
+
+QString
+NfcdMock::Private::addObject(
+    const char* aMethod,
+    GVariantBuilder* aOptions)
+{
+    QString path;
+    GVariant* reply = call(aMethod, g_variant_new("(a{sv})", aOptions),
+        G_VARIANT_TYPE("(o)"));
+
+    if (reply) {
+        const char* str = NULL;
+
+        g_variant_get(reply, "(&o)", &str);
+        path = QString::fromLatin1(str);
+        g_variant_unref(reply);
+    }
+    return path;
+}
+
+/* static */
+void
+NfcdMock::Private::callDone(
+    GObject* aBus,
+    GAsyncResult* aResult,
+    gpointer aReply)
+{
+    GError* error = NULL;
+    GVariant** reply = (GVariant**)aReply;
+
+    *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(aBus),
+        aResult, &error);
+    if (error) {
+        qWarning() << error->message;
+        g_error_free(error);
+        // Still need to stop waiting
+        *reply = g_variant_ref_sink(g_variant_new("()"));
+    }
+}
+
+QVariant
+NfcdMock::Private::toQVariant(
+    GVariant* aValue)
+{
+    if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_VARIANT)) {
+        GVariant* value = g_variant_get_variant(aValue);
+        QVariant result(toQVariant(value));
+
+        g_variant_unref(value);
+        return result;
+    } else if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_BOOLEAN)) {
+        return QVariant(bool(g_variant_get_boolean(aValue)));
+    } else if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_UINT32)) {
+        return QVariant(uint(g_variant_get_uint32(aValue)));
+    } else if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_BYTESTRING)) {
+        gsize size = 0;
+        const char* data = (const char*)g_variant_get_fixed_array(aValue,
+            &size, 1);
+
+        return QVariant(QByteArray(data, int(size)));
+    } else if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_OBJECT_PATH_ARRAY)) {
+        QStringList list;
+        GVariantIter it;
+        const char* path;
+
+        g_variant_iter_init(&it, aValue);
+        while (g_variant_iter_next(&it, "&o", &path)) {
+            list.append(QString::fromLatin1(path));
+        }
+        return QVariant(list);
+    } else if (g_variant_is_of_type(aValue, G_VARIANT_TYPE_VARDICT)) {
+        QVariantMap map;
+        GVariantIter it;
+        const char* key;
+        GVariant* value;
+
+        g_variant_iter_init(&it, aValue);
+        while (g_variant_iter_next(&it, "{&sv}", &key, &value)) {
+            map.insert(QString::fromLatin1(key), toQVariant(value));
+            g_variant_unref(value);
+        }
+        return QVariant(map);
+    }
+    return QVariant();
+}
+
+// ==========================================================================
+// NfcdMock
+// ==========================================================================
+
+NfcdMock::NfcdMock() :
+    iPrivate(new Private)
+{
+}
+
+NfcdMock::~NfcdMock()
+{
+    delete iPrivate;
+}
+
+bool
+NfcdMock::available() const
+{
+    GVariant* reply = iPrivate->call("GetState", NULL, NULL);
+
+    if (reply) {
+        g_variant_unref(reply);
+        return true;
+    }
+    return false;
+}
+
+QString
+NfcdMock::addTag(
+    QByteArray aNfcid1,
+    uint aType)
+{
+    GVariantBuilder options;
+
+    g_variant_builder_init(&options, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add(&options, "{sv}", "type",
+        g_variant_new_uint32(aType));
+    if (!aNfcid1.isEmpty()) {
+        GVariantBuilder poll;
+
+        g_variant_builder_init(&poll, G_VARIANT_TYPE_VARDICT);
+        g_variant_builder_add(&poll, "{sv}", "NFCID1",
+            g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                aNfcid1.constData(), aNfcid1.size(), 1));
+        g_variant_builder_add(&options, "{sv}", "poll",
+            g_variant_builder_end(&poll));
+    }
+    return iPrivate->addObject("AddTag", &options);
+}
+
+bool
+NfcdMock::removeTag(
+    QString aPath)
+{
+    return iPrivate->call("RemoveTag", g_variant_new("(o)",
+        qPrintable(aPath)));
+}
+
+QString
+NfcdMock::addPeer(
+    uint aWks)
+{
+    GVariantBuilder options;
+
+    g_variant_builder_init(&options, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add(&options, "{sv}", "wks",
+        g_variant_new_uint32(aWks));
+    return iPrivate->addObject("AddPeer", &options);
+}
+
+bool
+NfcdMock::removePeer(
+    QString aPath)
+{
+    return iPrivate->call("RemovePeer", g_variant_new("(o)",
+        qPrintable(aPath)));
+}
+
+bool
+NfcdMock::setTransceiveResponse(
+    QString aTag,
+    QByteArray aRequest,
+    QByteArray aResponse)
+{
+    return iPrivate->call("SetTransceiveResponse", g_variant_new("(o@ay@ay)",
+        qPrintable(aTag),
+        g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+            aRequest.constData(), aRequest.size(), 1),
+        g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+            aResponse.constData(), aResponse.size(), 1)));
+}
+
+bool
+NfcdMock::setEnabled(
+    bool aEnabled)
+{
+    return iPrivate->call("SetEnabled", g_variant_new("(b)", aEnabled));
+}
+
+bool
+NfcdMock::setPowered(
+    bool aPowered)
+{
+    return iPrivate->call("SetPowered", g_variant_new("(b)", aPowered));
+}
+
+QVariantMap
+NfcdMock::state()
+{
+    QVariantMap map;
+    GVariant* reply = iPrivate->call("GetState", NULL,
+        G_VARIANT_TYPE("(a{sv})"));
+
+    if (reply) {
+        GVariant* state = g_variant_get_child_value(reply, 0);
+
+        map = Private::toQVariant(state).toMap();
+        g_variant_unref(state);
+        g_variant_unref(reply);
+    }
+    return map;
+}
+
+bool
+NfcdMock::reset()
+{
+    return iPrivate->call("Reset", NULL);
+}
+
+bool
+NfcdMock::startHost(
+    QString aHost)
+{
+    return iPrivate->call("StartHost", g_variant_new("(o)",
+        qPrintable(aHost)));
+}
+
+bool
+NfcdMock::stopHost(
+    QString aHost)
+{
+    return iPrivate->call("StopHost", g_variant_new("(o)",
+        qPrintable(aHost)));
+}
+
+bool
+NfcdMock::processApdu(
+    QString aHost,
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    QByteArray aData,
+    uint aLe,
+    QByteArray* aResponse,
+    uint* aSw)
+{
+    bool ok = false;
+
+    if (iPrivate->iBus) {
+        GVariant* reply = NULL;
+
+        // The mock waits for the host service to reply
+        g_dbus_connection_call(iPrivate->iBus, NFCD_SERVICE, MOCK_PATH,
+            MOCK_INTERFACE, "ProcessApdu", g_variant_new("(oyyyy@ayu)",
+                qPrintable(aHost), aCla, aIns, aP1, aP2,
+                g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                    aData.constData(), aData.size(), 1), aLe), NULL,
+            G_DBUS_CALL_FLAGS_NONE, MOCK_TIMEOUT_MS, NULL,
+            Private::callDone, &reply);
+        while (!reply) {
+            g_main_context_iteration(NULL, TRUE);
+        }
+        if (g_variant_is_of_type(reply, G_VARIANT_TYPE("(ayyy)"))) {
+            GVariant* data = NULL;
+            guchar sw1, sw2;
+            gsize size = 0;
+            const char* bytes;
+
+            g_variant_get(reply, "(@ayyy)", &data, &sw1, &sw2);
+            bytes = (const char*)g_variant_get_fixed_array(data, &size, 1);
+            *aResponse = QByteArray(bytes, int(size));
+            *aSw = (uint(sw1) << 8) | sw2;
+            g_variant_unref(data);
+            ok = true;
+        }
+        g_variant_unref(reply);
+    }
+    return ok;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef QNFCDC_TEST_NFCD_MOCK_H
+#define QNFCDC_TEST_NFCD_MOCK_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+// Synchronous client for the org.sailfishos.nfc.Mock control interface
+// exported by tests/mock/nfcd-mock.py. Blocking calls are fine in tests,
+// they go through their own main context and don't dispatch anything
+// the library is waiting for.
+class NfcdMock
+{
+public:
+    NfcdMock();
+    ~NfcdMock();
+
+    bool available() const;
+
+    QString addTag(QByteArray aNfcid1 = QByteArray(), uint aType = 2);
+    bool removeTag(QString);
+    QString addPeer(uint aWks = 3);
+    bool removePeer(QString);
+    bool setTransceiveResponse(QString aTag, QByteArray aRequest,
+        QByteArray aResponse);
+    bool setEnabled(bool);
+    bool setPowered(bool);
+    QVariantMap state();
+    bool reset();
+
+    // Calls on the local host services registered with the mock. The
+    // APDU goes to the first one, and its handler may need the default
+    // main context, so processApdu() iterates it while waiting.
+    bool startHost(QString aHost);
+    bool stopHost(QString aHost);
+    bool processApdu(QString aHost, uchar aCla, uchar aIns, uchar aP1,
+        uchar aP2, QByteArray aData, uint aLe, QByteArray* aResponse,
+        uint* aSw);
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // QNFCDC_TEST_NFCD_MOCK_H
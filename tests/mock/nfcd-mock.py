@@ -0,0 +1,965 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026 Slava Monich <slava@monich.com>
+#
+# You may use this file under the terms of the BSD license as follows:
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+#  1. Redistributions of source code must retain the above copyright
+#     notice, this list of conditions and the following disclaimer.
+#
+#  2. Redistributions in binary form must reproduce the above copyright
+#     notice, this list of conditions and the following disclaimer
+#     in the documentation and/or other materials provided with the
+#     distribution.
+#
+#  3. Neither the names of the copyright holders nor the names of its
+#     contributors may be used to endorse or promote products derived
+#     from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation
+# are those of the authors and should not be interpreted as representing
+# any official policies, either expressed or implied.
+#
+
+"""
+Scriptable stand-in for nfcd.
+
+Owns org.sailfishos.nfc.daemon on the bus that GDBus treats as the
+system bus (i.e. whatever DBUS_SYSTEM_BUS_ADDRESS points to) and
+implements the parts of the Daemon, Adapter, Tag and Peer interfaces
+that libgnfcdc talks to. There's one adapter, no hardware and no
+polling; tags and peers appear and disappear when asked to, either
+over the org.sailfishos.nfc.Mock interface exported at /mock or by a
+script passed with --script, which is executed with the NfcdMock
+instance available as "mock":
+
+    tag = mock.add_tag(poll={"NFCID1": b"\\x04\\x11\\x22\\x33"})
+    mock.set_transceive_response(tag, b"\\x30\\x00", bytes(16))
+    mock.after(500, mock.remove_tag, tag)
+
+Local host services registered with RegisterLocalHostService can be
+driven over the same interface: StartHost and StopHost call Start and
+Stop on each of them, and ProcessApdu sends the APDU to the first one
+and returns its response.
+
+The mock prints "READY" on stdout once it owns the name, which is what
+run-tests.sh waits for.
+"""
+
+import argparse
+import sys
+
+import gi
+gi.require_version("Gio", "2.0")
+from gi.repository import Gio, GLib
+
+NFCD_SERVICE = "org.sailfishos.nfc.daemon"
+NFCD_ERROR = "org.sailfishos.nfc.Error"
+
+DAEMON_VERSION = 4
+ADAPTER_VERSION = 4
+TAG_VERSION = 4
+PEER_VERSION = 1
+LOCAL_HOST_SERVICE_INTERFACE = "org.sailfishos.nfc.LocalHostService"
+LOCAL_HOST_SERVICE_TIMEOUT_MS = 5000
+MOCK_DAEMON_VERSION = (1 << 24) | (2 << 16)  # 1.2.0
+
+# NFC_MODE_* and NFC_TECH_* as used by nfcd
+MODE_P2P_INITIATOR = 0x01
+MODE_READER_WRITER = 0x02
+MODE_P2P_TARGET = 0x04
+MODE_CARD_EMULATION = 0x08
+MODE_ALL = 0x0f
+TECH_A = 0x01
+TECH_B = 0x02
+TECH_F = 0x04
+TECH_ALL = 0x07
+
+# NFC_TECHNOLOGY_A, NFC_PROTOCOL_T2_TAG, NFC_TAG_TYPE_MIFARE_ULTRALIGHT
+DEFAULT_TECHNOLOGY = 1
+DEFAULT_PROTOCOL = 1
+DEFAULT_TAG_TYPE = 2
+
+INTROSPECTION_XML = """
+<node>
+  <interface name="org.sailfishos.nfc.Daemon">
+    <method name="GetAll">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="adapters" type="ao" direction="out"/>
+    </method>
+    <method name="GetInterfaceVersion">
+      <arg name="version" type="i" direction="out"/>
+    </method>
+    <method name="GetAdapters">
+      <arg name="adapters" type="ao" direction="out"/>
+    </method>
+    <method name="GetAll2">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="adapters" type="ao" direction="out"/>
+      <arg name="daemon_version" type="u" direction="out"/>
+    </method>
+    <method name="GetDaemonVersion">
+      <arg name="daemon_version" type="u" direction="out"/>
+    </method>
+    <method name="GetAll3">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="adapters" type="ao" direction="out"/>
+      <arg name="daemon_version" type="u" direction="out"/>
+      <arg name="mode" type="u" direction="out"/>
+    </method>
+    <method name="GetMode">
+      <arg name="mode" type="u" direction="out"/>
+    </method>
+    <method name="RequestMode">
+      <arg name="enable" type="u" direction="in"/>
+      <arg name="disable" type="u" direction="in"/>
+      <arg name="id" type="u" direction="out"/>
+    </method>
+    <method name="ReleaseMode">
+      <arg name="id" type="u" direction="in"/>
+    </method>
+    <method name="GetAll4">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="adapters" type="ao" direction="out"/>
+      <arg name="daemon_version" type="u" direction="out"/>
+      <arg name="mode" type="u" direction="out"/>
+      <arg name="techs" type="u" direction="out"/>
+    </method>
+    <method name="GetTechs">
+      <arg name="techs" type="u" direction="out"/>
+    </method>
+    <method name="RequestTechs">
+      <arg name="allow" type="u" direction="in"/>
+      <arg name="disallow" type="u" direction="in"/>
+      <arg name="id" type="u" direction="out"/>
+    </method>
+    <method name="ReleaseTechs">
+      <arg name="id" type="u" direction="in"/>
+    </method>
+    <method name="RegisterLocalHostService">
+      <arg name="path" type="o" direction="in"/>
+      <arg name="name" type="s" direction="in"/>
+    </method>
+    <method name="UnregisterLocalHostService">
+      <arg name="path" type="o" direction="in"/>
+    </method>
+    <signal name="AdaptersChanged">
+      <arg name="adapters" type="ao"/>
+    </signal>
+    <signal name="ModeChanged">
+      <arg name="mode" type="u"/>
+    </signal>
+    <signal name="TechsChanged">
+      <arg name="techs" type="u"/>
+    </signal>
+  </interface>
+  <interface name="org.sailfishos.nfc.Adapter">
+    <method name="GetAll">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="enabled" type="b" direction="out"/>
+      <arg name="powered" type="b" direction="out"/>
+      <arg name="supported_modes" type="u" direction="out"/>
+      <arg name="mode" type="u" direction="out"/>
+      <arg name="target_present" type="b" direction="out"/>
+      <arg name="tags" type="ao" direction="out"/>
+    </method>
+    <method name="GetInterfaceVersion">
+      <arg name="version" type="i" direction="out"/>
+    </method>
+    <method name="GetEnabled">
+      <arg name="enabled" type="b" direction="out"/>
+    </method>
+    <method name="GetPowered">
+      <arg name="powered" type="b" direction="out"/>
+    </method>
+    <method name="GetSupportedModes">
+      <arg name="modes" type="u" direction="out"/>
+    </method>
+    <method name="GetMode">
+      <arg name="mode" type="u" direction="out"/>
+    </method>
+    <method name="GetTargetPresent">
+      <arg name="target_present" type="b" direction="out"/>
+    </method>
+    <method name="GetTags">
+      <arg name="tags" type="ao" direction="out"/>
+    </method>
+    <method name="GetAll2">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="enabled" type="b" direction="out"/>
+      <arg name="powered" type="b" direction="out"/>
+      <arg name="supported_modes" type="u" direction="out"/>
+      <arg name="mode" type="u" direction="out"/>
+      <arg name="target_present" type="b" direction="out"/>
+      <arg name="tags" type="ao" direction="out"/>
+      <arg name="peers" type="ao" direction="out"/>
+    </method>
+    <method name="GetPeers">
+      <arg name="peers" type="ao" direction="out"/>
+    </method>
+    <method name="GetAll3">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="enabled" type="b" direction="out"/>
+      <arg name="powered" type="b" direction="out"/>
+      <arg name="supported_modes" type="u" direction="out"/>
+      <arg name="mode" type="u" direction="out"/>
+      <arg name="target_present" type="b" direction="out"/>
+      <arg name="tags" type="ao" direction="out"/>
+      <arg name="peers" type="ao" direction="out"/>
+      <arg name="hosts" type="ao" direction="out"/>
+      <arg name="supported_techs" type="u" direction="out"/>
+    </method>
+    <method name="GetHosts">
+      <arg name="hosts" type="ao" direction="out"/>
+    </method>
+    <method name="GetSupportedTechs">
+      <arg name="techs" type="u" direction="out"/>
+    </method>
+    <method name="GetParams">
+      <arg name="params" type="a{sv}" direction="out"/>
+    </method>
+    <method name="RequestParams">
+      <arg name="params" type="a{sv}" direction="in"/>
+      <arg name="reset" type="b" direction="in"/>
+      <arg name="id" type="u" direction="out"/>
+    </method>
+    <method name="ReleaseParams">
+      <arg name="id" type="u" direction="in"/>
+    </method>
+    <signal name="EnabledChanged">
+      <arg name="enabled" type="b"/>
+    </signal>
+    <signal name="PoweredChanged">
+      <arg name="powered" type="b"/>
+    </signal>
+    <signal name="ModeChanged">
+      <arg name="mode" type="u"/>
+    </signal>
+    <signal name="TargetPresentChanged">
+      <arg name="target_present" type="b"/>
+    </signal>
+    <signal name="TagsChanged">
+      <arg name="tags" type="ao"/>
+    </signal>
+    <signal name="PeersChanged">
+      <arg name="peers" type="ao"/>
+    </signal>
+    <signal name="HostsChanged">
+      <arg name="hosts" type="ao"/>
+    </signal>
+    <signal name="ParamChanged">
+      <arg name="name" type="s"/>
+      <arg name="value" type="v"/>
+    </signal>
+  </interface>
+  <interface name="org.sailfishos.nfc.Tag">
+    <method name="GetAll">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="present" type="b" direction="out"/>
+      <arg name="technology" type="u" direction="out"/>
+      <arg name="protocol" type="u" direction="out"/>
+      <arg name="type" type="u" direction="out"/>
+      <arg name="interfaces" type="as" direction="out"/>
+      <arg name="ndef_records" type="ao" direction="out"/>
+    </method>
+    <method name="GetInterfaceVersion">
+      <arg name="version" type="i" direction="out"/>
+    </method>
+    <method name="GetPresent">
+      <arg name="present" type="b" direction="out"/>
+    </method>
+    <method name="GetTechnology">
+      <arg name="technology" type="u" direction="out"/>
+    </method>
+    <method name="GetProtocol">
+      <arg name="protocol" type="u" direction="out"/>
+    </method>
+    <method name="GetType">
+      <arg name="type" type="u" direction="out"/>
+    </method>
+    <method name="GetInterfaces">
+      <arg name="interfaces" type="as" direction="out"/>
+    </method>
+    <method name="GetNdefRecords">
+      <arg name="records" type="ao" direction="out"/>
+    </method>
+    <method name="Deactivate"/>
+    <method name="Acquire">
+      <arg name="wait" type="b" direction="in"/>
+    </method>
+    <method name="Release"/>
+    <method name="GetAll3">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="present" type="b" direction="out"/>
+      <arg name="technology" type="u" direction="out"/>
+      <arg name="protocol" type="u" direction="out"/>
+      <arg name="type" type="u" direction="out"/>
+      <arg name="interfaces" type="as" direction="out"/>
+      <arg name="ndef_records" type="ao" direction="out"/>
+      <arg name="poll_parameters" type="a{sv}" direction="out"/>
+    </method>
+    <method name="GetPollParameters">
+      <arg name="poll_parameters" type="a{sv}" direction="out"/>
+    </method>
+    <method name="Transceive">
+      <arg name="data" type="ay" direction="in">
+        <annotation name="org.gtk.GDBus.C.ForceGVariant" value="true"/>
+      </arg>
+      <arg name="response" type="ay" direction="out">
+        <annotation name="org.gtk.GDBus.C.ForceGVariant" value="true"/>
+      </arg>
+    </method>
+    <signal name="Removed"/>
+  </interface>
+  <interface name="org.sailfishos.nfc.Peer">
+    <method name="GetAll">
+      <arg name="version" type="i" direction="out"/>
+      <arg name="present" type="b" direction="out"/>
+      <arg name="technology" type="u" direction="out"/>
+      <arg name="wks" type="u" direction="out"/>
+    </method>
+    <method name="GetInterfaceVersion">
+      <arg name="version" type="i" direction="out"/>
+    </method>
+    <method name="GetPresent">
+      <arg name="present" type="b" direction="out"/>
+    </method>
+    <method name="GetTechnology">
+      <arg name="technology" type="u" direction="out"/>
+    </method>
+    <method name="GetWellKnownServices">
+      <arg name="wks" type="u" direction="out"/>
+    </method>
+    <signal name="Removed"/>
+  </interface>
+  <interface name="org.sailfishos.nfc.Mock">
+    <method name="AddTag">
+      <arg name="options" type="a{sv}" direction="in"/>
+      <arg name="path" type="o" direction="out"/>
+    </method>
+    <method name="RemoveTag">
+      <arg name="path" type="o" direction="in"/>
+    </method>
+    <method name="AddPeer">
+      <arg name="options" type="a{sv}" direction="in"/>
+      <arg name="path" type="o" direction="out"/>
+    </method>
+    <method name="RemovePeer">
+      <arg name="path" type="o" direction="in"/>
+    </method>
+    <method name="SetTransceiveResponse">
+      <arg name="path" type="o" direction="in"/>
+      <arg name="request" type="ay" direction="in"/>
+      <arg name="response" type="ay" direction="in"/>
+    </method>
+    <method name="SetEnabled">
+      <arg name="enabled" type="b" direction="in"/>
+    </method>
+    <method name="SetPowered">
+      <arg name="powered" type="b" direction="in"/>
+    </method>
+    <method name="GetState">
+      <arg name="state" type="a{sv}" direction="out"/>
+    </method>
+    <method name="Reset"/>
+    <method name="StartHost">
+      <arg name="host" type="o" direction="in"/>
+    </method>
+    <method name="StopHost">
+      <arg name="host" type="o" direction="in"/>
+    </method>
+    <method name="ProcessApdu">
+      <arg name="host" type="o" direction="in"/>
+      <arg name="cla" type="y" direction="in"/>
+      <arg name="ins" type="y" direction="in"/>
+      <arg name="p1" type="y" direction="in"/>
+      <arg name="p2" type="y" direction="in"/>
+      <arg name="data" type="ay" direction="in"/>
+      <arg name="le" type="u" direction="in"/>
+      <arg name="response" type="ay" direction="out"/>
+      <arg name="sw1" type="y" direction="out"/>
+      <arg name="sw2" type="y" direction="out"/>
+    </method>
+  </interface>
+</node>
+"""
+
+NODE_INFO = Gio.DBusNodeInfo.new_for_xml(INTROSPECTION_XML)
+
+
+def interface_info(name):
+    return NODE_INFO.lookup_interface(name)
+
+
+def ay(data):
+    return GLib.Variant("ay", bytes(data))
+
+
+class Requests:
+    """Numbered requests (mode, techs or params) with a combined value"""
+
+    def __init__(self):
+        self.last_id = 0
+        self.active = {}
+
+    def add(self, value):
+        self.last_id += 1
+        self.active[self.last_id] = value
+        return self.last_id
+
+    def remove(self, req_id):
+        return self.active.pop(req_id, None) is not None
+
+    def values(self):
+        return [self.active[k] for k in sorted(self.active)]
+
+
+class Tag:
+    def __init__(self, path, options):
+        self.path = path
+        self.present = True
+        self.technology = options.get("technology", DEFAULT_TECHNOLOGY)
+        self.protocol = options.get("protocol", DEFAULT_PROTOCOL)
+        self.type = options.get("type", DEFAULT_TAG_TYPE)
+        self.interfaces = list(options.get("interfaces",
+            ["org.sailfishos.nfc.Tag"]))
+        self.poll = dict((k, bytes(v)) for k, v in
+            options.get("poll", {}).items())
+        self.responses = {}
+        self.default_response = None
+        self.transceive_count = 0
+        self.registrations = []
+
+    def poll_variant(self):
+        return dict((k, ay(v)) for k, v in self.poll.items())
+
+
+class Peer:
+    def __init__(self, path, options):
+        self.path = path
+        self.present = True
+        self.technology = options.get("technology", DEFAULT_TECHNOLOGY)
+        self.wks = options.get("wks", 0x03)
+        self.registrations = []
+
+
+class NfcdMock:
+    def __init__(self, bus, adapter_path):
+        self.bus = bus
+        self.adapter_path = adapter_path
+        self.enabled = True
+        self.powered = True
+        self.supported_modes = MODE_ALL
+        self.supported_techs = TECH_ALL
+        self.default_mode = MODE_READER_WRITER | MODE_P2P_INITIATOR
+        self.default_techs = TECH_ALL
+        self.default_params = {
+            "T4_NDEF": GLib.Variant("b", True),
+            "LA_NFCID1": ay(b""),
+            "LI_A_HB": ay(b"")
+        }
+        self.mode_requests = Requests()
+        self.tech_requests = Requests()
+        self.param_requests = Requests()
+        self.mode = self.combined_mode()
+        self.techs = self.combined_techs()
+        self.params = dict(self.default_params)
+        self.tags = []
+        self.peers = []
+        self.hosts = []
+        self.host_owners = {}
+        self.sender = None
+        self.next_tag = 0
+        self.next_peer = 0
+        self.handlers = {
+            "org.sailfishos.nfc.Daemon": self.daemon_call,
+            "org.sailfishos.nfc.Adapter": self.adapter_call,
+            "org.sailfishos.nfc.Mock": self.mock_call
+        }
+        self.register("/", "org.sailfishos.nfc.Daemon")
+        self.register(adapter_path, "org.sailfishos.nfc.Adapter")
+        self.register("/mock", "org.sailfishos.nfc.Mock")
+
+    # Plumbing
+
+    # A handler may return a function instead of the reply tuple, which
+    # then gets the invocation and completes it when it's ready.
+
+    def register(self, path, iface, handler=None):
+        def method_call(conn, sender, path, iface, method, args, inv):
+            try:
+                self.sender = sender
+                result = (handler or self.handlers[iface])(method,
+                    args.unpack(), path)
+                if callable(result):
+                    result(inv)
+                else:
+                    inv.return_value(result)
+            except MockError as error:
+                inv.return_dbus_error(NFCD_ERROR + "." + error.name,
+                    error.message)
+        return self.bus.register_object(path, interface_info(iface),
+            method_call, None, None)
+
+    def emit(self, path, iface, name, *args):
+        params = GLib.Variant.new_tuple(*args) if args else None
+        self.bus.emit_signal(None, path, iface, name, params)
+
+    def emit_adapter(self, name, *args):
+        self.emit(self.adapter_path, "org.sailfishos.nfc.Adapter", name,
+            *args)
+
+    def emit_daemon(self, name, *args):
+        self.emit("/", "org.sailfishos.nfc.Daemon", name, *args)
+
+    def after(self, ms, func, *args):
+        def fire():
+            func(*args)
+            return GLib.SOURCE_REMOVE
+        GLib.timeout_add(ms, fire)
+
+    # State
+
+    def combined_mode(self):
+        mode = self.default_mode
+        for enable, disable in self.mode_requests.values():
+            mode = (mode | enable) & ~disable
+        return mode & self.supported_modes
+
+    def combined_techs(self):
+        techs = self.default_techs
+        for allow, disallow in self.tech_requests.values():
+            techs = (techs | allow) & ~disallow
+        return techs & self.supported_techs
+
+    def combined_params(self):
+        params = dict(self.default_params)
+        for values, reset in self.param_requests.values():
+            if reset:
+                params = dict(self.default_params)
+            params.update(values)
+        return params
+
+    def update_mode(self):
+        mode = self.combined_mode()
+        if self.mode != mode:
+            self.mode = mode
+            self.emit_daemon("ModeChanged", GLib.Variant("u", mode))
+            self.emit_adapter("ModeChanged", GLib.Variant("u", mode))
+
+    def update_techs(self):
+        techs = self.combined_techs()
+        if self.techs != techs:
+            self.techs = techs
+            self.emit_daemon("TechsChanged", GLib.Variant("u", techs))
+
+    def update_params(self):
+        params = self.combined_params()
+        for name in sorted(params):
+            value = params[name]
+            if self.params.get(name) != value:
+                self.emit_adapter("ParamChanged", GLib.Variant("s", name),
+                    GLib.Variant("v", value))
+        self.params = params
+
+    def paths(self, objects):
+        return GLib.Variant("ao", [o.path for o in objects])
+
+    def update_target_present(self, was_present):
+        present = bool(self.tags or self.peers)
+        if present != was_present:
+            self.emit_adapter("TargetPresentChanged",
+                GLib.Variant("b", present))
+
+    # Tags and peers
+
+    def add_tag(self, **options):
+        was_present = bool(self.tags or self.peers)
+        self.next_tag += 1
+        tag = Tag("%s/tag%d" % (self.adapter_path, self.next_tag), options)
+        tag.registrations.append(self.register(tag.path,
+            "org.sailfishos.nfc.Tag",
+            lambda method, args, path: self.tag_call(tag, method, args)))
+        self.tags.append(tag)
+        self.emit_adapter("TagsChanged", self.paths(self.tags))
+        self.update_target_present(was_present)
+        return tag.path
+
+    def find(self, objects, path):
+        for obj in objects:
+            if obj.path == path:
+                return obj
+        raise MockError("NotFound", "No such object: " + path)
+
+    def remove_tag(self, path):
+        tag = self.find(self.tags, path)
+        was_present = True
+        tag.present = False
+        self.tags.remove(tag)
+        self.emit(tag.path, "org.sailfishos.nfc.Tag", "Removed")
+        for reg in tag.registrations:
+            self.bus.unregister_object(reg)
+        self.emit_adapter("TagsChanged", self.paths(self.tags))
+        self.update_target_present(was_present)
+
+    def add_peer(self, **options):
+        was_present = bool(self.tags or self.peers)
+        self.next_peer += 1
+        peer = Peer("%s/peer%d" % (self.adapter_path, self.next_peer),
+            options)
+        peer.registrations.append(self.register(peer.path,
+            "org.sailfishos.nfc.Peer",
+            lambda method, args, path: self.peer_call(peer, method, args)))
+        self.peers.append(peer)
+        self.emit_adapter("PeersChanged", self.paths(self.peers))
+        self.update_target_present(was_present)
+        return peer.path
+
+    def remove_peer(self, path):
+        peer = self.find(self.peers, path)
+        peer.present = False
+        self.peers.remove(peer)
+        self.emit(peer.path, "org.sailfishos.nfc.Peer", "Removed")
+        for reg in peer.registrations:
+            self.bus.unregister_object(reg)
+        self.emit_adapter("PeersChanged", self.paths(self.peers))
+        self.update_target_present(True)
+
+    def set_transceive_response(self, path, request, response):
+        tag = self.find(self.tags, path)
+        if request:
+            tag.responses[bytes(request)] = bytes(response)
+        else:
+            tag.default_response = bytes(response)
+
+    def set_enabled(self, enabled):
+        if self.enabled != enabled:
+            self.enabled = enabled
+            self.emit_adapter("EnabledChanged", GLib.Variant("b", enabled))
+
+    def set_powered(self, powered):
+        if self.powered != powered:
+            self.powered = powered
+            self.emit_adapter("PoweredChanged", GLib.Variant("b", powered))
+
+    # Local host services
+
+    def call_hosts(self, method, host):
+        for path in self.hosts:
+            self.bus.call(self.host_owners[path], path,
+                LOCAL_HOST_SERVICE_INTERFACE, method,
+                GLib.Variant("(o)", (host,)), None,
+                Gio.DBusCallFlags.NONE, LOCAL_HOST_SERVICE_TIMEOUT_MS,
+                None, None, None)
+
+    def process_apdu(self, inv, host, cla, ins, p1, p2, data, le):
+        if not self.hosts:
+            inv.return_dbus_error(NFCD_ERROR + ".NotFound",
+                "No local host service")
+            return
+        path = self.hosts[0]
+
+        def done(conn, result, user_data):
+            try:
+                response, sw1, sw2, response_id = \
+                    conn.call_finish(result).unpack()
+                inv.return_value(GLib.Variant("(ayyy)",
+                    (bytes(response), sw1, sw2)))
+            except GLib.Error as error:
+                inv.return_dbus_error(NFCD_ERROR + ".Failed",
+                    error.message)
+        self.bus.call(self.host_owners[path], path,
+            LOCAL_HOST_SERVICE_INTERFACE, "Process",
+            GLib.Variant("(oyyyyayu)", (host, cla, ins, p1, p2,
+                bytes(data), le)), GLib.VariantType.new("(ayyyu)"),
+            Gio.DBusCallFlags.NONE, LOCAL_HOST_SERVICE_TIMEOUT_MS, None,
+            done, None)
+
+    def reset(self):
+        for tag in list(self.tags):
+            self.remove_tag(tag.path)
+        for peer in list(self.peers):
+            self.remove_peer(peer.path)
+        self.mode_requests.active.clear()
+        self.tech_requests.active.clear()
+        self.param_requests.active.clear()
+        self.update_mode()
+        self.update_techs()
+        self.update_params()
+
+    # Method handlers. Each returns the reply tuple or None.
+
+    def daemon_call(self, method, args, path):
+        adapters = GLib.Variant("ao", [self.adapter_path])
+        version = GLib.Variant("i", DAEMON_VERSION)
+        daemon_version = GLib.Variant("u", MOCK_DAEMON_VERSION)
+        mode = GLib.Variant("u", self.mode)
+        techs = GLib.Variant("u", self.techs)
+        if method == "GetAll":
+            return GLib.Variant.new_tuple(version, adapters)
+        elif method == "GetInterfaceVersion":
+            return GLib.Variant.new_tuple(version)
+        elif method == "GetAdapters":
+            return GLib.Variant.new_tuple(adapters)
+        elif method == "GetAll2":
+            return GLib.Variant.new_tuple(version, adapters, daemon_version)
+        elif method == "GetDaemonVersion":
+            return GLib.Variant.new_tuple(daemon_version)
+        elif method == "GetAll3":
+            return GLib.Variant.new_tuple(version, adapters, daemon_version,
+                mode)
+        elif method == "GetMode":
+            return GLib.Variant.new_tuple(mode)
+        elif method == "RequestMode":
+            req_id = self.mode_requests.add(args)
+            self.update_mode()
+            return GLib.Variant("(u)", (req_id,))
+        elif method == "ReleaseMode":
+            if not self.mode_requests.remove(args[0]):
+                raise MockError("NotFound", "Invalid mode request id")
+            self.update_mode()
+        elif method == "GetAll4":
+            return GLib.Variant.new_tuple(version, adapters, daemon_version,
+                mode, techs)
+        elif method == "GetTechs":
+            return GLib.Variant.new_tuple(techs)
+        elif method == "RequestTechs":
+            req_id = self.tech_requests.add(args)
+            self.update_techs()
+            return GLib.Variant("(u)", (req_id,))
+        elif method == "ReleaseTechs":
+            if not self.tech_requests.remove(args[0]):
+                raise MockError("NotFound", "Invalid techs request id")
+            self.update_techs()
+        elif method == "RegisterLocalHostService":
+            if args[0] in self.hosts:
+                raise MockError("AlreadyExists", "Already registered")
+            self.hosts.append(args[0])
+            self.host_owners[args[0]] = self.sender
+            self.emit_adapter("HostsChanged",
+                GLib.Variant("ao", self.hosts))
+        elif method == "UnregisterLocalHostService":
+            if args[0] not in self.hosts:
+                raise MockError("NotFound", "Not registered")
+            self.hosts.remove(args[0])
+            del self.host_owners[args[0]]
+            self.emit_adapter("HostsChanged",
+                GLib.Variant("ao", self.hosts))
+        else:
+            raise MockError("NotSupported", method)
+        return None
+
+    def adapter_call(self, method, args, path):
+        version = GLib.Variant("i", ADAPTER_VERSION)
+        common = [version, GLib.Variant("b", self.enabled),
+            GLib.Variant("b", self.powered),
+            GLib.Variant("u", self.supported_modes),
+            GLib.Variant("u", self.mode),
+            GLib.Variant("b", bool(self.tags or self.peers)),
+            self.paths(self.tags)]
+        if method == "GetAll":
+            return GLib.Variant.new_tuple(*common)
+        elif method == "GetAll2":
+            return GLib.Variant.new_tuple(*(common + [self.paths(self.peers)]))
+        elif method == "GetAll3":
+            return GLib.Variant.new_tuple(*(common + [self.paths(self.peers),
+                GLib.Variant("ao", self.hosts),
+                GLib.Variant("u", self.supported_techs)]))
+        elif method == "GetInterfaceVersion":
+            return GLib.Variant.new_tuple(version)
+        elif method == "GetEnabled":
+            return GLib.Variant.new_tuple(common[1])
+        elif method == "GetPowered":
+            return GLib.Variant.new_tuple(common[2])
+        elif method == "GetSupportedModes":
+            return GLib.Variant.new_tuple(common[3])
+        elif method == "GetMode":
+            return GLib.Variant.new_tuple(common[4])
+        elif method == "GetTargetPresent":
+            return GLib.Variant.new_tuple(common[5])
+        elif method == "GetTags":
+            return GLib.Variant.new_tuple(common[6])
+        elif method == "GetPeers":
+            return GLib.Variant.new_tuple(self.paths(self.peers))
+        elif method == "GetHosts":
+            return GLib.Variant.new_tuple(GLib.Variant("ao", self.hosts))
+        elif method == "GetSupportedTechs":
+            return GLib.Variant.new_tuple(
+                GLib.Variant("u", self.supported_techs))
+        elif method == "GetParams":
+            return GLib.Variant.new_tuple(GLib.Variant("a{sv}", self.params))
+        elif method == "RequestParams":
+            values, reset = args
+            for name in values:
+                if name not in self.default_params:
+                    raise MockError("NotSupported", "Unknown param " + name)
+            variants = dict((k, GLib.Variant(
+                self.default_params[k].get_type_string(), v))
+                for k, v in values.items())
+            req_id = self.param_requests.add((variants, reset))
+            self.update_params()
+            return GLib.Variant("(u)", (req_id,))
+        elif method == "ReleaseParams":
+            if not self.param_requests.remove(args[0]):
+                raise MockError("NotFound", "Invalid params request id")
+            self.update_params()
+        else:
+            raise MockError("NotSupported", method)
+        return None
+
+    def tag_call(self, tag, method, args):
+        version = GLib.Variant("i", TAG_VERSION)
+        common = [version, GLib.Variant("b", tag.present),
+            GLib.Variant("u", tag.technology),
+            GLib.Variant("u", tag.protocol),
+            GLib.Variant("u", tag.type),
+            GLib.Variant("as", tag.interfaces),
+            GLib.Variant("ao", [])]
+        if method == "GetAll":
+            return GLib.Variant.new_tuple(*common)
+        elif method == "GetAll3":
+            return GLib.Variant.new_tuple(*(common +
+                [GLib.Variant("a{sv}", tag.poll_variant())]))
+        elif method == "GetInterfaceVersion":
+            return GLib.Variant.new_tuple(version)
+        elif method == "GetPresent":
+            return GLib.Variant.new_tuple(common[1])
+        elif method == "GetTechnology":
+            return GLib.Variant.new_tuple(common[2])
+        elif method == "GetProtocol":
+            return GLib.Variant.new_tuple(common[3])
+        elif method == "GetType":
+            return GLib.Variant.new_tuple(common[4])
+        elif method == "GetInterfaces":
+            return GLib.Variant.new_tuple(common[5])
+        elif method == "GetNdefRecords":
+            return GLib.Variant.new_tuple(common[6])
+        elif method == "GetPollParameters":
+            return GLib.Variant.new_tuple(GLib.Variant("a{sv}",
+                tag.poll_variant()))
+        elif method in ("Deactivate", "Acquire", "Release"):
+            return None
+        elif method == "Transceive":
+            tag.transceive_count += 1
+            response = tag.responses.get(bytes(args[0]),
+                tag.default_response)
+            if response is None:
+                raise MockError("Failed", "No response")
+            return GLib.Variant.new_tuple(ay(response))
+        raise MockError("NotSupported", method)
+
+    def peer_call(self, peer, method, args):
+        version = GLib.Variant("i", PEER_VERSION)
+        common = [version, GLib.Variant("b", peer.present),
+            GLib.Variant("u", peer.technology),
+            GLib.Variant("u", peer.wks)]
+        if method == "GetAll":
+            return GLib.Variant.new_tuple(*common)
+        elif method == "GetInterfaceVersion":
+            return GLib.Variant.new_tuple(version)
+        elif method == "GetPresent":
+            return GLib.Variant.new_tuple(common[1])
+        elif method == "GetTechnology":
+            return GLib.Variant.new_tuple(common[2])
+        elif method == "GetWellKnownServices":
+            return GLib.Variant.new_tuple(common[3])
+        raise MockError("NotSupported", method)
+
+    def mock_call(self, method, args, path):
+        if method == "AddTag":
+            return GLib.Variant("(o)", (self.add_tag(**args[0]),))
+        elif method == "RemoveTag":
+            self.remove_tag(args[0])
+        elif method == "AddPeer":
+            return GLib.Variant("(o)", (self.add_peer(**args[0]),))
+        elif method == "RemovePeer":
+            self.remove_peer(args[0])
+        elif method == "SetTransceiveResponse":
+            self.set_transceive_response(*args)
+        elif method == "SetEnabled":
+            self.set_enabled(args[0])
+        elif method == "SetPowered":
+            self.set_powered(args[0])
+        elif method == "GetState":
+            return GLib.Variant.new_tuple(GLib.Variant("a{sv}", {
+                "mode": GLib.Variant("u", self.mode),
+                "techs": GLib.Variant("u", self.techs),
+                "params": GLib.Variant("a{sv}", self.params),
+                "modeRequests": GLib.Variant("u",
+                    len(self.mode_requests.active)),
+                "techRequests": GLib.Variant("u",
+                    len(self.tech_requests.active)),
+                "paramRequests": GLib.Variant("u",
+                    len(self.param_requests.active)),
+                "hosts": GLib.Variant("ao", self.hosts),
+                "transceiveCount": GLib.Variant("u",
+                    sum(t.transceive_count for t in self.tags))}))
+        elif method == "Reset":
+            self.reset()
+        elif method == "StartHost":
+            self.call_hosts("Start", args[0])
+        elif method == "StopHost":
+            self.call_hosts("Stop", args[0])
+        elif method == "ProcessApdu":
+            return lambda inv: self.process_apdu(inv, *args)
+        else:
+            raise MockError("NotSupported", method)
+        return None
+
+
+class MockError(Exception):
+    def __init__(self, name, message):
+        Exception.__init__(self, message)
+        self.name = name
+        self.message = message
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--adapter", default="/nfc0",
+        help="adapter object path (default: %(default)s)")
+    parser.add_argument("--script", help="python script to run at startup")
+    args = parser.parse_args()
+
+    loop = GLib.MainLoop()
+    bus = Gio.bus_get_sync(Gio.BusType.SYSTEM, None)
+    mock = NfcdMock(bus, args.adapter)
+
+    def name_acquired(conn, name):
+        if args.script:
+            with open(args.script) as f:
+                exec(compile(f.read(), args.script, "exec"), {"mock": mock,
+                    "GLib": GLib})
+        print("READY", flush=True)
+
+    def name_lost(conn, name):
+        print("Failed to own " + name, file=sys.stderr)
+        loop.quit()
+
+    Gio.bus_own_name_on_connection(bus, NFCD_SERVICE,
+        Gio.BusNameOwnerFlags.NONE, name_acquired, name_lost)
+    try:
+        loop.run()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
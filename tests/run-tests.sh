@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+# Runs the tests (and benchmarks) against the mock nfcd on a private
+# dbus-daemon instance. The library and the tests must be built first:
+#
+#   qmake && make && cd tests && qmake && make && ./run-tests.sh
+#
+# Without arguments, runs all test_* and bench_* binaries found under
+# the current directory. Otherwise runs the specified ones, passing
+# QtTest options after "--", e.g.
+#
+#   ./run-tests.sh bench_latency/bench_latency -- -iterations 100
+#
+# Set MOCK_SCRIPT to have nfcd-mock.py run a startup script.
+
+TESTS_DIR=$(cd "$(dirname "$0")" && pwd)
+MOCK="$TESTS_DIR/mock/nfcd-mock.py"
+BUS_ADDRESS_FILE=$(mktemp)
+BUS_PID_FILE=$(mktemp)
+MOCK_LOG=$(mktemp)
+
+cleanup() {
+    [ -n "$MOCK_PID" ] && kill "$MOCK_PID" 2>/dev/null
+    [ -s "$BUS_PID_FILE" ] && kill "$(cat "$BUS_PID_FILE")" 2>/dev/null
+    rm -f "$BUS_ADDRESS_FILE" "$BUS_PID_FILE" "$MOCK_LOG"
+}
+trap cleanup EXIT INT TERM
+
+BINARIES=
+OPTIONS=
+while [ $# -gt 0 ]; do
+    if [ "$1" = "--" ]; then
+        shift
+        OPTIONS="$*"
+        break
+    fi
+    BINARIES="$BINARIES $1"
+    shift
+done
+if [ -z "$BINARIES" ]; then
+    BINARIES=$(find . -type f -perm -u+x \( -name 'test_*' -o \
+        -name 'bench_*' \) | sort)
+fi
+if [ -z "$BINARIES" ]; then
+    echo "Nothing to run, build the tests first" >&2
+    exit 1
+fi
+
+# The private bus plays the role of the system bus, both for the mock
+# and for libgnfcdc (GDBus honors DBUS_SYSTEM_BUS_ADDRESS)
+dbus-daemon --session --fork --print-address=3 --print-pid=4 \
+    3>"$BUS_ADDRESS_FILE" 4>"$BUS_PID_FILE" || exit 1
+DBUS_SYSTEM_BUS_ADDRESS=$(head -n 1 "$BUS_ADDRESS_FILE")
+export DBUS_SYSTEM_BUS_ADDRESS
+
+if [ -n "$MOCK_SCRIPT" ]; then
+    python3 "$MOCK" --script "$MOCK_SCRIPT" >"$MOCK_LOG" 2>&1 &
+else
+    python3 "$MOCK" >"$MOCK_LOG" 2>&1 &
+fi
+MOCK_PID=$!
+
+# Wait for the mock to own its name
+i=0
+until grep -q READY "$MOCK_LOG"; do
+    i=$((i + 1))
+    if [ $i -gt 50 ] || ! kill -0 $MOCK_PID 2>/dev/null; then
+        echo "Mock nfcd failed to start:" >&2
+        cat "$MOCK_LOG" >&2
+        exit 1
+    fi
+    sleep 0.1
+done
+
+RESULT=0
+for b in $BINARIES; do
+    echo "========== $b"
+    # shellcheck disable=SC2086
+    "$b" $OPTIONS || RESULT=1
+done
+exit $RESULT
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcAdapter.h"
+#include "NfcMode.h"
+#include "NfcParam.h"
+#include "NfcSystem.h"
+#include "NfcTag.h"
+
+#include "NfcdMock.h"
+
+#include <QtTest>
+
+// NFC_MODE_CARD_EMULATION and NFC_MODE_READER_WRITER
+#define MODE_CE 0x08
+#define MODE_RW 0x02
+
+class TestAdapter :
+    public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+    void basic();
+    void enabled();
+    void tagArrival();
+    void tagIdentity();
+    void transceive();
+    void peer();
+    void mode();
+    void param();
+
+private:
+    NfcdMock iMock;
+};
+
+void
+TestAdapter::initTestCase()
+{
+    if (!iMock.available()) {
+        QSKIP("Mock nfcd is not running, use run-tests.sh");
+    }
+}
+
+void
+TestAdapter::init()
+{
+    QVERIFY(iMock.reset());
+    QVERIFY(iMock.setEnabled(true));
+    QVERIFY(iMock.setPowered(true));
+}
+
+void
+TestAdapter::cleanupTestCase()
+{
+    iMock.reset();
+}
+
+void
+TestAdapter::basic()
+{
+    NfcSystem system;
+    NfcAdapter adapter;
+
+    QTRY_VERIFY(system.valid());
+    QVERIFY(system.present());
+    QCOMPARE(system.adapters(), QStringList(QStringLiteral("/nfc0")));
+    QTRY_VERIFY(adapter.valid());
+    QVERIFY(adapter.present());
+    QCOMPARE(adapter.path(), QStringLiteral("/nfc0"));
+    QVERIFY(adapter.enabled());
+    QVERIFY(adapter.powered());
+    QVERIFY(!adapter.targetPresent());
+    QVERIFY(adapter.tagPath().isEmpty());
+}
+
+void
+TestAdapter::enabled()
+{
+    NfcAdapter adapter;
+    QSignalSpy enabledChanged(&adapter, SIGNAL(enabledChanged()));
+
+    QTRY_VERIFY(adapter.valid());
+    QVERIFY(adapter.enabled());
+    QVERIFY(iMock.setEnabled(false));
+    QTRY_VERIFY(!adapter.enabled());
+    QCOMPARE(enabledChanged.count(), 1);
+    QVERIFY(iMock.setEnabled(true));
+    QTRY_VERIFY(adapter.enabled());
+    QCOMPARE(enabledChanged.count(), 2);
+}
+
+void
+TestAdapter::tagArrival()
+{
+    NfcAdapter adapter;
+    QSignalSpy tagPathChanged(&adapter, SIGNAL(tagPathChanged()));
+    QSignalSpy stateChanged(&adapter, SIGNAL(stateChanged()));
+
+    QTRY_VERIFY(adapter.valid());
+    stateChanged.clear();
+
+    const QString path(iMock.addTag());
+    QVERIFY(!path.isEmpty());
+    QTRY_COMPARE(adapter.tagPath(), path);
+    QTRY_VERIFY(adapter.targetPresent());
+    QCOMPARE(tagPathChanged.count(), 1);
+    QCOMPARE(adapter.state().tagPath(), path);
+    QVERIFY(adapter.state().targetPresent());
+
+    // The mock reports tags and target presence in separate messages,
+    // i.e. at most one snapshot per message
+    QVERIFY(stateChanged.count() >= 1);
+    QVERIFY(stateChanged.count() <= 2);
+
+    NfcTag tag;
+    QSignalSpy presentChanged(&tag, SIGNAL(presentChanged()));
+
+    tag.setPath(path);
+    QTRY_VERIFY(tag.valid());
+    QVERIFY(tag.present());
+
+    QVERIFY(iMock.removeTag(path));
+    QTRY_VERIFY(adapter.tagPath().isEmpty());
+    QTRY_VERIFY(!tag.present());
+    QTRY_VERIFY(!adapter.targetPresent());
+    QCOMPARE(tagPathChanged.count(), 2);
+}
+
+void
+TestAdapter::tagIdentity()
+{
+    const QByteArray nfcid1(QByteArray::fromHex("04112233445566"));
+    const QString path(iMock.addTag(nfcid1));
+    NfcTag tag;
+
+    QVERIFY(!path.isEmpty());
+    tag.setPath(path);
+    QTRY_VERIFY(tag.valid());
+
+    // Identification data is fetched on first access
+    QSignalSpy identityChanged(&tag, SIGNAL(identityChanged()));
+    tag.uid();
+    QTRY_COMPARE(tag.uid(), nfcid1);
+    QCOMPARE(tag.technology(), 1);
+    QCOMPARE(tag.tagType(), 2);
+    QCOMPARE(tag.pollParameter(QStringLiteral("NFCID1")), nfcid1);
+    QVERIFY(identityChanged.count() > 0);
+}
+
+void
+TestAdapter::transceive()
+{
+    const QByteArray request(QByteArray::fromHex("3000"));
+    const QByteArray response(QByteArray::fromHex(
+        "04112233445566778899aabbccddeeff"));
+    const QString path(iMock.addTag());
+    NfcTag tag;
+    QSignalSpy done(&tag, SIGNAL(transceiveDone(int,QByteArray,qint64)));
+    QSignalSpy failed(&tag, SIGNAL(transceiveFailed(int)));
+
+    QVERIFY(!path.isEmpty());
+    QVERIFY(iMock.setTransceiveResponse(path, request, response));
+    tag.setPath(path);
+    QTRY_VERIFY(tag.present());
+
+    const int id = tag.transceive(request);
+    QVERIFY(id);
+    QTRY_COMPARE(done.count(), 1);
+    QCOMPARE(done.at(0).at(0).toInt(), id);
+    QCOMPARE(done.at(0).at(1).toByteArray(), response);
+
+    // No response is configured for this one
+    const int id2 = tag.transceive(QByteArray::fromHex("3004"));
+    QVERIFY(id2);
+    QTRY_COMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(0).toInt(), id2);
+    QCOMPARE(done.count(), 1);
+    QCOMPARE(iMock.state().value(QStringLiteral("transceiveCount")).toUInt(),
+        2u);
+}
+
+void
+TestAdapter::peer()
+{
+    NfcAdapter adapter;
+
+    QTRY_VERIFY(adapter.valid());
+
+    const QString path(iMock.addPeer());
+    QVERIFY(!path.isEmpty());
+    QTRY_COMPARE(adapter.peerPath(), path);
+    QVERIFY(iMock.removePeer(path));
+    QTRY_VERIFY(adapter.peerPath().isEmpty());
+}
+
+void
+TestAdapter::mode()
+{
+    NfcSystem system;
+    NfcAdapter adapter;
+
+    QTRY_VERIFY(system.valid());
+    QTRY_VERIFY(adapter.valid());
+    QVERIFY(!(system.mode() & MODE_CE));
+
+    NfcMode* mode = new NfcMode(this);
+    mode->setEnableModes(MODE_CE);
+    mode->setDisableModes(MODE_RW);
+    mode->setActive(true);
+    QTRY_VERIFY(system.mode() & MODE_CE);
+    QTRY_VERIFY(adapter.mode() & MODE_CE);
+    QVERIFY(!(system.mode() & MODE_RW));
+    QCOMPARE(iMock.state().value(QStringLiteral("modeRequests")).toUInt(),
+        1u);
+
+    // Deleting the request releases it
+    delete mode;
+    QTRY_VERIFY(!(system.mode() & MODE_CE));
+    QTRY_VERIFY(system.mode() & MODE_RW);
+    QTRY_COMPARE(iMock.state().value(QStringLiteral("modeRequests")).toUInt(),
+        0u);
+}
+
+void
+TestAdapter::param()
+{
+    NfcAdapter adapter;
+
+    QTRY_VERIFY(adapter.valid());
+    QTRY_VERIFY(adapter.t4Ndef());
+
+    NfcParam param;
+    param.setT4Ndef(false);
+    param.setLaNfcid1(QStringLiteral("01020304"));
+    param.setActive(true);
+    QTRY_VERIFY(!adapter.t4Ndef());
+    QTRY_COMPARE(adapter.laNfcid1(), QStringLiteral("01020304"));
+
+    param.setActive(false);
+    QTRY_VERIFY(adapter.t4Ndef());
+    QTRY_VERIFY(adapter.laNfcid1().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestAdapter)
+#include "test_adapter.moc"
@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = test_adapter
+SOURCES += test_adapter.cpp
@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcAidRouter.h"
+
+#include <QtTest>
+
+#define ISO_CLA (0x00)
+#define ISO_INS_SELECT (0xa4)
+#define ISO_INS_GET_DATA (0xca)
+#define ISO_P1_SELECT_BY_NAME (0x04)
+#define ISO_P2_SELECT_FIRST (0x00)
+#define ISO_P2_SELECT_NEXT (0x02)
+#define ISO_SW_OK (0x9000)
+#define ISO_SW_CONDITIONS_NOT_SATISFIED (0x6985)
+#define ISO_SW_FILE_NOT_FOUND (0x6a82)
+#define ISO_SW_INS_NOT_SUPPORTED (0x6d00)
+
+static const QByteArray AID_1(QByteArray::fromHex("a000000001"));
+static const QByteArray AID_1_1(QByteArray::fromHex("a00000000101"));
+static const QByteArray AID_1_2(QByteArray::fromHex("a00000000102"));
+static const QByteArray AID_2(QByteArray::fromHex("a000000002"));
+
+// ==========================================================================
+// TestApp
+// ==========================================================================
+
+class TestApp :
+    public NfcHost::Handler
+{
+public:
+    TestApp(const QByteArray& aName) : iName(aName), iSelectSw(ISO_SW_OK),
+        iDelay(0), iApduCount(0), iResetCount(0), iLastIns(0),
+        iLastP2(0) {}
+
+    uint processApdu(NfcHost*, uchar, uchar, uchar, uchar, const QByteArray&,
+        uint, NfcHost::Response*) Q_DECL_OVERRIDE;
+    void hostReset(NfcHost*) Q_DECL_OVERRIDE;
+
+public:
+    const QByteArray iName;
+    uint iSelectSw;
+    ulong iDelay;       // Microseconds
+    int iApduCount;
+    int iResetCount;
+    uchar iLastIns;
+    uchar iLastP2;
+    QByteArray iLastData;
+};
+
+uint
+TestApp::processApdu(
+    NfcHost*,
+    uchar,
+    uchar aIns,
+    uchar,
+    uchar aP2,
+    const QByteArray& aData,
+    uint,
+    NfcHost::Response* aResponse)
+{
+    iApduCount++;
+    iLastIns = aIns;
+    iLastP2 = aP2;
+    iLastData = aData;
+    if (iDelay) {
+        QThread::usleep(iDelay);
+    }
+    if (aIns == ISO_INS_SELECT) {
+        return iSelectSw;
+    }
+    aResponse->setData(iName);
+    return ISO_SW_OK;
+}
+
+void
+TestApp::hostReset(
+    NfcHost*)
+{
+    iResetCount++;
+}
+
+// ==========================================================================
+// TestAidRouter
+// ==========================================================================
+
+class TestAidRouter :
+    public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void routes();
+    void noRoute();
+    void selectPartial();
+    void selectNext();
+    void selectNextOtherPrefix();
+    void selectRefused();
+    void refusedKeepsNothingSelected();
+    void removeSelected();
+    void reset();
+    void stats();
+
+private:
+    static uint select(NfcAidRouter*, const QByteArray&, bool aNext = false,
+        QByteArray* aResponse = Q_NULLPTR);
+    static uint getData(NfcAidRouter*, QByteArray* aResponse = Q_NULLPTR);
+};
+
+/* static */
+uint
+TestAidRouter::select(
+    NfcAidRouter* aRouter,
+    const QByteArray& aAid,
+    bool aNext,
+    QByteArray* aResponse)
+{
+    NfcHost::Response response;
+    const uint sw = aRouter->processApdu(Q_NULLPTR, ISO_CLA, ISO_INS_SELECT,
+        ISO_P1_SELECT_BY_NAME, aNext ? ISO_P2_SELECT_NEXT :
+        ISO_P2_SELECT_FIRST, aAid, 0, &response);
+
+    if (aResponse) {
+        *aResponse = response.data();
+    }
+    return sw;
+}
+
+/* static */
+uint
+TestAidRouter::getData(
+    NfcAidRouter* aRouter,
+    QByteArray* aResponse)
+{
+    NfcHost::Response response;
+    const uint sw = aRouter->processApdu(Q_NULLPTR, ISO_CLA,
+        ISO_INS_GET_DATA, 0, 0, QByteArray(), 0, &response);
+
+    if (aResponse) {
+        *aResponse = response.data();
+    }
+    return sw;
+}
+
+void
+TestAidRouter::routes()
+{
+    NfcAidRouter router;
+    TestApp app("app");
+
+    // Invalid ones
+    QVERIFY(!router.addRoute(QByteArray(), &app));
+    QVERIFY(!router.addRoute(QByteArray(17, '\xff'), &app));
+    QVERIFY(!router.addRoute(AID_1, Q_NULLPTR));
+    QVERIFY(router.aids().isEmpty());
+
+    // One handler may serve several AIDs, listed in byte order
+    QVERIFY(router.addRoute(AID_2, &app));
+    QVERIFY(router.addRoute(AID_1_2, &app));
+    QVERIFY(router.addRoute(AID_1, &app));
+    QVERIFY(router.addRoute(QByteArray(16, '\xff'), &app));
+    QVERIFY(!router.addRoute(AID_1, &app));
+    QCOMPARE(router.aids(), QList<QByteArray>() << AID_1 << AID_1_2 <<
+        AID_2 << QByteArray(16, '\xff'));
+
+    // Prefixes of the existing AIDs aren't routes
+    QVERIFY(!router.removeRoute(QByteArray()));
+    QVERIFY(!router.removeRoute(AID_1.left(3)));
+    QVERIFY(!router.removeRoute(AID_1_1));
+    QVERIFY(router.removeRoute(AID_1));
+    QVERIFY(!router.removeRoute(AID_1));
+    QCOMPARE(router.aids(), QList<QByteArray>() << AID_1_2 << AID_2 <<
+        QByteArray(16, '\xff'));
+
+    // The pruned branch can be reused
+    QVERIFY(router.addRoute(AID_1_1, &app));
+    QCOMPARE(router.aids(), QList<QByteArray>() << AID_1_1 << AID_1_2 <<
+        AID_2 << QByteArray(16, '\xff'));
+
+    router.removeAllRoutes();
+    QVERIFY(router.aids().isEmpty());
+    QCOMPARE(select(&router, AID_1_1), (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(app.iApduCount, 0);
+}
+
+void
+TestAidRouter::noRoute()
+{
+    NfcAidRouter router;
+    TestApp app("app");
+
+    QVERIFY(router.addRoute(AID_1, &app));
+
+    // Nothing is selected, other APDUs have nowhere to go
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QCOMPARE(select(&router, AID_2), (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(select(&router, AID_1_1), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(app.iApduCount, 0);
+
+    // Unknown SELECT drops the current selection
+    QCOMPARE(select(&router, AID_1), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1);
+    QCOMPARE(select(&router, AID_2), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QCOMPARE(app.iApduCount, 1);
+}
+
+void
+TestAidRouter::selectPartial()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+    QByteArray response;
+
+    QVERIFY(router.addRoute(AID_1_1, &app1));
+    QVERIFY(router.addRoute(AID_2, &app2));
+
+    // The handler gets its full AID
+    QCOMPARE(select(&router, AID_1.left(3)), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_1);
+    QCOMPARE(app1.iApduCount, 1);
+    QCOMPARE(app1.iLastIns, (uchar)ISO_INS_SELECT);
+    QCOMPARE(app1.iLastData, AID_1_1);
+
+    // And everything else up to the next SELECT by name
+    QCOMPARE(getData(&router, &response), (uint)ISO_SW_OK);
+    QCOMPARE(response, QByteArray("app1"));
+    QCOMPARE(app1.iApduCount, 2);
+    QCOMPARE(app1.iLastIns, (uchar)ISO_INS_GET_DATA);
+
+    QCOMPARE(select(&router, AID_2), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_2);
+    QCOMPARE(getData(&router, &response), (uint)ISO_SW_OK);
+    QCOMPARE(response, QByteArray("app2"));
+    QCOMPARE(app1.iApduCount, 2);
+    QCOMPARE(app2.iApduCount, 2);
+}
+
+void
+TestAidRouter::selectNext()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+    const QByteArray prefix(AID_1.left(4));
+
+    // AID_1 is both a route and a prefix of two others
+    QVERIFY(router.addRoute(AID_2, &app2));
+    QVERIFY(router.addRoute(AID_1_2, &app1));
+    QVERIFY(router.addRoute(AID_1, &app1));
+    QVERIFY(router.addRoute(AID_1_1, &app1));
+
+    QCOMPARE(select(&router, prefix), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1);
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_1);
+
+    // The handler always sees the first occurrence
+    QCOMPARE(app1.iLastP2, (uchar)ISO_P2_SELECT_FIRST);
+    QCOMPARE(app1.iLastData, AID_1_1);
+
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_2);
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_2);
+
+    // Exhausted, and stays exhausted
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QCOMPARE(app1.iApduCount, 3);
+    QCOMPARE(app2.iApduCount, 1);
+
+    // The first occurrence starts over
+    QCOMPARE(select(&router, prefix), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1);
+
+    // Next occurrence of a longer prefix
+    QCOMPARE(select(&router, AID_1, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_1);
+    QCOMPARE(select(&router, AID_1, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_2);
+    QCOMPARE(select(&router, AID_1, true), (uint)ISO_SW_FILE_NOT_FOUND);
+}
+
+void
+TestAidRouter::selectNextOtherPrefix()
+{
+    NfcAidRouter router;
+    TestApp app("app");
+
+    QVERIFY(router.addRoute(AID_1_1, &app));
+    QVERIFY(router.addRoute(AID_1_2, &app));
+    QVERIFY(router.addRoute(AID_2, &app));
+
+    // The last occurrence doesn't match, the next one is the first one
+    QCOMPARE(select(&router, AID_1_1), (uint)ISO_SW_OK);
+    QCOMPARE(select(&router, AID_2, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_2);
+
+    // Without a previous occurrence too
+    router.hostReset(Q_NULLPTR);
+    QCOMPARE(select(&router, AID_1, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_1);
+}
+
+void
+TestAidRouter::selectRefused()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+    const QByteArray prefix(AID_1);
+
+    QVERIFY(router.addRoute(AID_1_1, &app1));
+    QVERIFY(router.addRoute(AID_1_2, &app2));
+    app1.iSelectSw = ISO_SW_CONDITIONS_NOT_SATISFIED;
+
+    // The reader gets the handler's SW and nothing is selected
+    QCOMPARE(select(&router, prefix), (uint)ISO_SW_CONDITIONS_NOT_SATISFIED);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QCOMPARE(app1.iApduCount, 1);
+
+    // But the refused one can be skipped
+    QCOMPARE(select(&router, prefix, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_2);
+    QCOMPARE(getData(&router), (uint)ISO_SW_OK);
+    QCOMPARE(app2.iApduCount, 2);
+
+    // Refused SELECT isn't a hit
+    QCOMPARE(router.stats(AID_1_1).iHits, Q_UINT64_C(0));
+    QCOMPARE(router.stats(AID_1_2).iHits, Q_UINT64_C(2));
+}
+
+void
+TestAidRouter::refusedKeepsNothingSelected()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+
+    QVERIFY(router.addRoute(AID_1, &app1));
+    QVERIFY(router.addRoute(AID_2, &app2));
+    app2.iSelectSw = ISO_SW_FILE_NOT_FOUND;
+
+    // The previous application doesn't remain selected either
+    QCOMPARE(select(&router, AID_1), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1);
+    QCOMPARE(select(&router, AID_2), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QCOMPARE(app1.iApduCount, 1);
+    QCOMPARE(app2.iApduCount, 1);
+}
+
+void
+TestAidRouter::removeSelected()
+{
+    NfcAidRouter router;
+    TestApp app("app");
+
+    QVERIFY(router.addRoute(AID_1, &app));
+    QVERIFY(router.addRoute(AID_1_1, &app));
+    QCOMPARE(select(&router, AID_1), (uint)ISO_SW_OK);
+    QVERIFY(router.removeRoute(AID_1));
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+
+    // The occurrence is gone too, next is the same as first
+    QCOMPARE(select(&router, AID_1, true), (uint)ISO_SW_OK);
+    QCOMPARE(router.selectedAid(), AID_1_1);
+}
+
+void
+TestAidRouter::reset()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+
+    QVERIFY(router.addRoute(AID_1, &app1));
+    QVERIFY(router.addRoute(AID_1_1, &app1));
+    QVERIFY(router.addRoute(AID_2, &app2));
+    QCOMPARE(select(&router, AID_1), (uint)ISO_SW_OK);
+
+    // Each handler is reset once, nothing is selected afterwards
+    router.hostReset(Q_NULLPTR);
+    QCOMPARE(app1.iResetCount, 1);
+    QCOMPARE(app2.iResetCount, 1);
+    QVERIFY(router.selectedAid().isEmpty());
+    QCOMPARE(getData(&router), (uint)ISO_SW_INS_NOT_SUPPORTED);
+}
+
+void
+TestAidRouter::stats()
+{
+    NfcAidRouter router;
+    TestApp app1("app1");
+    TestApp app2("app2");
+    const ulong delay = 2000;
+
+    QVERIFY(router.addRoute(AID_1, &app1));
+    QVERIFY(router.addRoute(AID_2, &app2));
+    QCOMPARE(router.stats(AID_1).iHits, Q_UINT64_C(0));
+    QCOMPARE(router.stats(AID_1).iTotalTime, Q_INT64_C(0));
+
+    // SELECT and the APDUs following it are hits
+    QCOMPARE(select(&router, AID_1), (uint)ISO_SW_OK);
+    QCOMPARE(getData(&router), (uint)ISO_SW_OK);
+    app1.iDelay = delay;
+    QCOMPARE(getData(&router), (uint)ISO_SW_OK);
+    QCOMPARE(select(&router, AID_2), (uint)ISO_SW_OK);
+
+    const NfcAidRouter::Stats stats1(router.stats(AID_1));
+    const NfcAidRouter::Stats stats2(router.stats(AID_2));
+
+    QCOMPARE(stats1.iHits, Q_UINT64_C(3));
+    QVERIFY(stats1.iMaxTime >= qint64(delay) * 1000);
+    QVERIFY(stats1.iTotalTime >= stats1.iMaxTime);
+    QCOMPARE(stats2.iHits, Q_UINT64_C(1));
+    QVERIFY(stats2.iMaxTime < stats1.iMaxTime);
+
+    // Not a route, no stats
+    QCOMPARE(router.stats(AID_1_1).iHits, Q_UINT64_C(0));
+    QCOMPARE(router.stats(QByteArray()).iHits, Q_UINT64_C(0));
+
+    router.resetStats();
+    QCOMPARE(router.stats(AID_1).iHits, Q_UINT64_C(0));
+    QCOMPARE(router.stats(AID_1).iTotalTime, Q_INT64_C(0));
+    QCOMPARE(router.stats(AID_1).iMaxTime, Q_INT64_C(0));
+    QCOMPARE(router.stats(AID_2).iHits, Q_UINT64_C(0));
+}
+
+QTEST_GUILESS_MAIN(TestAidRouter)
+#include "test_aidrouter.moc"
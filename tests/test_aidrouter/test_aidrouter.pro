@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = test_aidrouter
+SOURCES += test_aidrouter.cpp
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcHost.h"
+
+#include "NfcdMock.h"
+
+#include <QtTest>
+
+#define ISO_SW_OK (0x9000)
+#define ISO_SW_INS_NOT_SUPPORTED (0x6d00)
+#define ISO_SW_UNKNOWN (0x6f00)
+#define ISO_INS_GET_DATA (0xca)
+
+#define MOCK_HOST "/nfc0/host1"
+
+class TestHost :
+    public QObject,
+    public NfcHost::Handler
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+    void registration();
+    void unregisterPending();
+    void rename();
+    void startStop();
+    void process();
+    void processOtherPath();
+
+private:
+    // NfcHost::Handler
+    uint processApdu(NfcHost*, uchar, uchar, uchar, uchar, const QByteArray&,
+        uint, NfcHost::Response*) Q_DECL_OVERRIDE;
+    void hostReset(NfcHost*) Q_DECL_OVERRIDE;
+
+    QStringList hosts();
+
+private:
+    NfcdMock iMock;
+    int iApduCount;
+    int iResetCount;
+    uint iLastLe;
+};
+
+uint
+TestHost::processApdu(
+    NfcHost*,
+    uchar aCla,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    uint aLe,
+    NfcHost::Response* aResponse)
+{
+    iApduCount++;
+    iLastLe = aLe;
+    if (aIns == ISO_INS_GET_DATA) {
+        QByteArray data(aData);
+
+        // Echo the header after the data
+        data.append(char(aCla));
+        data.append(char(aIns));
+        data.append(char(aP1));
+        data.append(char(aP2));
+        aResponse->setData(data);
+        return ISO_SW_OK;
+    }
+    return ISO_SW_INS_NOT_SUPPORTED;
+}
+
+void
+TestHost::hostReset(
+    NfcHost*)
+{
+    iResetCount++;
+}
+
+QStringList
+TestHost::hosts()
+{
+    return iMock.state().value(QStringLiteral("hosts")).toStringList();
+}
+
+void
+TestHost::initTestCase()
+{
+    if (!iMock.available()) {
+        QSKIP("Mock nfcd is not running, use run-tests.sh");
+    }
+}
+
+void
+TestHost::init()
+{
+    QVERIFY(iMock.reset());
+    iApduCount = 0;
+    iResetCount = 0;
+    iLastLe = 0;
+}
+
+void
+TestHost::cleanupTestCase()
+{
+    iMock.reset();
+}
+
+void
+TestHost::registration()
+{
+    NfcHost host;
+    QSignalSpy registeredChanged(&host, SIGNAL(registeredChanged()));
+
+    // Nothing happens until both the name and the handler are set
+    host.setName(QStringLiteral("test"));
+    QTest::qWait(100);
+    QVERIFY(!host.registered());
+    QVERIFY(hosts().isEmpty());
+
+    host.setHandler(this);
+    QTRY_VERIFY(host.registered());
+    QCOMPARE(registeredChanged.count(), 1);
+    QCOMPARE(hosts().count(), 1);
+
+    host.setHandler(Q_NULLPTR);
+    QVERIFY(!host.registered());
+    QTRY_VERIFY(hosts().isEmpty());
+}
+
+void
+TestHost::unregisterPending()
+{
+    // Dropped before the bus is there
+    {
+        NfcHost host;
+
+        host.setName(QStringLiteral("test"));
+        host.setHandler(this);
+        host.setHandler(Q_NULLPTR);
+    }
+
+    // Dropped with (or soon after) RegisterLocalHostService in flight
+    for (int i = 0; i < 5; i++) {
+        NfcHost host;
+
+        host.setName(QStringLiteral("test"));
+        host.setHandler(this);
+        for (int k = 0; k < i; k++) {
+            QCoreApplication::processEvents();
+        }
+    }
+
+    // Nothing must be left registered with nfcd
+    QTest::qWait(200);
+    QVERIFY(hosts().isEmpty());
+}
+
+void
+TestHost::rename()
+{
+    NfcHost host;
+
+    host.setHandler(this);
+    host.setName(QStringLiteral("one"));
+    host.setName(QStringLiteral("two"));
+    QTRY_VERIFY(host.registered());
+    QTest::qWait(100);
+    QCOMPARE(hosts().count(), 1);
+}
+
+void
+TestHost::startStop()
+{
+    NfcHost host;
+    QSignalSpy activeChanged(&host, SIGNAL(activeChanged()));
+
+    host.setName(QStringLiteral("test"));
+    host.setHandler(this);
+    QTRY_VERIFY(host.registered());
+    QVERIFY(!host.active());
+
+    QVERIFY(iMock.startHost(QStringLiteral(MOCK_HOST)));
+    QTRY_VERIFY(host.active());
+    QCOMPARE(iResetCount, 1);
+    QCOMPARE(activeChanged.count(), 1);
+
+    // Restarting the same host resets the session but stays active
+    QVERIFY(iMock.startHost(QStringLiteral(MOCK_HOST)));
+    QTRY_COMPARE(iResetCount, 2);
+    QVERIFY(host.active());
+    QCOMPARE(activeChanged.count(), 1);
+
+    QVERIFY(iMock.stopHost(QStringLiteral(MOCK_HOST)));
+    QTRY_VERIFY(!host.active());
+    QCOMPARE(iResetCount, 3);
+    QTRY_COMPARE(activeChanged.count(), 2);
+
+    // Unknown host is ignored
+    QVERIFY(iMock.stopHost(QStringLiteral("/nfc0/host2")));
+    QTest::qWait(100);
+    QCOMPARE(iResetCount, 3);
+}
+
+void
+TestHost::process()
+{
+    NfcHost host;
+    QByteArray response;
+    uint sw = 0;
+
+    host.setName(QStringLiteral("test"));
+    host.setHandler(this);
+    QTRY_VERIFY(host.registered());
+    QVERIFY(iMock.startHost(QStringLiteral(MOCK_HOST)));
+    QTRY_VERIFY(host.active());
+
+    QVERIFY(iMock.processApdu(QStringLiteral(MOCK_HOST), 0x80,
+        ISO_INS_GET_DATA, 0x01, 0x02, QByteArray("\x11\x22", 2), 256,
+        &response, &sw));
+    QCOMPARE(sw, (uint)ISO_SW_OK);
+    QCOMPARE(response, QByteArray("\x11\x22\x80\xca\x01\x02", 6));
+    QCOMPARE(iApduCount, 1);
+    QCOMPARE(iLastLe, 256u);
+
+    // No data, SW only
+    QVERIFY(iMock.processApdu(QStringLiteral(MOCK_HOST), 0x00, 0x20, 0, 0,
+        QByteArray(), 0, &response, &sw));
+    QCOMPARE(sw, (uint)ISO_SW_INS_NOT_SUPPORTED);
+    QVERIFY(response.isEmpty());
+    QCOMPARE(iApduCount, 2);
+    QCOMPARE(iLastLe, 0u);
+}
+
+void
+TestHost::processOtherPath()
+{
+    NfcHost host;
+    QByteArray response;
+    uint sw = 0;
+
+    // APDUs for other hosts don't reach the handler
+    host.setPath(QStringLiteral("/nfc0/host2"));
+    host.setName(QStringLiteral("test"));
+    host.setHandler(this);
+    QTRY_VERIFY(host.registered());
+    QVERIFY(iMock.processApdu(QStringLiteral(MOCK_HOST), 0x80,
+        ISO_INS_GET_DATA, 0, 0, QByteArray(), 0, &response, &sw));
+    QCOMPARE(sw, (uint)ISO_SW_UNKNOWN);
+    QVERIFY(response.isEmpty());
+    QCOMPARE(iApduCount, 0);
+}
+
+QTEST_GUILESS_MAIN(TestHost)
+#include "test_host.moc"
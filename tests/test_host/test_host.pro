@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = test_host
+SOURCES += test_host.cpp
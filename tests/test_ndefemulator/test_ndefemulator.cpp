@@ -0,0 +1,458 @@
+/*
+ * Copyright (C) 2026 Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ *  3. Neither the names of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "NfcNdefEmulator.h"
+
+#include <QtTest>
+
+#define ISO_CLA (0x00)
+#define ISO_INS_SELECT (0xa4)
+#define ISO_INS_READ_BINARY (0xb0)
+#define ISO_INS_UPDATE_BINARY (0xd6)
+#define ISO_INS_GET_DATA (0xca)
+#define ISO_P1_SELECT_BY_ID (0x00)
+#define ISO_P1_SELECT_BY_NAME (0x04)
+#define ISO_P2_SELECT_FIRST (0x0c)
+#define ISO_SW_OK (0x9000)
+#define ISO_SW_SECURITY_STATUS (0x6982)
+#define ISO_SW_NO_CURRENT_EF (0x6986)
+#define ISO_SW_FILE_NOT_FOUND (0x6a82)
+#define ISO_SW_INCORRECT_P1P2 (0x6a86)
+#define ISO_SW_WRONG_OFFSET (0x6b00)
+#define ISO_SW_INS_NOT_SUPPORTED (0x6d00)
+
+static const QByteArray CC_FILE("\xe1\x03", 2);
+static const QByteArray NDEF_FILE("\xe1\x04", 2);
+
+// Empty NDEF record
+static const QByteArray NDEF_EMPTY("\xd0\x00\x00", 3);
+
+class TestNdefEmulator :
+    public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void buildImage();
+    void invalidImage();
+    void selectApplication();
+    void selectFile();
+    void readCc();
+    void readNdef();
+    void readOffset();
+    void readLe();
+    void readOnly();
+    void hostReset();
+    void imageSwap();
+    void clearImage();
+    void responseLifetime();
+
+private:
+    static QByteArray message(int);
+    static uint apdu(NfcNdefEmulator*, uchar, uchar, uchar,
+        const QByteArray& aData = QByteArray(), uint aLe = 0,
+        QByteArray* aResponse = Q_NULLPTR);
+    static uint selectApp(NfcNdefEmulator*);
+    static uint selectFile(NfcNdefEmulator*, const QByteArray&);
+    static uint read(NfcNdefEmulator*, uint, uint, QByteArray*);
+};
+
+/* static */
+QByteArray
+TestNdefEmulator::message(
+    int aPayloadSize)
+{
+    // Single record of unknown type (TNF 5) with a 4-byte length
+    QByteArray ndef;
+
+    ndef.append((char)0xc5);
+    ndef.append((char)0);
+    ndef.append((char)(aPayloadSize >> 24));
+    ndef.append((char)(aPayloadSize >> 16));
+    ndef.append((char)(aPayloadSize >> 8));
+    ndef.append((char)aPayloadSize);
+    for (int i = 0; i < aPayloadSize; i++) {
+        ndef.append((char)i);
+    }
+    return ndef;
+}
+
+/* static */
+uint
+TestNdefEmulator::apdu(
+    NfcNdefEmulator* aEmulator,
+    uchar aIns,
+    uchar aP1,
+    uchar aP2,
+    const QByteArray& aData,
+    uint aLe,
+    QByteArray* aResponse)
+{
+    NfcHost::Response response;
+    const uint sw = aEmulator->processApdu(Q_NULLPTR, ISO_CLA, aIns, aP1,
+        aP2, aData, aLe, &response);
+
+    if (aResponse) {
+        *aResponse = response.data();
+    }
+    return sw;
+}
+
+/* static */
+uint
+TestNdefEmulator::selectApp(
+    NfcNdefEmulator* aEmulator)
+{
+    return apdu(aEmulator, ISO_INS_SELECT, ISO_P1_SELECT_BY_NAME, 0,
+        NfcNdefEmulator::aid());
+}
+
+/* static */
+uint
+TestNdefEmulator::selectFile(
+    NfcNdefEmulator* aEmulator,
+    const QByteArray& aFile)
+{
+    return apdu(aEmulator, ISO_INS_SELECT, ISO_P1_SELECT_BY_ID,
+        ISO_P2_SELECT_FIRST, aFile);
+}
+
+/* static */
+uint
+TestNdefEmulator::read(
+    NfcNdefEmulator* aEmulator,
+    uint aOffset,
+    uint aLe,
+    QByteArray* aResponse)
+{
+    return apdu(aEmulator, ISO_INS_READ_BINARY, (uchar)(aOffset >> 8),
+        (uchar)aOffset, QByteArray(), aLe, aResponse);
+}
+
+void
+TestNdefEmulator::buildImage()
+{
+    QCOMPARE(NfcNdefEmulator::buildImage(QByteArray()),
+        QByteArray("\x00\x00", 2));
+    QCOMPARE(NfcNdefEmulator::buildImage(NDEF_EMPTY),
+        QByteArray("\x00\x03\xd0\x00\x00", 5));
+    QCOMPARE(NfcNdefEmulator::buildImage(message(294)).left(2),
+        QByteArray("\x01\x2c", 2));
+    QCOMPARE(NfcNdefEmulator::aid(),
+        QByteArray("\xd2\x76\x00\x00\x85\x01\x01", 7));
+}
+
+void
+TestNdefEmulator::invalidImage()
+{
+    NfcNdefEmulator emulator;
+
+    QVERIFY(!emulator.hasImage());
+    QVERIFY(!emulator.setImage(QByteArray()));
+    QVERIFY(!emulator.setImage(QByteArray(1, 0)));
+
+    // NLEN points past the end
+    QVERIFY(!emulator.setImage(QByteArray("\x00\x04\xd0\x00\x00", 5)));
+    QVERIFY(!emulator.setImageFile(QStringLiteral("/nonexistent")));
+    QVERIFY(!emulator.hasImage());
+
+    // Extra bytes after the message are fine, so is an empty message
+    QVERIFY(emulator.setImage(QByteArray("\x00\x00", 2)));
+    QVERIFY(emulator.setImage(QByteArray("\x00\x03\xd0\x00\x00\x00", 6)));
+    QVERIFY(emulator.hasImage());
+
+    // Invalid one doesn't replace the valid one
+    QVERIFY(!emulator.setImage(QByteArray(0x8000, 0)));
+    QVERIFY(emulator.hasImage());
+}
+
+void
+TestNdefEmulator::selectApplication()
+{
+    NfcNdefEmulator emulator;
+
+    // Nothing to select without an image
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_FILE_NOT_FOUND);
+    QVERIFY(emulator.setImage(NfcNdefEmulator::buildImage(NDEF_EMPTY)));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+
+    // Wrong or partial AID
+    QCOMPARE(apdu(&emulator, ISO_INS_SELECT, ISO_P1_SELECT_BY_NAME, 0,
+        NfcNdefEmulator::aid().left(6)), (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_FILE_NOT_FOUND);
+
+    QCOMPARE(apdu(&emulator, ISO_INS_GET_DATA, 0, 0),
+        (uint)ISO_SW_INS_NOT_SUPPORTED);
+}
+
+void
+TestNdefEmulator::selectFile()
+{
+    NfcNdefEmulator emulator;
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(NfcNdefEmulator::buildImage(NDEF_EMPTY)));
+
+    // Files can't be selected before the application
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_NO_CURRENT_EF);
+
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_NO_CURRENT_EF);
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // Unknown file leaves no file selected
+    QCOMPARE(selectFile(&emulator, QByteArray("\xe1\x05", 2)),
+        (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_NO_CURRENT_EF);
+    QCOMPARE(selectFile(&emulator, QByteArray("\xe1", 1)),
+        (uint)ISO_SW_FILE_NOT_FOUND);
+}
+
+void
+TestNdefEmulator::readCc()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image(NfcNdefEmulator::buildImage(message(294)));
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_OK);
+
+    // Mapping version 2.0, MLe 255, MLc 1, read-only NDEF file E104
+    // with the maximum size being the size of the image (0x012e)
+    QCOMPARE(read(&emulator, 0, 15, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x00\x0f\x20\x00\xff\x00\x01"
+        "\x04\x06\xe1\x04\x01\x2e\x00\xff", 15));
+
+    // CCLEN first, as the readers do it
+    QCOMPARE(read(&emulator, 0, 2, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x00\x0f", 2));
+    QCOMPARE(read(&emulator, 7, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x04\x06\xe1\x04\x01\x2e\x00\xff", 8));
+    QCOMPARE(read(&emulator, 15, 0, &data), (uint)ISO_SW_OK);
+    QVERIFY(data.isEmpty());
+    QCOMPARE(read(&emulator, 16, 0, &data), (uint)ISO_SW_WRONG_OFFSET);
+}
+
+void
+TestNdefEmulator::readNdef()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image(NfcNdefEmulator::buildImage(NDEF_EMPTY));
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // NLEN and then the message
+    QCOMPARE(read(&emulator, 0, 2, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x00\x03", 2));
+    QCOMPARE(read(&emulator, 2, 3, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, NDEF_EMPTY);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image);
+}
+
+void
+TestNdefEmulator::readOffset()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image(NfcNdefEmulator::buildImage(message(294)));
+    const int size = image.size();
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // P1 carries the high bits of the offset
+    QCOMPARE(read(&emulator, 0x100, 16, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.mid(0x100, 16));
+    QCOMPARE(read(&emulator, size - 1, 16, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.right(1));
+
+    // Reading right at the end is fine, past the end isn't
+    QCOMPARE(read(&emulator, size, 16, &data), (uint)ISO_SW_OK);
+    QVERIFY(data.isEmpty());
+    QCOMPARE(read(&emulator, size + 1, 16, &data),
+        (uint)ISO_SW_WRONG_OFFSET);
+    QCOMPARE(read(&emulator, 0x7fff, 1, &data), (uint)ISO_SW_WRONG_OFFSET);
+
+    // P1 bit 8 means short EF identifier, which isn't supported
+    QCOMPARE(read(&emulator, 0x8000, 1, &data),
+        (uint)ISO_SW_INCORRECT_P1P2);
+}
+
+void
+TestNdefEmulator::readLe()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image(NfcNdefEmulator::buildImage(message(294)));
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // No Le (or 00) means up to 256 bytes, so does anything larger
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.left(256));
+    QCOMPARE(read(&emulator, 0, 256, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.left(256));
+    QCOMPARE(read(&emulator, 0, 65536, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.left(256));
+
+    QCOMPARE(read(&emulator, 0, 1, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.left(1));
+    QCOMPARE(read(&emulator, 0, 255, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.left(255));
+
+    // Truncated at the end of the file
+    QCOMPARE(read(&emulator, 256, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.mid(256));
+    QCOMPARE(read(&emulator, 290, 255, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image.mid(290));
+}
+
+void
+TestNdefEmulator::readOnly()
+{
+    NfcNdefEmulator emulator;
+
+    QVERIFY(emulator.setImage(NfcNdefEmulator::buildImage(NDEF_EMPTY)));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(apdu(&emulator, ISO_INS_UPDATE_BINARY, 0, 0,
+        QByteArray("\x00\x00", 2)), (uint)ISO_SW_SECURITY_STATUS);
+}
+
+void
+TestNdefEmulator::hostReset()
+{
+    NfcNdefEmulator emulator;
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(NfcNdefEmulator::buildImage(NDEF_EMPTY)));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // The new session starts with nothing selected
+    emulator.hostReset(Q_NULLPTR);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_NO_CURRENT_EF);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_FILE_NOT_FOUND);
+}
+
+void
+TestNdefEmulator::imageSwap()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image1(NfcNdefEmulator::buildImage(message(100)));
+    const QByteArray image2(NfcNdefEmulator::buildImage(message(200)));
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image1));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(read(&emulator, 0, 2, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image1.left(2));
+
+    // The reader keeps reading the image it has started with
+    QVERIFY(emulator.setImage(image2));
+    QCOMPARE(read(&emulator, 2, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image1.mid(2));
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(read(&emulator, 11, 2, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x00\x6c", 2));
+
+    // Until it selects the application again
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, CC_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(read(&emulator, 11, 2, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, QByteArray("\x00\xd0", 2));
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image2);
+}
+
+void
+TestNdefEmulator::clearImage()
+{
+    NfcNdefEmulator emulator;
+    const QByteArray image(NfcNdefEmulator::buildImage(NDEF_EMPTY));
+    QByteArray data;
+
+    QVERIFY(emulator.setImage(image));
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(&emulator, NDEF_FILE), (uint)ISO_SW_OK);
+
+    // The session survives, the application is gone for the next one
+    emulator.clearImage();
+    QVERIFY(!emulator.hasImage());
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_OK);
+    QCOMPARE(data, image);
+    QCOMPARE(selectApp(&emulator), (uint)ISO_SW_FILE_NOT_FOUND);
+    QCOMPARE(read(&emulator, 0, 0, &data), (uint)ISO_SW_NO_CURRENT_EF);
+}
+
+void
+TestNdefEmulator::responseLifetime()
+{
+    const QByteArray image(NfcNdefEmulator::buildImage(message(100)));
+    NfcHost::Response response;
+    NfcNdefEmulator* emulator = new NfcNdefEmulator;
+
+    QVERIFY(emulator->setImage(image));
+    QCOMPARE(selectApp(emulator), (uint)ISO_SW_OK);
+    QCOMPARE(selectFile(emulator, NDEF_FILE), (uint)ISO_SW_OK);
+    QCOMPARE(emulator->processApdu(Q_NULLPTR, ISO_CLA, ISO_INS_READ_BINARY,
+        0, 0, QByteArray(), 0, &response), (uint)ISO_SW_OK);
+
+    // The response keeps the image alive
+    emulator->clearImage();
+    delete emulator;
+    QCOMPARE(response.data(), image);
+    response.clear();
+    QVERIFY(response.data().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestNdefEmulator)
+#include "test_ndefemulator.moc"
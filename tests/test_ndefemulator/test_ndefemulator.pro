@@ -0,0 +1,4 @@
+include(../common.pri)
+
+TARGET = test_ndefemulator
+SOURCES += test_ndefemulator.cpp
@@ -0,0 +1,14 @@
+TEMPLATE = subdirs
+SUBDIRS = \
+    bench_dispatch \
+    bench_latency \
+    bench_ndef \
+    test_adapter \
+    test_aidrouter \
+    test_host \
+    test_ndefemulator
+
+OTHER_FILES += \
+    common.pri \
+    mock/nfcd-mock.py \
+    run-tests.sh
@@ -1 +1 @@
-VERSION = 1.2.1
+VERSION = 1.3.0